@@ -0,0 +1,88 @@
+/*!
+ * @file        bench.h
+ *
+ * @brief       Header for bench.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "uart_dma.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup BENCH_Macros Macros
+  @{
+*/
+
+/* Frames sent by the generator in each run */
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES            100
+#endif
+
+/* Idle characters the generator leaves between frames */
+#define BENCH_GAP_CHARS         2
+
+/* Where the results come from, the host model builds with "host" */
+#ifndef BENCH_PLATFORM
+#define BENCH_PLATFORM          "target"
+#endif
+
+/* Engine measurement hooks, see uart_dma.c */
+#define UART_DMA_ISR_ENTER(port)    BENCH_IsrEnter(port)
+#define UART_DMA_ISR_EXIT(port)     BENCH_IsrExit(port)
+#define UART_DMA_RX_FRAME(port)     BENCH_RxFrame(port)
+#define UART_DMA_TX_START(port)     BENCH_TxStart(port)
+
+/**@} end of group BENCH_Macros */
+
+/** @defgroup BENCH_Functions Functions
+  @{
+*/
+
+void BENCH_Main(UART_DMA_Port_T* dut, UART_DMA_Port_T* gen, UART_DMA_Port_T* report);
+void BENCH_IsrEnter(UART_DMA_Port_T* port);
+void BENCH_IsrExit(UART_DMA_Port_T* port);
+void BENCH_RxFrame(UART_DMA_Port_T* port);
+void BENCH_TxStart(UART_DMA_Port_T* port);
+
+/**@} end of group BENCH_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BENCH_H */
@@ -0,0 +1,85 @@
+/*!
+ * @file        crc32.h
+ *
+ * @brief       Header for crc32.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __CRC32_H
+#define __CRC32_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "apm32f10x.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup CRC32_Macros Macros
+  @{
+*/
+
+/* Reflected polynomial of the standard CRC-32, 0x04C11DB7 bit reversed */
+#define CRC32_POLY_REFLECTED    0xEDB88320
+
+/* CRC32_Calc() value of "123456789" */
+#define CRC32_CHECK             0xCBF43926
+
+/*
+ * Shorter inputs are computed in software, the hardware start costs about
+ * as much as that many bytes. Define CRC32_SOFTWARE to never use the unit,
+ * e.g. on a host without the register model.
+ */
+#ifndef CRC32_HARD_MIN
+#define CRC32_HARD_MIN          16
+#endif
+
+/**@} end of group CRC32_Macros */
+
+/** @defgroup CRC32_Functions Functions
+  @{
+*/
+
+void CRC32_Init(void);
+uint32_t CRC32_Calc(uint32_t crc, const uint8_t* data, uint32_t len);
+uint32_t CRC32_Soft(uint32_t crc, const uint8_t* data, uint32_t len);
+uint32_t CRC32_Hard(uint32_t crc, const uint8_t* data, uint32_t len);
+uint8_t CRC32_Claim(void);
+void CRC32_Release(void);
+
+/**@} end of group CRC32_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC32_H */
@@ -0,0 +1,118 @@
+/*!
+ * @file        dma_chain.h
+ *
+ * @brief       Header for dma_chain.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __DMA_CHAIN_H
+#define __DMA_CHAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "dma_mgr.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup DMA_CHAIN_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   One piece of a chained transfer
+ */
+typedef struct
+{
+    uint32_t addr;     /*!< Memory address of the first data item */
+    uint16_t count;    /*!< Data items, 0 skips the segment */
+    uint8_t  fixed;    /*!< 1 to repeat the item at addr, e.g. padding, 0 to step through memory */
+} DMA_CHAIN_Segment_T;
+
+/**
+ * @brief   Chain end callback, run from the channel IRQ once the last
+ *          segment is done or a transfer error stopped the channel
+ */
+typedef void (*DMA_CHAIN_Callback_T)(void* context, uint8_t error);
+
+/**
+ * @brief   Chain counters
+ */
+typedef struct
+{
+    uint32_t chains;      /*!< Chains started */
+    uint32_t segments;    /*!< Segments put on the channel */
+    uint32_t errors;      /*!< Chains stopped by a transfer error */
+} DMA_CHAIN_Stats_T;
+
+/**
+ * @brief   Channel that runs segment lists as one transfer.
+ *
+ *          The controller has no descriptors, so the TC interrupt of each
+ *          segment puts the next one on the channel. Peripheral address,
+ *          direction, data sizes and priority stay as DMA_CHAIN_Init() set
+ *          them; a segment brings its memory address, item count and
+ *          whether the memory address steps. Between two segments the
+ *          peripheral sees a pause of the interrupt entry and four register
+ *          writes, which USART, SPI and memory to memory transfers tolerate.
+ */
+typedef struct
+{
+    DMA_Channel_T*             channel;   /*!< Private: claimed by DMA_CHAIN_Init(), NULL if taken */
+    uint32_t                   cfg;       /*!< Private: CHCFG of a segment, channel off, memory address fixed */
+    const DMA_CHAIN_Segment_T* seg;       /*!< Private: segment on the channel */
+    const DMA_CHAIN_Segment_T* end;       /*!< Private: after the last segment */
+    DMA_CHAIN_Callback_T       callback;  /*!< Private: of the running chain */
+    void*                      context;
+    volatile uint8_t           busy;      /*!< Private: 1 from DMA_CHAIN_Start() to the callback */
+    DMA_CHAIN_Stats_T          stats;     /*!< Private: counters */
+} DMA_CHAIN_T;
+
+/**@} end of group DMA_CHAIN_Structures */
+
+/** @defgroup DMA_CHAIN_Functions Functions
+  @{
+*/
+
+uint8_t DMA_CHAIN_Init(DMA_CHAIN_T* chain, uint16_t request, const DMA_Config_T* dmaConfig, uint8_t priority);
+uint8_t DMA_CHAIN_Start(DMA_CHAIN_T* chain, const DMA_CHAIN_Segment_T* seg, uint8_t count,
+                        DMA_CHAIN_Callback_T callback, void* context);
+void DMA_CHAIN_Abort(DMA_CHAIN_T* chain);
+void DMA_CHAIN_ReadStats(DMA_CHAIN_T* chain, DMA_CHAIN_Stats_T* stats, uint8_t clear);
+
+/**@} end of group DMA_CHAIN_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_CHAIN_H */
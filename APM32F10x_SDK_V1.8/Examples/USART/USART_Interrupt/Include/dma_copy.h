@@ -0,0 +1,130 @@
+/*!
+ * @file        dma_copy.h
+ *
+ * @brief       Header for dma_copy.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __DMA_COPY_H
+#define __DMA_COPY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "dma_mgr.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup DMA_COPY_Macros Macros
+  @{
+*/
+
+/* Memory to memory channel of the copy service */
+#ifndef DMA_COPY_REQUEST
+#define DMA_COPY_REQUEST        DMA_MGR_REQ_MEM(DMA_MGR_DMA2(2))
+#endif
+
+/*
+ * Shorter copies and fills run on the CPU at once, the channel setup and
+ * completion interrupt cost about as much as that many bytes. The default
+ * is that estimate, not a measurement on any board. "bench copy" prints the
+ * crossover measured on the target, DMA_COPY_ConfigMin() sets it at run
+ * time.
+ */
+#ifndef DMA_COPY_MIN
+#define DMA_COPY_MIN            64
+#endif
+
+/**@} end of group DMA_COPY_Macros */
+
+/** @defgroup DMA_COPY_Structures Structures
+  @{
+*/
+
+typedef struct _DMA_COPY_Job_T DMA_COPY_Job_T;
+
+/**
+ * @brief   Job completion callback, run from the channel IRQ, or from the
+ *          caller for a job done on the CPU. The job memory may be reused.
+ */
+typedef void (*DMA_COPY_Callback_T)(DMA_COPY_Job_T* job);
+
+/**
+ * @brief   Copy or fill job, owned by the caller and left alone until done
+ */
+struct _DMA_COPY_Job_T
+{
+    DMA_COPY_Callback_T callback;  /*!< Run once done, NULL for none */
+    void*               context;   /*!< Free for the callback */
+    volatile uint8_t    busy;      /*!< 1 from DMA_COPY_Copy() or DMA_COPY_Fill() until done */
+    uint8_t             error;     /*!< 1 if a transfer error stopped the job, the data is incomplete */
+    uint8_t             fill;      /*!< Private: the source is pattern */
+    uint8_t             size;      /*!< Private: bytes per transfer, 1, 2 or 4 */
+    uint32_t            items;     /*!< Private: transfers left */
+    uint16_t            chunk;     /*!< Private: transfers on the channel */
+    uint32_t            pattern;   /*!< Private: fill byte in every byte lane */
+    DMA_MGR_Image_T     image;     /*!< Private: channel setup of the next chunk */
+    DMA_COPY_Job_T*     next;      /*!< Private: queue link */
+};
+
+/**
+ * @brief   Service counters
+ */
+typedef struct
+{
+    uint32_t dmaJobs;      /*!< Jobs done by the channel */
+    uint32_t dmaBytes;     /*!< Bytes moved by the channel */
+    uint32_t cpuJobs;      /*!< Jobs done on the CPU, short or without a channel */
+    uint32_t cpuBytes;     /*!< Bytes moved by the CPU, unaligned heads and tails included */
+    uint32_t errors;       /*!< Jobs stopped by a transfer error */
+} DMA_COPY_Stats_T;
+
+/**@} end of group DMA_COPY_Structures */
+
+/** @defgroup DMA_COPY_Functions Functions
+  @{
+*/
+
+uint8_t DMA_COPY_Init(uint8_t priority);
+void DMA_COPY_ConfigMin(uint32_t bytes);
+void DMA_COPY_Copy(DMA_COPY_Job_T* job, void* dst, const void* src, uint32_t len);
+void DMA_COPY_Fill(DMA_COPY_Job_T* job, void* dst, uint8_t value, uint32_t len);
+uint8_t DMA_COPY_Done(const DMA_COPY_Job_T* job);
+void DMA_COPY_ReadStats(DMA_COPY_Stats_T* stats, uint8_t clear);
+
+/**@} end of group DMA_COPY_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_COPY_H */
@@ -0,0 +1,243 @@
+/*!
+ * @file        dma_mgr.h
+ *
+ * @brief       Header for dma_mgr.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __DMA_MGR_H
+#define __DMA_MGR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "apm32f10x.h"
+#include "apm32f10x_dma.h"
+#include "reg_inline.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup DMA_MGR_Macros Macros
+  @{
+*/
+
+/* Channel ids, DMA1 channels 1 to 7 then DMA2 channels 1 to 5 */
+#define DMA_MGR_DMA1(n)         ((n) - 1)
+#define DMA_MGR_DMA2(n)         ((n) + 6)
+
+#if defined (APM32F10X_HD) || defined (APM32F10X_CL)
+#define DMA_MGR_CHANNEL_NUM     12
+#else
+#define DMA_MGR_CHANNEL_NUM     7
+#endif
+
+/*
+ * A request is the channel id in the low nibble and the peripheral in the
+ * high bits. Each peripheral request is wired to exactly one channel, so two
+ * requests with the same channel id cannot run at the same time.
+ */
+#define DMA_MGR_REQUEST(id, n)  ((uint16_t)(((n) << 4) | (id)))
+#define DMA_MGR_REQ_CHANNEL(r)  ((uint8_t)((r) & 0x0F))
+
+/* No DMA request, the peripheral is served by interrupts */
+#define DMA_MGR_REQ_NONE        ((uint16_t)0xFFFF)
+
+/* Memory to memory on a given channel or on the first free one */
+#define DMA_MGR_REQ_MEM(id)     DMA_MGR_REQUEST(id, 0xF)
+#define DMA_MGR_REQ_MEM_ANY     DMA_MGR_REQUEST(0xF, 0xF)
+
+/* DMA1 channel 1 */
+#define DMA_MGR_REQ_ADC1            DMA_MGR_REQUEST(DMA_MGR_DMA1(1), 0)
+#define DMA_MGR_REQ_TMR2_CH3        DMA_MGR_REQUEST(DMA_MGR_DMA1(1), 1)
+#define DMA_MGR_REQ_TMR4_CH1        DMA_MGR_REQUEST(DMA_MGR_DMA1(1), 2)
+
+/* DMA1 channel 2 */
+#define DMA_MGR_REQ_SPI1_RX         DMA_MGR_REQUEST(DMA_MGR_DMA1(2), 0)
+#define DMA_MGR_REQ_USART3_TX       DMA_MGR_REQUEST(DMA_MGR_DMA1(2), 1)
+#define DMA_MGR_REQ_TMR1_CH1        DMA_MGR_REQUEST(DMA_MGR_DMA1(2), 2)
+#define DMA_MGR_REQ_TMR2_UP         DMA_MGR_REQUEST(DMA_MGR_DMA1(2), 3)
+#define DMA_MGR_REQ_TMR3_CH3        DMA_MGR_REQUEST(DMA_MGR_DMA1(2), 4)
+
+/* DMA1 channel 3 */
+#define DMA_MGR_REQ_SPI1_TX         DMA_MGR_REQUEST(DMA_MGR_DMA1(3), 0)
+#define DMA_MGR_REQ_USART3_RX       DMA_MGR_REQUEST(DMA_MGR_DMA1(3), 1)
+#define DMA_MGR_REQ_TMR1_CH2        DMA_MGR_REQUEST(DMA_MGR_DMA1(3), 2)
+#define DMA_MGR_REQ_TMR3_CH4        DMA_MGR_REQUEST(DMA_MGR_DMA1(3), 3)
+#define DMA_MGR_REQ_TMR3_UP         DMA_MGR_REQUEST(DMA_MGR_DMA1(3), 4)
+
+/* DMA1 channel 4 */
+#define DMA_MGR_REQ_SPI2_RX         DMA_MGR_REQUEST(DMA_MGR_DMA1(4), 0)
+#define DMA_MGR_REQ_USART1_TX       DMA_MGR_REQUEST(DMA_MGR_DMA1(4), 1)
+#define DMA_MGR_REQ_I2C2_TX         DMA_MGR_REQUEST(DMA_MGR_DMA1(4), 2)
+#define DMA_MGR_REQ_TMR1_CH4        DMA_MGR_REQUEST(DMA_MGR_DMA1(4), 3)
+#define DMA_MGR_REQ_TMR1_TRIG       DMA_MGR_REQUEST(DMA_MGR_DMA1(4), 4)
+#define DMA_MGR_REQ_TMR1_COM        DMA_MGR_REQUEST(DMA_MGR_DMA1(4), 5)
+#define DMA_MGR_REQ_TMR4_CH2        DMA_MGR_REQUEST(DMA_MGR_DMA1(4), 6)
+
+/* DMA1 channel 5 */
+#define DMA_MGR_REQ_SPI2_TX         DMA_MGR_REQUEST(DMA_MGR_DMA1(5), 0)
+#define DMA_MGR_REQ_USART1_RX       DMA_MGR_REQUEST(DMA_MGR_DMA1(5), 1)
+#define DMA_MGR_REQ_I2C2_RX         DMA_MGR_REQUEST(DMA_MGR_DMA1(5), 2)
+#define DMA_MGR_REQ_TMR1_UP         DMA_MGR_REQUEST(DMA_MGR_DMA1(5), 3)
+#define DMA_MGR_REQ_TMR2_CH1        DMA_MGR_REQUEST(DMA_MGR_DMA1(5), 4)
+#define DMA_MGR_REQ_TMR4_CH3        DMA_MGR_REQUEST(DMA_MGR_DMA1(5), 5)
+
+/* DMA1 channel 6 */
+#define DMA_MGR_REQ_USART2_RX       DMA_MGR_REQUEST(DMA_MGR_DMA1(6), 0)
+#define DMA_MGR_REQ_I2C1_TX         DMA_MGR_REQUEST(DMA_MGR_DMA1(6), 1)
+#define DMA_MGR_REQ_TMR1_CH3        DMA_MGR_REQUEST(DMA_MGR_DMA1(6), 2)
+#define DMA_MGR_REQ_TMR3_CH1        DMA_MGR_REQUEST(DMA_MGR_DMA1(6), 3)
+#define DMA_MGR_REQ_TMR3_TRIG       DMA_MGR_REQUEST(DMA_MGR_DMA1(6), 4)
+
+/* DMA1 channel 7 */
+#define DMA_MGR_REQ_USART2_TX       DMA_MGR_REQUEST(DMA_MGR_DMA1(7), 0)
+#define DMA_MGR_REQ_I2C1_RX         DMA_MGR_REQUEST(DMA_MGR_DMA1(7), 1)
+#define DMA_MGR_REQ_TMR2_CH2        DMA_MGR_REQUEST(DMA_MGR_DMA1(7), 2)
+#define DMA_MGR_REQ_TMR2_CH4        DMA_MGR_REQUEST(DMA_MGR_DMA1(7), 3)
+#define DMA_MGR_REQ_TMR4_UP         DMA_MGR_REQUEST(DMA_MGR_DMA1(7), 4)
+
+/* DMA2 channel 1 */
+#define DMA_MGR_REQ_SPI3_RX         DMA_MGR_REQUEST(DMA_MGR_DMA2(1), 0)
+#define DMA_MGR_REQ_TMR5_CH4        DMA_MGR_REQUEST(DMA_MGR_DMA2(1), 1)
+#define DMA_MGR_REQ_TMR5_TRIG       DMA_MGR_REQUEST(DMA_MGR_DMA2(1), 2)
+#define DMA_MGR_REQ_TMR8_CH3        DMA_MGR_REQUEST(DMA_MGR_DMA2(1), 3)
+#define DMA_MGR_REQ_TMR8_UP         DMA_MGR_REQUEST(DMA_MGR_DMA2(1), 4)
+
+/* DMA2 channel 2 */
+#define DMA_MGR_REQ_SPI3_TX         DMA_MGR_REQUEST(DMA_MGR_DMA2(2), 0)
+#define DMA_MGR_REQ_TMR5_CH3        DMA_MGR_REQUEST(DMA_MGR_DMA2(2), 1)
+#define DMA_MGR_REQ_TMR5_UP         DMA_MGR_REQUEST(DMA_MGR_DMA2(2), 2)
+#define DMA_MGR_REQ_TMR8_CH4        DMA_MGR_REQUEST(DMA_MGR_DMA2(2), 3)
+#define DMA_MGR_REQ_TMR8_TRIG       DMA_MGR_REQUEST(DMA_MGR_DMA2(2), 4)
+#define DMA_MGR_REQ_TMR8_COM        DMA_MGR_REQUEST(DMA_MGR_DMA2(2), 5)
+
+/* DMA2 channel 3 */
+#define DMA_MGR_REQ_UART4_RX        DMA_MGR_REQUEST(DMA_MGR_DMA2(3), 0)
+#define DMA_MGR_REQ_TMR6_UP         DMA_MGR_REQUEST(DMA_MGR_DMA2(3), 1)
+#define DMA_MGR_REQ_DAC1            DMA_MGR_REQUEST(DMA_MGR_DMA2(3), 2)
+#define DMA_MGR_REQ_TMR8_CH1        DMA_MGR_REQUEST(DMA_MGR_DMA2(3), 3)
+
+/* DMA2 channel 4 */
+#define DMA_MGR_REQ_SDIO            DMA_MGR_REQUEST(DMA_MGR_DMA2(4), 0)
+#define DMA_MGR_REQ_TMR5_CH2        DMA_MGR_REQUEST(DMA_MGR_DMA2(4), 1)
+#define DMA_MGR_REQ_TMR7_UP         DMA_MGR_REQUEST(DMA_MGR_DMA2(4), 2)
+#define DMA_MGR_REQ_DAC2            DMA_MGR_REQUEST(DMA_MGR_DMA2(4), 3)
+
+/* DMA2 channel 5 */
+#define DMA_MGR_REQ_ADC3            DMA_MGR_REQUEST(DMA_MGR_DMA2(5), 0)
+#define DMA_MGR_REQ_UART4_TX        DMA_MGR_REQUEST(DMA_MGR_DMA2(5), 1)
+#define DMA_MGR_REQ_TMR5_CH1        DMA_MGR_REQUEST(DMA_MGR_DMA2(5), 2)
+#define DMA_MGR_REQ_TMR8_CH2        DMA_MGR_REQUEST(DMA_MGR_DMA2(5), 3)
+
+/* Channel events passed to a callback, the TC, HT and TERR bits of INTSTS and CHCFG */
+#define DMA_MGR_EVENT_TC        0x02
+#define DMA_MGR_EVENT_HT        0x04
+#define DMA_MGR_EVENT_TERR      0x08
+#define DMA_MGR_EVENT_ALL       (DMA_MGR_EVENT_TC | DMA_MGR_EVENT_HT | DMA_MGR_EVENT_TERR)
+
+/**@} end of group DMA_MGR_Macros */
+
+/** @defgroup DMA_MGR_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Channel event callback, run from the channel IRQ with the enabled
+ *          DMA_MGR_EVENT_xxx flags that were set, already cleared
+ */
+typedef void (*DMA_MGR_Callback_T)(void* context, uint8_t events);
+
+/**
+ * @brief   Manager counters
+ */
+typedef struct
+{
+    uint32_t claims;       /*!< Channels handed out */
+    uint32_t conflicts;    /*!< Claims refused, the channel had another owner */
+    uint32_t events;       /*!< Callbacks run */
+    uint32_t unowned;      /*!< Channel interrupts without an owner, flags cleared */
+} DMA_MGR_Stats_T;
+
+/**
+ * @brief   Register image of a channel setup, built once by DMA_MGR_MakeImage()
+ */
+typedef struct
+{
+    uint32_t chcfg;        /*!< CHCFG with the interrupt enables, EN clear */
+    uint32_t chndata;      /*!< Items to transfer */
+    uint32_t chpaddr;      /*!< Peripheral address */
+    uint32_t chmaddr;      /*!< Memory address */
+} DMA_MGR_Image_T;
+
+/**@} end of group DMA_MGR_Structures */
+
+/** @defgroup DMA_MGR_Functions Functions
+  @{
+*/
+
+DMA_Channel_T* DMA_MGR_Claim(uint16_t request, DMA_MGR_Callback_T callback, void* context, uint8_t priority);
+void DMA_MGR_Release(DMA_Channel_T* channel);
+void DMA_MGR_ClearFlags(DMA_Channel_T* channel);
+void DMA_MGR_Isr(IRQn_Type irq);
+void DMA_MGR_ReadStats(DMA_MGR_Stats_T* stats, uint8_t clear);
+void DMA_MGR_MakeImage(const DMA_Config_T* dmaConfig, uint8_t events, DMA_MGR_Image_T* image);
+
+/*!
+ * @brief       Stop a channel, load an image into it and start it
+ *
+ * @param       channel: channel claimed with DMA_MGR_Claim()
+ *
+ * @param       image: image made by DMA_MGR_MakeImage()
+ *
+ * @retval      None
+ *
+ * @note        Five whole-register stores, inline so that a re-arm from an
+ *              interrupt costs no call. CHNDATA and the addresses only take
+ *              a value with the channel off, hence the first CHCFG store.
+ *              Flags left by the transfer before are not cleared.
+ */
+__STATIC_FORCEINLINE void DMA_MGR_ApplyImage(DMA_Channel_T* channel, const DMA_MGR_Image_T* image)
+{
+    channel->CHCFG = image->chcfg;
+    channel->CHPADDR = image->chpaddr;
+    channel->CHMADDR = image->chmaddr;
+    channel->CHNDATA = image->chndata;
+    channel->CHCFG = image->chcfg | REG_DMA_CHCFG_EN;
+}
+
+/**@} end of group DMA_MGR_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_MGR_H */
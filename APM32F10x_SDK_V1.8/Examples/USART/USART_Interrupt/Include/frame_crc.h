@@ -0,0 +1,76 @@
+/*!
+ * @file        frame_crc.h
+ *
+ * @brief       Header for frame_crc.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __FRAME_CRC_H
+#define __FRAME_CRC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "uart_dma.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup FRAME_CRC_Macros Macros
+  @{
+*/
+
+/* Ports that can have frameCrc set */
+#ifndef FRAME_CRC_PORT_NUM
+#define FRAME_CRC_PORT_NUM      5
+#endif
+
+/* Check bytes closing a frame, CRC32_Calc() of the bytes before them least significant byte first */
+#define FRAME_CRC_LEN           4
+
+/**@} end of group FRAME_CRC_Macros */
+
+/** @defgroup FRAME_CRC_Functions Functions
+  @{
+*/
+
+void FRAME_CRC_Init(void);
+void FRAME_CRC_Attach(UART_DMA_Port_T* port);
+void FRAME_CRC_Kick(void);
+void FRAME_CRC_Isr(void);
+
+/**@} end of group FRAME_CRC_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_CRC_H */
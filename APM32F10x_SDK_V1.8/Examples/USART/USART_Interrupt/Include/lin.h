@@ -0,0 +1,190 @@
+/*!
+ * @file        lin.h
+ *
+ * @brief       Header for lin.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __LIN_H
+#define __LIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "uart_dma.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup LIN_Macros Macros
+  @{
+*/
+
+/* Clusters that can be set up with LIN_Init() */
+#ifndef LIN_CLUSTER_NUM
+#define LIN_CLUSTER_NUM         5
+#endif
+
+/* Longest response, without the checksum */
+#define LIN_DATA_MAX            8
+
+/* Sync byte after the break */
+#define LIN_SYNC                0x55
+
+/* Frame identifiers, the diagnostic ones always use the classic checksum */
+#define LIN_ID_NUM              64
+#define LIN_ID_MASTER_REQUEST   0x3C
+#define LIN_ID_SLAVE_RESPONSE   0x3D
+
+/* LIN_Frame_T direction, seen from this node */
+#define LIN_PUBLISH             0   /*!< This node sends the response */
+#define LIN_SUBSCRIBE           1   /*!< This node takes the response */
+
+/* LIN_Callback_T status */
+#define LIN_STATUS_OK           0
+#define LIN_STATUS_NO_RESPONSE  1   /*!< No response byte before the timeout */
+#define LIN_STATUS_INCOMPLETE   2   /*!< Response cut short by the timeout or a break */
+#define LIN_STATUS_CHECKSUM     3
+#define LIN_STATUS_READBACK     4   /*!< Own response read back different, bit error */
+
+/* Protected identifier of a frame identifier, parity bits P0 and P1 added */
+#define LIN_PID(id)             ((uint8_t)(((id) & 0x3F) | \
+                                 (((((id) >> 0) ^ ((id) >> 1) ^ ((id) >> 2) ^ ((id) >> 4)) & 1) << 6) | \
+                                 ((~(((id) >> 1) ^ ((id) >> 3) ^ ((id) >> 4) ^ ((id) >> 5)) & 1) << 7)))
+
+/**@} end of group LIN_Macros */
+
+/** @defgroup LIN_Structures Structures
+  @{
+*/
+
+typedef struct _LIN_Cluster_T LIN_Cluster_T;
+
+/**
+ * @brief   Called in the port interrupt when a frame of the table is done
+ */
+typedef void (*LIN_Callback_T)(LIN_Cluster_T* cluster, uint8_t frame, uint8_t status);
+
+/**
+ * @brief   Frame this node publishes or subscribes to
+ */
+typedef struct
+{
+    uint8_t   id;          /*!< Frame identifier, 0 to 63 */
+    uint8_t   direction;   /*!< LIN_PUBLISH or LIN_SUBSCRIBE */
+    uint8_t   len;         /*!< Response data bytes, 1 to LIN_DATA_MAX */
+    uint8_t   classic;     /*!< 1 for the LIN 1.x checksum, forced for the diagnostic frames */
+    uint8_t   offset;      /*!< Data at signals + offset, frames may share it */
+} LIN_Frame_T;
+
+/**
+ * @brief   Entry of a master schedule table
+ */
+typedef struct
+{
+    uint8_t   frame;       /*!< Index in the frame table */
+    uint16_t  slotMs;      /*!< Time to the next header, at least the longest frame time */
+} LIN_Slot_T;
+
+/**
+ * @brief   Cluster counters
+ */
+typedef struct
+{
+    uint32_t  headers;         /*!< Headers of a frame in the table */
+    uint32_t  frames;          /*!< Responses received or sent with a good checksum */
+    uint32_t  noResponse;
+    uint32_t  incomplete;
+    uint32_t  checksumErrors;
+    uint32_t  readbackErrors;
+    uint32_t  syncErrors;      /*!< Break not followed by LIN_SYNC */
+    uint32_t  parityErrors;    /*!< Protected identifier with wrong parity bits */
+} LIN_Stats_T;
+
+/**
+ * @brief   LIN node on a UART_DMA port in LIN mode.
+ *
+ *          The port runs with rxCallback = LIN_Receive and breakCallback =
+ *          LIN_Break. A break restarts reception; sync, protected
+ *          identifier and response then arrive through the receive DMA and
+ *          are parsed in the port interrupt, a few bytes per call. A slave
+ *          sends the response of a frame it publishes from there, by DMA.
+ *          The master sends each header of the schedule table from
+ *          LIN_Poll(). The bus is single wire, every node also receives
+ *          what it sends, so the master parses its own headers and every
+ *          publisher checks its response as it reads it back.
+ */
+struct _LIN_Cluster_T
+{
+    UART_DMA_Port_T*          port;
+    uint8_t                   master;      /*!< 1 for the master node */
+    const LIN_Frame_T*        frames;      /*!< Frame table */
+    uint8_t                   frameNum;
+    const LIN_Slot_T*         schedule;    /*!< Master schedule table, run in a loop */
+    uint8_t                   slotNum;
+    uint8_t*                  signals;     /*!< Response data of the frames */
+    LIN_Callback_T            callback;    /*!< May be NULL */
+
+    LIN_Stats_T               stats;       /*!< Private: counters, written in the port interrupt */
+    volatile uint8_t          state;       /*!< Private: parser state */
+    volatile uint8_t          busy;        /*!< Private: tx in flight */
+    uint8_t                   frame;       /*!< Private: frame of the header in progress */
+    uint8_t                   pid;         /*!< Private: its protected identifier */
+    uint8_t                   rxLen;       /*!< Private: response bytes received */
+    uint8_t                   rx[LIN_DATA_MAX + 1];   /*!< Private: response received */
+    uint8_t                   tx[LIN_DATA_MAX + 3];   /*!< Private: header and response sent */
+    uint8_t                   idMap[LIN_ID_NUM];      /*!< Private: frame index of each identifier, 0xFF for none */
+    uint8_t                   slot;        /*!< Private: schedule entry of the last header */
+    uint32_t                  slotStart;   /*!< Private: UART_DMA_TIMESTAMP() of the last header */
+    uint32_t                  deadline;    /*!< Private: response timeout */
+    UART_DMA_Request_T        request;     /*!< Private: transmit request */
+    UART_DMA_Segment_T        segment;
+};
+
+/**@} end of group LIN_Structures */
+
+/** @defgroup LIN_Functions Functions
+  @{
+*/
+
+void LIN_Init(LIN_Cluster_T* cluster);
+void LIN_Poll(LIN_Cluster_T* cluster);
+void LIN_Receive(UART_DMA_Port_T* port, const uint8_t* data, uint16_t len);
+void LIN_Break(UART_DMA_Port_T* port);
+uint8_t LIN_Checksum(uint8_t pid, const uint8_t* data, uint8_t len);
+
+/**@} end of group LIN_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIN_H */
@@ -31,6 +31,12 @@
 #include "Board.h"
 #include "apm32f10x_usart.h"
 #include "apm32f10x_dma.h"
+#include "dma_mgr.h"
+#include "uart_dma.h"
+#include "frame_crc.h"
+#include "modbus.h"
+#include "lin.h"
+#include "smartcard.h"
 
 /** @addtogroup Examples
   @{
@@ -40,13 +46,31 @@
   @{
 */
 
+/** @defgroup USART_Interrupt_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Energy proxy of the low-power main loop
+ */
+typedef struct
+{
+    uint32_t sleeps;       /*!< WFI entered with every frame handled */
+    uint64_t awakeCycles;  /*!< Core cycles from each wake up to the next WFI */
+    uint32_t wakeStamp;    /*!< UART_DMA_TIMESTAMP() of the last wake up */
+} LowPower_Stats_T;
+
+/**@} end of group USART_Interrupt_Structures */
+
 /** @defgroup USART_Interrupt_Functions Functions
   @{
 */
 
 void Delay(void);
-void USART1_Isr(void);
-void USART2_Isr(void);
+uint8_t echo_frame(UART_DMA_Port_T* port, UART_DMA_Frame_T* frame);
+void card_demo(SC_Card_T* card);
+void low_power_wait(void);
+uint32_t low_power_cycles_per_kb(void);
 /**@} end of group USART_Interrupt_Functions */
 /**@} end of group USART_Interrupt */
 /**@} end of group Examples */
@@ -0,0 +1,159 @@
+/*!
+ * @file        modbus.h
+ *
+ * @brief       Header for modbus.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __MODBUS_H
+#define __MODBUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "uart_dma.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup MODBUS_Macros Macros
+  @{
+*/
+
+/* Longest RTU frame: address, PDU of up to 253 bytes, CRC-16 */
+#define MODBUS_ADU_MAX          256
+
+/* Requests to this address are carried out by every slave, none answers */
+#define MODBUS_BROADCAST        0
+
+/* CRC-16 reset value, the check is sent least significant byte first */
+#define MODBUS_CRC_INIT         0xFFFF
+
+/* Function codes */
+#define MODBUS_FC_READ_COILS            0x01
+#define MODBUS_FC_READ_DISCRETE_INPUTS  0x02
+#define MODBUS_FC_READ_HOLDING_REGS     0x03
+#define MODBUS_FC_READ_INPUT_REGS       0x04
+#define MODBUS_FC_WRITE_COIL            0x05
+#define MODBUS_FC_WRITE_REG             0x06
+#define MODBUS_FC_WRITE_COILS           0x0F
+#define MODBUS_FC_WRITE_REGS            0x10
+
+/* Exception codes, answered with the function code | 0x80 */
+#define MODBUS_EX_ILLEGAL_FUNCTION      0x01
+#define MODBUS_EX_ILLEGAL_ADDRESS       0x02
+#define MODBUS_EX_ILLEGAL_VALUE         0x03
+
+/*
+ * Register tables hold the values in wire order, most significant byte
+ * first, so read responses are sent straight from them. MODBUS_REG()
+ * converts a value either way.
+ */
+#define MODBUS_REG(value)       ((uint16_t)((((value) & 0xFF) << 8) | (((value) >> 8) & 0xFF)))
+
+/**@} end of group MODBUS_Macros */
+
+/** @defgroup MODBUS_Structures Structures
+  @{
+*/
+
+typedef struct _MODBUS_Slave_T MODBUS_Slave_T;
+
+/**
+ * @brief   Called in MODBUS_Poll() after a request wrote coils or registers
+ */
+typedef void (*MODBUS_WriteCallback_T)(MODBUS_Slave_T* slave, uint8_t function, uint16_t start, uint16_t count);
+
+/**
+ * @brief   Slave counters
+ */
+typedef struct
+{
+    uint32_t requests;       /*!< Frames for this slave or broadcast with a good check */
+    uint32_t responses;      /*!< Responses queued, exceptions included */
+    uint32_t exceptions;
+    uint32_t broadcasts;
+    uint32_t crcErrors;      /*!< Frames with a wrong CRC-16 or shorter than 4 bytes */
+    uint32_t others;         /*!< Good frames for another slave */
+    uint32_t overlong;       /*!< Frames longer than MODBUS_ADU_MAX */
+} MODBUS_Stats_T;
+
+/**
+ * @brief   Modbus RTU slave on a deferred mode UART_DMA port.
+ *
+ *          Requests are the frames the port queues on line idle, which
+ *          stands in for the t3.5 silent interval. Each is checked and
+ *          carried out in MODBUS_Poll() and the response is sent with
+ *          UART_DMA_Send(): register reads go straight from the table, the
+ *          rest from the response buffer of the slave. Coil and discrete
+ *          input tables hold 8 per byte, least significant bit first. The
+ *          tables must not be written while a response is in flight.
+ */
+struct _MODBUS_Slave_T
+{
+    UART_DMA_Port_T*          port;            /*!< Port with a frame queue */
+    uint8_t                   address;         /*!< Slave address, 1 to 247 */
+    uint8_t*                  coils;           /*!< Read/write bits, NULL for none */
+    uint16_t                  coilNum;
+    const uint8_t*            discreteInputs;  /*!< Read only bits, NULL for none */
+    uint16_t                  discreteNum;
+    uint16_t*                 holdingRegs;     /*!< Read/write registers in wire order, NULL for none */
+    uint16_t                  holdingNum;
+    const uint16_t*           inputRegs;       /*!< Read only registers in wire order, NULL for none */
+    uint16_t                  inputNum;
+    MODBUS_WriteCallback_T    writeCallback;   /*!< May be NULL */
+
+    MODBUS_Stats_T            stats;           /*!< Private: counters, updated in MODBUS_Poll() only */
+    volatile uint8_t          busy;            /*!< Private: response in flight */
+    uint8_t                   skip;            /*!< Private: dropping the pieces of an overlong frame */
+    UART_DMA_Request_T        response;        /*!< Private: transmit request */
+    UART_DMA_Segment_T        segments[3];     /*!< Private: header, table data, check */
+    uint8_t                   crc[2];          /*!< Private: check after table data */
+    uint8_t                   adu[MODBUS_ADU_MAX];  /*!< Private: request that wraps the ring, response */
+};
+
+/**@} end of group MODBUS_Structures */
+
+/** @defgroup MODBUS_Functions Functions
+  @{
+*/
+
+void MODBUS_Init(MODBUS_Slave_T* slave);
+void MODBUS_Poll(MODBUS_Slave_T* slave);
+uint16_t MODBUS_Crc16(uint16_t crc, const uint8_t* data, uint32_t len);
+
+/**@} end of group MODBUS_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MODBUS_H */
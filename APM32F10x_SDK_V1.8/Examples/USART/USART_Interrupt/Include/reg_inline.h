@@ -0,0 +1,242 @@
+/*!
+ * @file        reg_inline.h
+ *
+ * @brief       Header for register accessors used in interrupt handlers
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __REG_INLINE_H
+#define __REG_INLINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Forced inline accessors for the register operations of the interrupt
+ * paths. Each one compiles to the loads and stores it names, whatever the
+ * optimization level, where the driver functions are calls that decode a
+ * packed enum (USART_INT_T) or read-modify-write bit fields at run time.
+ * The driver API stays the way to configure; these only cover what the
+ * ISRs do over and over. Interrupt enables and flags are the CTRL1 and
+ * STS bit masks below, not the driver enums.
+ */
+
+/* Includes */
+#include "apm32f10x.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup REG_INLINE_Macros Macros
+  @{
+*/
+
+/* DMA channel CHCFG bits */
+#define REG_DMA_CHCFG_EN        ((uint32_t)0x0001)
+#define REG_DMA_CHCFG_MINC      ((uint32_t)0x0080)
+
+/*
+ * USART STS flags whose CTRL1 interrupt enable is the same bit, so that
+ * REG_USART_ReadIntFlag() is one AND of the two registers
+ */
+#define REG_USART_TXBE          ((uint16_t)0x0080)
+#define REG_USART_TXC           ((uint16_t)0x0040)
+#define REG_USART_RXBNE         ((uint16_t)0x0020)
+#define REG_USART_IDLE          ((uint16_t)0x0010)
+
+/* Other USART bits */
+#define REG_USART_CTRL1_RXEN    ((uint16_t)0x0004)
+#define REG_USART_CTRL3_DMATXEN ((uint16_t)0x0080)
+#define REG_USART_CTRL3_DMARXEN ((uint16_t)0x0040)
+
+/* SPI STS flags and CTRL2 DMA requests */
+#define REG_SPI_RXBNE           ((uint16_t)0x0001)
+#define REG_SPI_TXBE            ((uint16_t)0x0002)
+#define REG_SPI_BUSY            ((uint16_t)0x0080)
+#define REG_SPI_CTRL2_RXDEN     ((uint16_t)0x0001)
+#define REG_SPI_CTRL2_TXDEN     ((uint16_t)0x0002)
+
+/**@} end of group REG_INLINE_Macros */
+
+/** @defgroup REG_INLINE_Functions Functions
+  @{
+*/
+
+/* DMA channel */
+
+__STATIC_FORCEINLINE void REG_DMA_Enable(DMA_Channel_T* channel)
+{
+    channel->CHCFG |= REG_DMA_CHCFG_EN;
+}
+
+__STATIC_FORCEINLINE void REG_DMA_Disable(DMA_Channel_T* channel)
+{
+    channel->CHCFG &= ~REG_DMA_CHCFG_EN;
+}
+
+__STATIC_FORCEINLINE uint16_t REG_DMA_ReadDataNumber(DMA_Channel_T* channel)
+{
+    return (uint16_t)channel->CHNDATA;
+}
+
+__STATIC_FORCEINLINE void REG_DMA_ConfigDataNumber(DMA_Channel_T* channel, uint16_t count)
+{
+    channel->CHNDATA = count;
+}
+
+/* Stop the channel, give it a new memory address and count and start it: one read, four writes */
+__STATIC_FORCEINLINE void REG_DMA_Rearm(DMA_Channel_T* channel, uint32_t addr, uint16_t count)
+{
+    uint32_t cfg = channel->CHCFG & ~REG_DMA_CHCFG_EN;
+
+    channel->CHCFG = cfg;
+    channel->CHMADDR = addr;
+    channel->CHNDATA = count;
+    channel->CHCFG = cfg | REG_DMA_CHCFG_EN;
+}
+
+/* USART */
+
+__STATIC_FORCEINLINE uint16_t REG_USART_ReadStatus(USART_T* usart)
+{
+    return (uint16_t)usart->STS;
+}
+
+/* flag: REG_USART_TXBE, REG_USART_TXC, REG_USART_RXBNE or REG_USART_IDLE */
+__STATIC_FORCEINLINE uint8_t REG_USART_ReadIntFlag(USART_T* usart, uint16_t flag)
+{
+    return (usart->STS & usart->CTRL1 & flag) ? 1 : 0;
+}
+
+/* Only TXC, RXBNE, LBD and CTS clear by writing 0, the write leaves the other flags alone */
+__STATIC_FORCEINLINE void REG_USART_ClearStatusFlag(USART_T* usart, uint16_t flag)
+{
+    usart->STS = (uint16_t)~flag;
+}
+
+__STATIC_FORCEINLINE uint16_t REG_USART_RxData(USART_T* usart)
+{
+    return (uint16_t)(usart->DATA & 0x01FF);
+}
+
+__STATIC_FORCEINLINE void REG_USART_TxData(USART_T* usart, uint16_t data)
+{
+    usart->DATA = data & 0x01FF;
+}
+
+/* mask: REG_USART_TXBE, REG_USART_TXC, REG_USART_RXBNE or REG_USART_IDLE interrupt enables */
+__STATIC_FORCEINLINE void REG_USART_EnableInterrupt(USART_T* usart, uint16_t mask)
+{
+    usart->CTRL1 |= mask;
+}
+
+__STATIC_FORCEINLINE void REG_USART_DisableInterrupt(USART_T* usart, uint16_t mask)
+{
+    usart->CTRL1 &= ~(uint32_t)mask;
+}
+
+__STATIC_FORCEINLINE void REG_USART_EnableRx(USART_T* usart)
+{
+    usart->CTRL1 |= REG_USART_CTRL1_RXEN;
+}
+
+__STATIC_FORCEINLINE void REG_USART_DisableRx(USART_T* usart)
+{
+    usart->CTRL1 &= ~(uint32_t)REG_USART_CTRL1_RXEN;
+}
+
+/* mask: REG_USART_CTRL3_DMATXEN and/or REG_USART_CTRL3_DMARXEN */
+__STATIC_FORCEINLINE void REG_USART_EnableDMA(USART_T* usart, uint16_t mask)
+{
+    usart->CTRL3 |= mask;
+}
+
+__STATIC_FORCEINLINE void REG_USART_DisableDMA(USART_T* usart, uint16_t mask)
+{
+    usart->CTRL3 &= ~(uint32_t)mask;
+}
+
+/* GPIO and EINT */
+
+__STATIC_FORCEINLINE void REG_GPIO_SetBit(GPIO_T* port, uint16_t pin)
+{
+    port->BSC = pin;
+}
+
+__STATIC_FORCEINLINE void REG_GPIO_ResetBit(GPIO_T* port, uint16_t pin)
+{
+    port->BC = pin;
+}
+
+__STATIC_FORCEINLINE uint8_t REG_GPIO_ReadInputBit(GPIO_T* port, uint16_t pin)
+{
+    return (port->IDATA & pin) ? 1 : 0;
+}
+
+__STATIC_FORCEINLINE void REG_EINT_ClearIntFlag(uint32_t line)
+{
+    EINT->IPEND = line;
+}
+
+/* SPI */
+
+__STATIC_FORCEINLINE uint16_t REG_SPI_ReadStatus(SPI_T* spi)
+{
+    return (uint16_t)spi->STS;
+}
+
+__STATIC_FORCEINLINE uint16_t REG_SPI_RxData(SPI_T* spi)
+{
+    return (uint16_t)spi->DATA;
+}
+
+__STATIC_FORCEINLINE void REG_SPI_TxData(SPI_T* spi, uint16_t data)
+{
+    spi->DATA = data;
+}
+
+/* mask: REG_SPI_CTRL2_TXDEN and/or REG_SPI_CTRL2_RXDEN */
+__STATIC_FORCEINLINE void REG_SPI_EnableDMA(SPI_T* spi, uint16_t mask)
+{
+    spi->CTRL2 |= mask;
+}
+
+__STATIC_FORCEINLINE void REG_SPI_DisableDMA(SPI_T* spi, uint16_t mask)
+{
+    spi->CTRL2 &= ~(uint32_t)mask;
+}
+
+/**@} end of group REG_INLINE_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __REG_INLINE_H */
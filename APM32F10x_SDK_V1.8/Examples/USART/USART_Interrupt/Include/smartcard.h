@@ -0,0 +1,167 @@
+/*!
+ * @file        smartcard.h
+ *
+ * @brief       Header for smartcard.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __SMARTCARD_H
+#define __SMARTCARD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "uart_dma.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup SC_Macros Macros
+  @{
+*/
+
+/* Cards that can be set up with SC_Init() */
+#ifndef SC_CARD_NUM
+#define SC_CARD_NUM             3
+#endif
+
+/* Longest answer to reset */
+#define SC_ATR_MAX              33
+
+/* Longest command APDU: header, Lc, 255 data bytes, Le */
+#define SC_APDU_MAX             261
+
+/* Longest response APDU: 256 data bytes and the status word */
+#define SC_RESPONSE_MAX         258
+
+/* Received bytes the card buffers between two reads */
+#define SC_RX_SIZE              512
+
+/* Information field size this side takes in T=1, sent with S(IFS request) */
+#define SC_IFSD                 254
+
+/* SC_Card_T protocol */
+#define SC_PROTOCOL_T0          0
+#define SC_PROTOCOL_T1          1
+
+/* Status word of a response APDU, its last two bytes */
+#define SC_SW(resp, len)        ((uint16_t)(((resp)[(len) - 2] << 8) | (resp)[(len) - 1]))
+#define SC_SW_OK                0x9000
+
+/**@} end of group SC_Macros */
+
+/** @defgroup SC_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Card counters
+ */
+typedef struct
+{
+    uint32_t  resets;          /*!< Answers to reset read, warm ones included */
+    uint32_t  ppsDone;         /*!< PPS exchanges that moved to the TA1 rate */
+    uint32_t  ppsDeclined;     /*!< PPS answered without PPS1, rate kept at 372/1 */
+    uint32_t  ppsFailed;       /*!< PPS exchanges that needed a warm reset */
+    uint32_t  apdus;           /*!< Commands that got a status word */
+    uint32_t  nulls;           /*!< T=0 NULL procedure bytes */
+    uint32_t  getResponses;    /*!< T=0 GET RESPONSE after 61xx */
+    uint32_t  resends;         /*!< T=0 commands sent again after 6Cxx */
+    uint32_t  waitExtensions;  /*!< T=1 S(WTX) requests */
+    uint32_t  blockErrors;     /*!< T=1 blocks received with a wrong LRC or length */
+    uint32_t  timeouts;        /*!< Characters or blocks not received in time */
+    uint32_t  errors;          /*!< Commands that failed */
+} SC_Stats_T;
+
+/**
+ * @brief   ISO 7816-3 card on a UART_DMA port in smart card mode.
+ *
+ *          The port runs with rxCallback = SC_Receive, which buffers what
+ *          the card sends, 9 data bits with even parity and 1.5 stop bits
+ *          at PCLK / (2 * prescaler) / 372. SC_Activate() resets the card,
+ *          reads and parses the answer to reset, moves to the TA1 rate with
+ *          PPS and sets up T=0 or T=1, whichever the card lists first.
+ *          SC_Transceive() then exchanges command and response APDUs. Both
+ *          block in the main loop; the data phases go out by DMA and come
+ *          in through the receive ring, the protocol timeouts run on
+ *          UART_DMA_TIMESTAMP(). Only the direct convention is supported.
+ */
+typedef struct
+{
+    UART_DMA_Port_T*          port;        /*!< Port with smartCard set */
+    GPIO_T*                   rstPort;     /*!< RST output */
+    uint16_t                  rstPin;
+
+    SC_Stats_T                stats;       /*!< Private: counters, updated in the calls only */
+    uint8_t                   atr[SC_ATR_MAX];  /*!< Private: last answer to reset */
+    uint8_t                   atrLen;
+    uint8_t                   protocol;    /*!< Private: SC_PROTOCOL_xxx in use */
+    uint8_t                   ta1;         /*!< Private: Fi and Di index the card offers */
+    uint8_t                   fi;          /*!< Private: Fi and Di index in use */
+    uint8_t                   di;
+    uint8_t                   specific;    /*!< Private: TA2 present, no PPS */
+    uint8_t                   guard;       /*!< Private: extra guard time N */
+    uint8_t                   wi;          /*!< Private: T=0 waiting integer */
+    uint8_t                   cwi;         /*!< Private: T=1 character waiting integer */
+    uint8_t                   bwi;         /*!< Private: T=1 block waiting integer */
+    uint8_t                   ifsc;        /*!< Private: T=1 information field size of the card */
+    uint8_t                   ns;          /*!< Private: T=1 send sequence number */
+    uint8_t                   nr;          /*!< Private: T=1 sequence number expected from the card */
+    uint32_t                  clockHz;     /*!< Private: card clock */
+    volatile uint8_t          busy;        /*!< Private: tx in flight */
+    volatile uint16_t         rxHead;      /*!< Private: written by SC_Receive() */
+    uint16_t                  rxTail;
+    uint8_t                   rx[SC_RX_SIZE];
+    uint8_t                   tx[SC_IFSD + 5];     /*!< Private: T=0 header or T=1 block sent */
+    uint8_t                   block[SC_IFSD + 5];  /*!< Private: T=1 block received */
+    UART_DMA_Request_T        request;     /*!< Private: transmit request */
+    UART_DMA_Segment_T        segment;
+} SC_Card_T;
+
+/**@} end of group SC_Structures */
+
+/** @defgroup SC_Functions Functions
+  @{
+*/
+
+void SC_Init(SC_Card_T* card);
+uint8_t SC_Activate(SC_Card_T* card);
+uint8_t SC_Transceive(SC_Card_T* card, const uint8_t* cmd, uint16_t cmdLen, uint8_t* resp, uint16_t* respLen);
+void SC_Deactivate(SC_Card_T* card);
+void SC_Receive(UART_DMA_Port_T* port, const uint8_t* data, uint16_t len);
+
+/**@} end of group SC_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SMARTCARD_H */
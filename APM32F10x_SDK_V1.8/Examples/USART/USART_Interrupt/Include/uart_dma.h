@@ -0,0 +1,454 @@
+/*!
+ * @file        uart_dma.h
+ *
+ * @brief       Header for uart_dma.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __UART_DMA_H
+#define __UART_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "apm32f10x.h"
+#include "apm32f10x_usart.h"
+#include "apm32f10x_dma.h"
+#include "apm32f10x_gpio.h"
+#include "apm32f10x_eint.h"
+#include "apm32f10x_tmr.h"
+#include "dma_mgr.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup UART_DMA_Macros Macros
+  @{
+*/
+
+/* Size of one send buffer used by UART_DMA_Write() */
+#ifndef UART_DMA_TX_BUF_SIZE
+#define UART_DMA_TX_BUF_SIZE    256
+#endif
+
+/*
+ * Frame timestamp source, DWT cycle counter by default. Another source, e.g.
+ * TMR counters chained to 32 bits, must be free-running over the full 32 bits
+ * and set UART_DMA_TIMESTAMP_HZ to its count rate.
+ */
+#ifndef UART_DMA_TIMESTAMP
+#define UART_DMA_TIMESTAMP()    (DWT->CYCCNT)
+#define UART_DMA_TIMESTAMP_HZ   SystemCoreClock
+#endif
+
+/* Buckets of UART_DMA_Latency_T, the last one also counts longer latencies */
+#define UART_DMA_LATENCY_BUCKETS    24
+
+/* UART_DMA_Frame_T flags */
+#define UART_DMA_FRAME_END      0x01    /*!< Frame ended by line idle, else a piece of a long frame */
+#define UART_DMA_FRAME_CONT     0x02    /*!< Frame continues the piece queued before it */
+#define UART_DMA_FRAME_CRC_OK   0x04    /*!< Frame ends in a matching FRAME_CRC check, with frameCrc */
+
+/* Number of device IRQs a port may use */
+#define UART_DMA_IRQ_NUM        61
+
+/*
+ * Hardware part of a port descriptor: USART, DMA requests and pins. The
+ * channels are claimed from DMA_MGR by UART_DMA_Init(). DMA_MGR_REQ_NONE
+ * means the UART has no DMA request in that direction and the engine falls
+ * back to RXBNE/TXBE interrupts.
+ */
+#define UART_DMA_USART1_HW      USART1, USART1_IRQn, \
+                                DMA_MGR_REQ_USART1_TX, DMA_MGR_REQ_USART1_RX, \
+                                GPIOA, GPIO_PIN_9, GPIOA, GPIO_PIN_10
+
+#define UART_DMA_USART2_HW      USART2, USART2_IRQn, \
+                                DMA_MGR_REQ_USART2_TX, DMA_MGR_REQ_USART2_RX, \
+                                GPIOA, GPIO_PIN_2, GPIOA, GPIO_PIN_3
+
+#define UART_DMA_USART3_HW      USART3, USART3_IRQn, \
+                                DMA_MGR_REQ_USART3_TX, DMA_MGR_REQ_USART3_RX, \
+                                GPIOB, GPIO_PIN_10, GPIOB, GPIO_PIN_11
+
+#if defined (APM32F10X_HD) || defined (APM32F10X_CL)
+
+#define UART_DMA_UART4_HW       UART4, UART4_IRQn, \
+                                DMA_MGR_REQ_UART4_TX, DMA_MGR_REQ_UART4_RX, \
+                                GPIOC, GPIO_PIN_10, GPIOC, GPIO_PIN_11
+
+/* UART5 has no DMA requests */
+#define UART_DMA_UART5_HW       UART5, UART5_IRQn, \
+                                DMA_MGR_REQ_NONE, DMA_MGR_REQ_NONE, \
+                                GPIOC, GPIO_PIN_12, GPIOD, GPIO_PIN_2
+
+#endif /* APM32F10X_HD || APM32F10X_CL */
+
+/* CTS and RTS pins of the USARTs with hardware flow control */
+#define UART_DMA_USART1_CTS     GPIOA, GPIO_PIN_11
+#define UART_DMA_USART1_RTS     GPIOA, GPIO_PIN_12
+#define UART_DMA_USART2_CTS     GPIOA, GPIO_PIN_0
+#define UART_DMA_USART2_RTS     GPIOA, GPIO_PIN_1
+#define UART_DMA_USART3_CTS     GPIOB, GPIO_PIN_13
+#define UART_DMA_USART3_RTS     GPIOB, GPIO_PIN_14
+
+/* Clock outputs for smart card mode, UART4/5 have none */
+#define UART_DMA_USART1_CK      GPIOA, GPIO_PIN_8
+#define UART_DMA_USART2_CK      GPIOA, GPIO_PIN_4
+#define UART_DMA_USART3_CK      GPIOB, GPIO_PIN_12
+
+/* Timer capture channels on the RX pins for auto-baud, PB11 and PC11 have none, PD2 only an ETR */
+#define UART_DMA_USART1_RX_TMR  TMR1, TMR_CHANNEL_3, TMR1_CC_IRQn
+#define UART_DMA_USART2_RX_TMR  TMR2, TMR_CHANNEL_4, TMR2_IRQn
+
+/**@} end of group UART_DMA_Macros */
+
+/** @defgroup UART_DMA_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   One piece of a scatter-gather transmit, sent straight from memory
+ */
+typedef struct
+{
+    const uint8_t *data;
+    uint16_t       len;
+} UART_DMA_Segment_T;
+
+typedef struct _UART_DMA_Request_T UART_DMA_Request_T;
+typedef struct _UART_DMA_Port_T UART_DMA_Port_T;
+
+/**
+ * @brief   Transmit completion callback, the request memory may be reused
+ */
+typedef void (*UART_DMA_TxCallback_T)(UART_DMA_Request_T* req);
+
+/**
+ * @brief   Receive callback, data points into the port receive ring
+ */
+typedef void (*UART_DMA_RxCallback_T)(UART_DMA_Port_T* port, const uint8_t* data, uint16_t len);
+
+/**
+ * @brief   LIN break callback, the bytes received before the break are handed on
+ */
+typedef void (*UART_DMA_BreakCallback_T)(UART_DMA_Port_T* port);
+
+/**
+ * @brief   Scatter-gather transmit request, owned by the caller
+ */
+struct _UART_DMA_Request_T
+{
+    const UART_DMA_Segment_T* segments;  /*!< Segment list, e.g. header, payload, trailer */
+    uint8_t                   count;     /*!< Number of segments */
+    UART_DMA_TxCallback_T     callback;  /*!< Called when the last byte is handed to USART, may be NULL */
+    void*                     context;   /*!< Free for the caller */
+
+    uint8_t                   index;     /*!< Private: segment in progress */
+    uint16_t                  offset;    /*!< Private: bytes sent of the segment without TX DMA */
+    UART_DMA_Request_T*       next;      /*!< Private: queue link */
+};
+
+/**
+ * @brief   Received frame descriptor, the data stays in the port receive ring
+ */
+typedef struct
+{
+    uint16_t offset;      /*!< Ring offset of the first byte */
+    uint16_t len;         /*!< Frame length, may wrap over the end of the ring */
+    uint32_t firstStamp;  /*!< Start bit of the first byte, from back to back characters */
+    uint32_t lastStamp;   /*!< Stop bit end of the last byte */
+    uint32_t crc;         /*!< FRAME_CRC check of the frame so far without its last 4 bytes, with frameCrc */
+    uint8_t  flags;       /*!< UART_DMA_FRAME_xxx */
+} UART_DMA_Frame_T;
+
+/**
+ * @brief   Latency histogram in UART_DMA_TIMESTAMP() units. Bucket n counts
+ *          latencies from 2^(n-1) up to 2^n - 1, bucket 0 counts zero.
+ */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t bucket[UART_DMA_LATENCY_BUCKETS];
+} UART_DMA_Latency_T;
+
+/**
+ * @brief   Line rate and character format of a port, worked out once by
+ *          UART_DMA_MakeProfile() so UART_DMA_ApplyProfile() switches to
+ *          it without a clock query or a division
+ */
+typedef struct
+{
+    uint32_t baudRate;
+    uint32_t charTime;    /*!< Line times in UART_DMA_TIMESTAMP() units */
+    uint32_t bitTime;
+    uint16_t br;          /*!< BR value, PCLK cycles per bit of the port */
+    uint16_t ctrl1;       /*!< CTRL1 word length and parity bits */
+    uint16_t ctrl2;       /*!< CTRL2 stop bits */
+} UART_DMA_Profile_T;
+
+/**
+ * @brief   Port counters, read with UART_DMA_ReadStats()
+ */
+typedef struct
+{
+    uint32_t overruns;       /*!< USART overrun errors, a byte was lost */
+    uint32_t framingErrors;
+    uint32_t noiseErrors;
+    uint32_t parityErrors;
+    uint32_t dmaErrors;      /*!< DMA transfer errors on either channel */
+    uint32_t idleEvents;
+    uint32_t rxBytes;        /*!< Bytes handed to the consumer */
+    uint32_t maxFrameLen;    /*!< Longest frame ended by line idle */
+    uint32_t ringHighWater;  /*!< Most receive ring bytes in use, from the frame last taken by the consumer */
+    uint32_t rtsHolds;       /*!< Times RTS was deasserted to stop the sender */
+    uint32_t frameDrops;     /*!< Frames lost to a full frame queue */
+    uint32_t crcErrors;      /*!< Frames ended by idle without a matching check, with frameCrc */
+    uint32_t addressDrops;   /*!< Frames for another node of the same hardware address, with multiDrop */
+    uint32_t breaks;         /*!< LIN breaks, also counted in framingErrors, with breakCallback */
+    uint32_t autoBauds;      /*!< Line rates measured and set, with autoBaud */
+    uint32_t baudRejects;    /*!< Auto-baud measurements started again, edges missed or uneven */
+} UART_DMA_Stats_T;
+
+/**
+ * @brief   RTS/CTS flow control of a port, both lines low active.
+ *
+ *          RTS is driven as a GPIO from the receive ring fill of a deferred
+ *          mode port, counted from the frame last taken with
+ *          UART_DMA_GetFrame(), which stays reserved until the next call.
+ *          It is deasserted at rtsHigh bytes or when the frame queue is
+ *          nearly full and asserted again at rtsLow. The USART RTS output
+ *          only follows the one byte data register, which DMA always keeps
+ *          empty. The fill is checked on line idle and every half ring, so
+ *          rtsHigh plus the characters the sender still sends after RTS goes
+ *          up must stay below half the ring.
+ *
+ *          CTS pauses the transmitter between characters, the DMA transfer
+ *          in progress is kept. USART1 to USART3 do it in hardware and need
+ *          their CTS pin. UART4/5 take CTS through the EINT line of the pin,
+ *          whose IRQ handler must call UART_DMA_Isr(); the line and its IRQ
+ *          belong to this port alone.
+ */
+typedef struct
+{
+    GPIO_T*   rtsPort;      /*!< RTS output, NULL for none */
+    uint16_t  rtsPin;
+    GPIO_T*   ctsPort;      /*!< CTS input, NULL for none */
+    uint16_t  ctsPin;
+    uint16_t  rtsHigh;      /*!< Ring fill that deasserts RTS */
+    uint16_t  rtsLow;       /*!< Ring fill that asserts RTS again */
+} UART_DMA_Flow_T;
+
+/**
+ * @brief   RS-485 half-duplex driver enable of a port.
+ *
+ *          DE is a high active GPIO. It is asserted before the transfer that
+ *          starts on an idle port and released in the USART transmission
+ *          complete interrupt once the queue is empty, so the bus is turned
+ *          around right after the stop bit of the last character. The guard
+ *          times busy wait in the sender and in the port interrupt, keep
+ *          them to a few bits.
+ */
+typedef struct
+{
+    GPIO_T*   dePort;       /*!< Driver enable output */
+    uint16_t  dePin;
+    uint16_t  leadBits;     /*!< Bit times DE is asserted before the first start bit */
+    uint16_t  tailBits;     /*!< Bit times DE stays asserted after the last stop bit */
+} UART_DMA_Rs485_T;
+
+/*
+ * Multi-drop reception: with multiDrop set the USART runs in mute mode with
+ * address mark wake up. A character with its top data bit set, bit 8 with 9
+ * data bits, is an address. One whose low 4 bits differ from address mutes
+ * the receiver: the frame it starts raises no DMA request and no interrupt,
+ * not even line idle. A matching one wakes the receiver and starts the frame
+ * as its first byte, and the engine drops frames whose first byte is not the
+ * whole address, e.g. on buses of more than 16 nodes. Frames still end on
+ * line idle.
+ */
+
+/*
+ * LIN mode: with breakCallback set the USART detects 11 bit breaks and
+ * USART_TxBreak() sends 13 bit ones. A break ends the frame in progress as
+ * line idle does, without the 0x00 character it is also received as, then
+ * breakCallback runs in the port interrupt. Use with rxCallback, and 8 data
+ * bits, one stop bit and no parity.
+ */
+
+/**
+ * @brief   ISO 7816 smart card mode of a port, USART1 to USART3.
+ *
+ *          The USART drives the card clock on CK and sends and receives on
+ *          its TX pin, open drain, with the card I/O line pulled up. The
+ *          receiver is off from the first character sent until TC after
+ *          the last, on the RS-485 driver timing, so the port does not read
+ *          its own characters back and listens again long before the card
+ *          may answer. Use 9 data bits with even parity and 1.5 stop bits.
+ */
+typedef struct
+{
+    GPIO_T*   clkPort;      /*!< CK output */
+    uint16_t  clkPin;
+    uint8_t   prescaler;    /*!< Card clock is PCLK / (2 * prescaler) */
+    uint8_t   guardTime;    /*!< Bit times added after each character sent, N of the ATR */
+} UART_DMA_SmartCard_T;
+
+/**
+ * @brief   Auto-baud detection of a port, USART1 and USART2.
+ *
+ *          A timer channel captures the edges of the RX pin while the
+ *          receiver is off. The first character is either 0x55, whose five
+ *          falling edges span 8 bits, or has its lowest data bit set, so the
+ *          start bit is its first low run. BR is set from the measurement in PCLK
+ *          cycles per bit, as USART_Config() sets it from a rate, and a
+ *          compare on the same channel turns the receiver on in the stop
+ *          bit of that character, so the next one is received by DMA. The
+ *          measured character itself is not received. The timer and its IRQ
+ *          belong to the port, the IRQ handler must call UART_DMA_Isr().
+ */
+typedef struct
+{
+    TMR_T*    tmr;          /*!< Timer with a capture channel on the RX pin */
+    uint16_t  channel;      /*!< TMR_CHANNEL_x */
+    IRQn_Type tmrIRQn;      /*!< Capture/compare IRQ of the timer */
+    uint32_t  minBaud;      /*!< Slowest rate to measure, sets the timer prescaler */
+    uint8_t   sync;         /*!< 1 if the first character is 0x55, 0 to time its start bit */
+} UART_DMA_AutoBaud_T;
+
+/**
+ * @brief   UART_DMA_Write() copy buffer, sent as a single segment request
+ */
+typedef struct
+{
+    UART_DMA_Request_T request;
+    UART_DMA_Segment_T segment;
+    uint8_t            data[UART_DMA_TX_BUF_SIZE];
+} UART_DMA_TxBuffer_T;
+
+/**
+ * @brief   Port descriptor. The hardware fields are filled with one of the
+ *          UART_DMA_xxx_HW macros, the buffers by the application.
+ */
+struct _UART_DMA_Port_T
+{
+    USART_T*                  usart;
+    IRQn_Type                 usartIRQn;
+    uint16_t                  txRequest;     /*!< DMA_MGR_REQ_xxx of the transmitter */
+    uint16_t                  rxRequest;     /*!< DMA_MGR_REQ_xxx of the receiver */
+    GPIO_T*                   txPort;
+    uint16_t                  txPin;
+    GPIO_T*                   rxPort;
+    uint16_t                  rxPin;
+
+    uint8_t*                  rxRing;        /*!< Receive ring */
+    uint16_t                  rxRingSize;    /*!< Receive ring size in bytes */
+    UART_DMA_TxBuffer_T*      txPool;        /*!< UART_DMA_Write() buffers */
+    uint8_t                   txPoolLen;     /*!< Number of txPool buffers */
+    UART_DMA_RxCallback_T     rxCallback;    /*!< Receive callback, may be NULL */
+    uint8_t                   priority;      /*!< NVIC preemption priority of all port IRQs */
+    UART_DMA_Frame_T*         frameQueue;    /*!< Deferred mode frame queue, NULL to use rxCallback */
+    uint8_t                   frameQueueLen; /*!< Number of frameQueue entries */
+    const UART_DMA_Flow_T*    flow;          /*!< RTS/CTS flow control, NULL for none */
+    uint8_t                   frameCrc;      /*!< 1 to check deferred mode frames with FRAME_CRC */
+    const UART_DMA_Rs485_T*   rs485;         /*!< RS-485 driver enable, NULL for none, not with flow */
+    uint8_t                   multiDrop;     /*!< 1 to receive only frames that start with address */
+    uint8_t                   address;       /*!< Multi-drop node address, the USART matches the low 4 bits */
+    UART_DMA_BreakCallback_T  breakCallback; /*!< LIN mode break callback, NULL for none */
+    const UART_DMA_SmartCard_T* smartCard;   /*!< Smart card mode, NULL for none, not with rs485 */
+    const UART_DMA_AutoBaud_T* autoBaud;     /*!< Rate measured from the first character, NULL for none */
+
+    /* Private */
+    DMA_Channel_T*            txChannel;     /*!< Claimed for txRequest, NULL without TX DMA */
+    DMA_Channel_T*            rxChannel;     /*!< Claimed for rxRequest, NULL without RX DMA */
+    volatile uint16_t         rxRead;        /*!< Read cursor of rxRing */
+    volatile uint16_t         rxWrite;       /*!< Write cursor of rxRing without RX DMA */
+    volatile uint8_t          txPoolHead;
+    volatile uint8_t          txPoolTail;
+    UART_DMA_Request_T* volatile txFirst;    /*!< Request on the wire */
+    UART_DMA_Request_T* volatile txLast;
+    volatile uint8_t          frameHead;     /*!< Written by the port ISR only */
+    volatile uint8_t          frameTail;     /*!< Written by the consumer only */
+    volatile uint8_t          crcHead;       /*!< Frames before it carry their check, written by FRAME_CRC only */
+    uint32_t                  crcRun;        /*!< Check of the pieces of a long frame so far */
+    volatile uint16_t         rxTaken;       /*!< Ring offset of the frame last taken, written by the consumer only */
+    uint32_t                  charTime;      /*!< Timestamp units per character on the line */
+    uint32_t                  bitTime;       /*!< Timestamp units per bit on the line */
+    uint32_t                  rxFrameLen;    /*!< Bytes of the frame in progress */
+    uint8_t                   rxForeign;     /*!< The frame in progress is for another node */
+    UART_DMA_Stats_T          stats;         /*!< Written by the port ISRs only */
+    IRQn_Type                 ctsIRQn;       /*!< EINT IRQ of a CTS pin polled in software */
+    uint8_t                   ctsSoft;       /*!< 1 when CTS is handled by ctsIRQn */
+    volatile uint8_t          rtsHeld;       /*!< 1 while RTS is deasserted */
+    volatile uint8_t          txHeld;        /*!< 1 while CTS is deasserted and ctsSoft is set */
+    volatile uint8_t          deOn;          /*!< 1 while the RS-485 driver is enabled or the smart card receiver off */
+    volatile uint32_t         baudRate;      /*!< Line rate, 0 while auto-baud measures */
+    uint32_t                  abPclk;        /*!< Auto-baud USART clock */
+    uint32_t                  abClock;       /*!< Auto-baud counter clock */
+    volatile uint8_t          abEdges;       /*!< Edges captured, UART_DMA_AB_LOCKED once the rate is set */
+    uint16_t                  abFirst;       /*!< Capture of the first falling edge */
+    uint16_t                  abLast;        /*!< Capture of the edge before */
+    uint16_t                  abMin;         /*!< Shortest and longest time between two edges */
+    uint16_t                  abMax;
+};
+
+/**@} end of group UART_DMA_Structures */
+
+/** @defgroup UART_DMA_Functions Functions
+  @{
+*/
+
+void UART_DMA_Init(UART_DMA_Port_T* port, USART_Config_T* usartConfig);
+void UART_DMA_ConfigBaudRate(UART_DMA_Port_T* port, uint32_t baudRate);
+void UART_DMA_MakeProfile(UART_DMA_Port_T* port, const USART_Config_T* usartConfig, UART_DMA_Profile_T* profile);
+uint8_t UART_DMA_ApplyProfile(UART_DMA_Port_T* port, const UART_DMA_Profile_T* profile);
+void UART_DMA_AutoBaud(UART_DMA_Port_T* port);
+uint32_t UART_DMA_ReadBaudRate(UART_DMA_Port_T* port);
+uint8_t UART_DMA_Send(UART_DMA_Port_T* port, UART_DMA_Request_T* req);
+uint16_t UART_DMA_Write(UART_DMA_Port_T* port, const uint8_t* buf, uint16_t len);
+void UART_DMA_Isr(IRQn_Type irq);
+uint8_t UART_DMA_GetFrame(UART_DMA_Port_T* port, UART_DMA_Frame_T* frame);
+uint8_t UART_DMA_FramePending(UART_DMA_Port_T* port);
+uint8_t UART_DMA_FrameSegments(UART_DMA_Port_T* port, const UART_DMA_Frame_T* frame, UART_DMA_Segment_T* seg);
+uint32_t UART_DMA_FrameAge(const UART_DMA_Frame_T* frame);
+void UART_DMA_ReadStats(UART_DMA_Port_T* port, UART_DMA_Stats_T* stats, uint8_t clear);
+void UART_DMA_LatencyReset(UART_DMA_Latency_T* hist);
+void UART_DMA_LatencyAdd(UART_DMA_Latency_T* hist, uint32_t latency);
+
+/**@} end of group UART_DMA_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_DMA_H */
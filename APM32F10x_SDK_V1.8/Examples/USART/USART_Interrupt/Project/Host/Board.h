@@ -0,0 +1,40 @@
+/*!
+ * @file        Board.h
+ *
+ * @brief       Board header of the host simulation
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef BOARD_H
+#define BOARD_H
+
+/*
+ * Found before Boards/Board.h on the host include path. Same board header,
+ * reached with a '/' path separator.
+ */
+#if defined (APM32F103_MINI)
+#include "Board_APM32F103_MINI/inc/Board_APM32F103_MINI.h"
+#else
+#error "The host simulation models the APM32F103 MINI board only"
+#endif
+
+#endif /* BOARD_H */
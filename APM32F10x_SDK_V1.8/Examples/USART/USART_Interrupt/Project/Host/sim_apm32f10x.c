@@ -0,0 +1,2732 @@
+/*!
+ * @file        sim_apm32f10x.c
+ *
+ * @brief       Host register model of the APM32F103 USART, DMA and NVIC
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * The peripheral space is host memory mapped at the device addresses, so the
+ * StdPeriph driver and the example run unmodified on x86-64 Linux. Pages with
+ * side-effect registers (USART, DMA, GPIO/EINT, CRC, TMR1/2 and the NVIC) are kept
+ * inaccessible: an access faults, is single stepped and then given its
+ * hardware meaning, e.g. reading DATA after STS clears IDLE, writing INTFCLR
+ * clears DMA flags, writing BSC moves a pin. The model reaches the same
+ * memory through an alias mapping without faulting.
+ *
+ * Time is simulated core cycles. A SIGALRM tick advances it, moves characters
+ * on the lines and DMA channels and enters interrupt handlers, preempting the
+ * application wherever it is, like a real interrupt. Handlers are not nested.
+ * The application gets a fixed slice of host time between two ticks.
+ */
+
+/* Includes */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <x86intrin.h>
+#include "sim_apm32f10x.h"
+#include "Board.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup SIM_Macros Macros
+  @{
+*/
+
+/* Mapped device memory: APB1, APB2 and AHB up to CRC, then the SCS page */
+#define SIM_PAGE                0x1000
+#define SIM_PERIPH_SIZE         0x30000
+#define SIM_SCS_OFFSET          SIM_PERIPH_SIZE
+#define SIM_MEM_SIZE            (SIM_PERIPH_SIZE + SIM_PAGE)
+
+/* Reserved device memory after the mapped pages, a DMA access is a bus error */
+#define SIM_RESERVED_BASE       (PERIPH_BASE + SIM_PERIPH_SIZE)
+#define SIM_RESERVED_END        0x50000000
+
+/* x86 trap flag */
+#define SIM_EFLAGS_TF           0x100
+
+/* Interrupts entered by one dispatch before it gives up */
+#define SIM_DISPATCH_MAX        1000
+
+/* Core cycles charged for exception entry and return, as on Cortex-M3 */
+#define SIM_EXC_ENTRY_CYCLES    12
+#define SIM_EXC_RETURN_CYCLES   12
+
+/* Core cycles charged for a peripheral register access through the APB bridge */
+#define SIM_BUS_CYCLES          3
+
+/* Accesses timed to find the host cost of a trap */
+#define SIM_TRAP_CALIBRATE      256
+
+/* Number of device IRQs */
+#define SIM_IRQ_NUM             61
+
+/* USART register offsets and STS bits */
+#define SIM_USART_STS           0x00
+#define SIM_USART_DATA          0x04
+#define SIM_USART_BR            0x08
+#define SIM_USART_CTRL1         0x0C
+#define SIM_USART_CTRL2         0x10
+#define SIM_USART_CTRL3         0x14
+#define SIM_USART_SIZE          0x1C
+
+#define SIM_STS_PE              0x0001
+#define SIM_STS_FE              0x0002
+#define SIM_STS_NE              0x0004
+#define SIM_STS_ORE             0x0008
+#define SIM_STS_IDLE            0x0010
+#define SIM_STS_RXBNE           0x0020
+#define SIM_STS_TC              0x0040
+#define SIM_STS_TXBE            0x0080
+#define SIM_STS_LBD             0x0100
+#define SIM_STS_CTS             0x0200
+#define SIM_STS_RC_W0           (SIM_STS_RXBNE | SIM_STS_TC | SIM_STS_LBD | SIM_STS_CTS)
+#define SIM_STS_RESET           (SIM_STS_TXBE | SIM_STS_TC)
+
+#define SIM_CTRL1_TXBF          0x0001
+#define SIM_CTRL1_RXMUTEEN      0x0002
+#define SIM_CTRL1_RXEN          0x0004
+#define SIM_CTRL1_TXEN          0x0008
+#define SIM_CTRL1_IDLEIEN       0x0010
+#define SIM_CTRL1_RXBNEIEN      0x0020
+#define SIM_CTRL1_TXCIEN        0x0040
+#define SIM_CTRL1_TXBEIEN       0x0080
+#define SIM_CTRL1_PEIEN         0x0100
+#define SIM_CTRL1_WUPMCFG       0x0800
+#define SIM_CTRL1_WLEN          0x1000
+#define SIM_CTRL1_UEN           0x2000
+
+#define SIM_CTRL2_ADDR          0x000F
+#define SIM_CTRL2_LBDIEN        0x0040
+#define SIM_CTRL2_STOP_POS      12
+#define SIM_CTRL2_LINMEN        0x4000
+
+#define SIM_CTRL3_ERRIEN        0x0001
+#define SIM_CTRL3_DMARXEN       0x0040
+#define SIM_CTRL3_DMATXEN       0x0080
+#define SIM_CTRL3_CTSEN         0x0200
+#define SIM_CTRL3_CTSIEN        0x0400
+
+/* GPIO registers, GPIOA to GPIOF are modelled */
+#define SIM_GPIO_NUM            6
+#define SIM_GPIO_STRIDE         0x400
+#define SIM_GPIO_CFGLOW         0x00
+#define SIM_GPIO_CFGHIG         0x04
+#define SIM_GPIO_IDATA          0x08
+#define SIM_GPIO_ODATA          0x0C
+#define SIM_GPIO_BSC            0x10
+#define SIM_GPIO_BC             0x14
+#define SIM_GPIO_SIZE           0x1C
+#define SIM_GPIO_CFG_RESET      0x44444444
+
+/* EINT registers, lines 0 to 15 come from the GPIO pins */
+#define SIM_EINT_IMASK          0x00
+#define SIM_EINT_RTEN           0x08
+#define SIM_EINT_FTEN           0x0C
+#define SIM_EINT_IPEND          0x14
+#define SIM_EINT_GPIO_LINES     16
+
+/* AFIO EINTSEL1, four bits of GPIO port per EINT line */
+#define SIM_AFIO_EINTSEL        0x08
+
+/* CRC register offsets, the unit shifts 32 bits per data word */
+#define SIM_CRC_DATA            0x00
+#define SIM_CRC_INDATA          0x04
+#define SIM_CRC_CTRL            0x08
+#define SIM_CRC_SIZE            0x0C
+#define SIM_CRC_POLY            0x04C11DB7
+#define SIM_CRC_RESET           0xFFFFFFFF
+
+/* DMA register offsets and channel configuration bits */
+#define SIM_DMA_INTSTS          0x00
+#define SIM_DMA_INTFCLR         0x04
+#define SIM_DMA_CHANNEL         0x08
+#define SIM_DMA_STRIDE          0x14
+#define SIM_DMA_CHCFG           0x00
+#define SIM_DMA_CHNDATA         0x04
+#define SIM_DMA_CHPADDR         0x08
+#define SIM_DMA_CHMADDR         0x0C
+
+#define SIM_CHCFG_EN            0x0001
+#define SIM_CHCFG_TCINTEN       0x0002
+#define SIM_CHCFG_HTINTEN       0x0004
+#define SIM_CHCFG_TERRINTEN     0x0008
+#define SIM_CHCFG_DIR           0x0010
+#define SIM_CHCFG_CIR           0x0020
+#define SIM_CHCFG_PINC          0x0040
+#define SIM_CHCFG_MINC          0x0080
+#define SIM_CHCFG_PSIZE_POS     8
+#define SIM_CHCFG_MSIZE_POS     10
+#define SIM_CHCFG_M2M           0x4000
+
+#define SIM_DMA_GINT            0x01
+#define SIM_DMA_TC              0x02
+#define SIM_DMA_HT              0x04
+#define SIM_DMA_TERR            0x08
+
+/* NVIC register offsets in the SCS page */
+#define SIM_NVIC_ISER           0x100
+#define SIM_NVIC_ICER           0x180
+#define SIM_NVIC_ISPR           0x200
+#define SIM_NVIC_ICPR           0x280
+#define SIM_NVIC_IP             0x400
+
+/* PendSV in the SCB: ICSR set and clear bits, SHPR3 priority byte, exception number */
+#define SIM_SCB_ICSR            0xD04
+#define SIM_ICSR_PENDSVSET      0x10000000
+#define SIM_ICSR_PENDSVCLR      0x08000000
+#define SIM_SCB_SHP_PENDSV      0xD22
+#define SIM_PENDSV_EXC          14
+
+/* USART interrupt sources of STS and their CTRL1 enables */
+#define SIM_USART_IRQ_CTRL1(sts, ctrl1) \
+    ((((sts) & SIM_STS_TXBE) && ((ctrl1) & SIM_CTRL1_TXBEIEN)) || \
+     (((sts) & SIM_STS_TC) && ((ctrl1) & SIM_CTRL1_TXCIEN)) || \
+     (((sts) & (SIM_STS_RXBNE | SIM_STS_ORE)) && ((ctrl1) & SIM_CTRL1_RXBNEIEN)) || \
+     (((sts) & SIM_STS_IDLE) && ((ctrl1) & SIM_CTRL1_IDLEIEN)) || \
+     (((sts) & SIM_STS_PE) && ((ctrl1) & SIM_CTRL1_PEIEN)))
+
+/* TMR registers and bits, one channel per timer is modelled: the one on an RX pin */
+#define SIM_TMR_NUM             2
+#define SIM_TMR_CTRL1           0x00
+#define SIM_TMR_DIEN            0x0C
+#define SIM_TMR_STS             0x10
+#define SIM_TMR_CEG             0x14
+#define SIM_TMR_CCM1            0x18
+#define SIM_TMR_CCEN            0x20
+#define SIM_TMR_CNT             0x24
+#define SIM_TMR_PSC             0x28
+#define SIM_TMR_AUTORLD         0x2C
+#define SIM_TMR_CC1             0x34
+#define SIM_TMR_SIZE            0x50
+
+#define SIM_TMR_CEN             0x0001
+#define SIM_TMR_UEG             0x0001
+#define SIM_TMR_STS_CC          0x001E
+#define SIM_TMR_STS_CC1         0x0002
+#define SIM_TMR_STS_CC1RC       0x0200
+#define SIM_TMR_CCEN_POL        0x0002
+#define SIM_TMR_CCEN_NPOL       0x0008
+#define SIM_TMR_AUTORLD_RESET   0xFFFF
+
+/* CCxSEL of a channel: 0 compare, 1 capture of its own input */
+#define SIM_TMR_SEL(base, ch)   ((SIM_REG((base) + SIM_TMR_CCM1 + 4 * ((ch) / 2)) >> (8 * ((ch) % 2))) & 3)
+
+/* Register word in the model view */
+#define SIM_REG(addr)           (*(volatile uint32_t*)SIM_Alias(addr))
+
+/**@} end of group SIM_Macros */
+
+/** @defgroup SIM_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Fixed wiring of a serial line
+ */
+typedef struct
+{
+    uint32_t  usart;      /*!< Register block */
+    IRQn_Type irq;
+    uint8_t   apb;        /*!< APB bus number */
+    int8_t    txDma;      /*!< Channel index of the TX request, -1 if none */
+    int8_t    rxDma;      /*!< Channel index of the RX request, -1 if none */
+    uint32_t  ctsPort;    /*!< GPIO of the CTS input, 0 if none */
+    uint16_t  ctsPin;
+} SIM_LineHw_T;
+
+/**
+ * @brief   Fixed wiring of a timer channel on an RX pin
+ */
+typedef struct
+{
+    uint32_t  base;       /*!< Register block */
+    IRQn_Type irq;        /*!< Capture/compare IRQ */
+    uint8_t   apb;        /*!< APB bus number */
+    uint8_t   line;       /*!< Line whose RX pin is the channel input */
+    uint8_t   channel;    /*!< Channel 0 to 3 */
+} SIM_TmrHw_T;
+
+/**
+ * @brief   Character waiting on a receive line
+ */
+typedef struct
+{
+    uint16_t data;        /*!< Data and SIM_CHAR_xxx error flags */
+    uint16_t idleBits;    /*!< Idle bit times in front of the start bit */
+} SIM_RxChar_T;
+
+/**
+ * @brief   Dynamic state of a serial line
+ */
+typedef struct
+{
+    SIM_RxChar_T rxQueue[SIM_RX_QUEUE_LEN];
+    uint32_t     rxHead;
+    uint32_t     rxTail;
+    uint8_t      rxBusy;
+    uint64_t     rxStart;     /*!< Start bit of the character on the wire */
+    uint64_t     rxEnd;       /*!< Stop bit end of the character on the wire */
+    uint64_t     rxFree;      /*!< Line idle since */
+    uint64_t     idleAt;      /*!< IDLE detection time, 0 if not armed */
+    uint64_t     idleCancel;  /*!< idleAt cancelled by the start bit of the character on the wire */
+    uint16_t     rdr;
+
+    uint16_t     tdr;
+    uint8_t      tdrFull;
+    uint16_t     shift;
+    uint8_t      txBusy;
+    uint64_t     txEnd;
+
+    uint8_t      stsRead;     /*!< STS read, a DATA access completes the clear sequence */
+    uint32_t     stsSnapshot;
+
+    uint32_t     rtsPort;     /*!< GPIO that holds the sender back while high, 0 if none */
+    uint16_t     rtsPin;
+
+    uint32_t     dePort;      /*!< GPIO of the RS-485 driver enable, 0 if none */
+    uint16_t     dePin;
+    uint8_t      deLost;      /*!< The character on the wire started with DE low */
+    uint64_t     deIdleAt;    /*!< Cycle counter at the last stop bit with DE high, 0 if none */
+
+    uint32_t     bitCycles;   /*!< Bit time of the sender, 0 to follow BR */
+    uint8_t      rxMissed;    /*!< Receiver turned on after the start bit of the character on the wire */
+    uint64_t     edge[12];    /*!< Edges of the character on the wire, with SIM_TmrHw_T wiring */
+    uint8_t      edgeLevel[12];
+    uint8_t      edgeNum;
+    uint8_t      edgeNext;
+} SIM_Line_T;
+
+/**
+ * @brief   Counter state of a timer
+ */
+typedef struct
+{
+    uint64_t origin;      /*!< Simulated time the counter held base */
+    uint32_t base;
+    uint64_t compareAt;   /*!< Next match of the channel in compare mode, 0 if none */
+} SIM_Tmr_T;
+
+/**
+ * @brief   Internal counters of a DMA channel
+ */
+typedef struct
+{
+    uint32_t reload;
+    uint32_t index;
+} SIM_Channel_T;
+
+/**@} end of group SIM_Structures */
+
+/** @defgroup SIM_Variables Variables
+  @{
+*/
+
+/* Interrupt handlers of the application, defaults for the unused ones */
+void SIM_DefaultHandler(void);
+#define SIM_WEAK_HANDLER(name)  void name(void) __attribute__((weak, alias("SIM_DefaultHandler")))
+SIM_WEAK_HANDLER(PendSV_Handler);
+SIM_WEAK_HANDLER(EINT0_IRQHandler);
+SIM_WEAK_HANDLER(EINT1_IRQHandler);
+SIM_WEAK_HANDLER(EINT2_IRQHandler);
+SIM_WEAK_HANDLER(EINT3_IRQHandler);
+SIM_WEAK_HANDLER(EINT4_IRQHandler);
+SIM_WEAK_HANDLER(EINT9_5_IRQHandler);
+SIM_WEAK_HANDLER(EINT15_10_IRQHandler);
+SIM_WEAK_HANDLER(TMR1_CC_IRQHandler);
+SIM_WEAK_HANDLER(TMR2_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Channel1_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Channel2_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Channel3_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Channel4_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Channel5_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Channel6_IRQHandler);
+SIM_WEAK_HANDLER(DMA1_Channel7_IRQHandler);
+SIM_WEAK_HANDLER(USART1_IRQHandler);
+SIM_WEAK_HANDLER(USART2_IRQHandler);
+SIM_WEAK_HANDLER(USART3_IRQHandler);
+SIM_WEAK_HANDLER(UART4_IRQHandler);
+SIM_WEAK_HANDLER(UART5_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Channel1_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Channel2_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Channel3_IRQHandler);
+#if defined (APM32F10X_CL)
+SIM_WEAK_HANDLER(DMA2_Channel4_IRQHandler);
+SIM_WEAK_HANDLER(DMA2_Channel5_IRQHandler);
+#else
+SIM_WEAK_HANDLER(DMA2_Channel4_5_IRQHandler);
+#endif
+
+static void (*const simVector[SIM_IRQ_NUM])(void) =
+{
+    [EINT0_IRQn]         = EINT0_IRQHandler,
+    [EINT1_IRQn]         = EINT1_IRQHandler,
+    [EINT2_IRQn]         = EINT2_IRQHandler,
+    [EINT3_IRQn]         = EINT3_IRQHandler,
+    [EINT4_IRQn]         = EINT4_IRQHandler,
+    [EINT9_5_IRQn]       = EINT9_5_IRQHandler,
+    [EINT15_10_IRQn]     = EINT15_10_IRQHandler,
+    [TMR1_CC_IRQn]       = TMR1_CC_IRQHandler,
+    [TMR2_IRQn]          = TMR2_IRQHandler,
+    [DMA1_Channel1_IRQn] = DMA1_Channel1_IRQHandler,
+    [DMA1_Channel2_IRQn] = DMA1_Channel2_IRQHandler,
+    [DMA1_Channel3_IRQn] = DMA1_Channel3_IRQHandler,
+    [DMA1_Channel4_IRQn] = DMA1_Channel4_IRQHandler,
+    [DMA1_Channel5_IRQn] = DMA1_Channel5_IRQHandler,
+    [DMA1_Channel6_IRQn] = DMA1_Channel6_IRQHandler,
+    [DMA1_Channel7_IRQn] = DMA1_Channel7_IRQHandler,
+    [USART1_IRQn]        = USART1_IRQHandler,
+    [USART2_IRQn]        = USART2_IRQHandler,
+    [USART3_IRQn]        = USART3_IRQHandler,
+    [UART4_IRQn]         = UART4_IRQHandler,
+    [UART5_IRQn]         = UART5_IRQHandler,
+    [DMA2_Channel1_IRQn] = DMA2_Channel1_IRQHandler,
+    [DMA2_Channel2_IRQn] = DMA2_Channel2_IRQHandler,
+    [DMA2_Channel3_IRQn] = DMA2_Channel3_IRQHandler,
+#if defined (APM32F10X_CL)
+    [DMA2_Channel4_IRQn] = DMA2_Channel4_IRQHandler,
+    [DMA2_Channel5_IRQn] = DMA2_Channel5_IRQHandler,
+#else
+    [DMA2_Channel4_5_IRQn] = DMA2_Channel4_5_IRQHandler,
+#endif
+};
+
+/* Request wiring of the F10x DMA controllers, channel index 7 is DMA2 channel 1 */
+static const SIM_LineHw_T simLineHw[SIM_LINE_NUM] =
+{
+    {USART1_BASE, USART1_IRQn, 2,  3,  4, GPIOA_BASE, GPIO_PIN_11},
+    {USART2_BASE, USART2_IRQn, 1,  6,  5, GPIOA_BASE, GPIO_PIN_0},
+    {USART3_BASE, USART3_IRQn, 1,  1,  2, GPIOB_BASE, GPIO_PIN_13},
+    {UART4_BASE,  UART4_IRQn,  1, 11,  9, 0,          0},
+    {UART5_BASE,  UART5_IRQn,  1, -1, -1, 0,          0},
+};
+
+/* Capture channels on the RX pins: USART1 RX is TMR1 CH3, USART2 RX is TMR2 CH4 */
+static const SIM_TmrHw_T simTmrHw[SIM_TMR_NUM] =
+{
+    {TMR1_BASE, TMR1_CC_IRQn, 2, 0, 2},
+    {TMR2_BASE, TMR2_IRQn,    1, 1, 3},
+};
+
+/* Pages whose accesses are trapped */
+static const uint32_t simTrapPage[] =
+{
+    TMR2_BASE & ~(SIM_PAGE - 1),     /* TMR2 to TMR5 */
+    TMR1_BASE & ~(SIM_PAGE - 1),
+    USART2_BASE & ~(SIM_PAGE - 1),   /* USART2, USART3, UART4 */
+    UART5_BASE & ~(SIM_PAGE - 1),
+    USART1_BASE & ~(SIM_PAGE - 1),
+    DMA1_BASE & ~(SIM_PAGE - 1),     /* DMA1, DMA2 */
+    AFIO_BASE,                       /* AFIO, EINT, GPIOA, GPIOB */
+    GPIOC_BASE & ~(SIM_PAGE - 1),    /* GPIOC to GPIOF */
+    CRC_BASE & ~(SIM_PAGE - 1),
+    SCS_BASE,
+};
+
+/* Access being single stepped */
+static struct
+{
+    uint32_t addr;
+    uint32_t old;
+    uint8_t  write;
+    uint8_t  alarmBlocked;
+} simTrap;
+
+static uint8_t*       simAlias;
+static SIM_Line_T     simLine[SIM_LINE_NUM];
+static SIM_Channel_T  simChannel[SIM_DMA_CHANNEL_NUM];
+static SIM_Tmr_T      simTmr[SIM_TMR_NUM];
+static SIM_TxHook_T   simTxHook;
+static uint8_t        simLink[SIM_LINE_NUM];   /*!< Receiving line + 1 of each transmit pin, 0 if open */
+static void         (*simTickHook)(void);
+static uint32_t       simTickCycles;
+static struct itimerval simTickTimer;
+static volatile uint8_t simIrqPending;
+static volatile uint8_t simSleeping;   /*!< The application is in WFI */
+static uint64_t       simTrapCost;
+static uint16_t       simPinIn[SIM_GPIO_NUM];  /*!< Levels driven onto the input pins from outside */
+
+SIM_Stats_T simStats;
+
+volatile uint32_t simPrimask;
+volatile uint32_t simBasepri;
+volatile uint32_t simIpsr;
+volatile uint32_t simExclusive;
+
+/* Normally set up by system_apm32f10x.c */
+uint32_t SystemCoreClock = SIM_HCLK;
+
+/**@} end of group SIM_Variables */
+
+/** @defgroup SIM_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Handler of the vectors the application does not use
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+void SIM_DefaultHandler(void)
+{
+}
+
+/*!
+ * @brief       Board LEDs are not modelled
+ *
+ * @param       Led: LED2 or LED3
+ *
+ * @retval      None
+ */
+void APM_MINI_LEDInit(Led_TypeDef Led)
+{
+    (void)Led;
+}
+
+/*!
+ * @brief       Read the host time stamp counter
+ *
+ * @param       None
+ *
+ * @retval      Host CPU cycles
+ */
+uint64_t SIM_ReadHostCycles(void)
+{
+    return __rdtsc();
+}
+
+/*!
+ * @brief       Translate a device address to the model view of its memory
+ *
+ * @param       addr: device address
+ *
+ * @retval      Host pointer that does not fault
+ */
+static uint8_t* SIM_Alias(uint32_t addr)
+{
+    if (addr - PERIPH_BASE < SIM_PERIPH_SIZE)
+    {
+        return simAlias + (addr - PERIPH_BASE);
+    }
+
+    if (addr - SCS_BASE < SIM_PAGE)
+    {
+        return simAlias + SIM_SCS_OFFSET + (addr - SCS_BASE);
+    }
+
+    return (uint8_t*)(uintptr_t)addr;
+}
+
+/*!
+ * @brief       Find the trapped page of an address
+ *
+ * @param       addr: host address
+ *
+ * @retval      Page address, 0 if the address is not trapped
+ */
+static uint32_t SIM_TrapPage(uintptr_t addr)
+{
+    uint8_t i;
+
+    for (i = 0; i < sizeof(simTrapPage) / sizeof(simTrapPage[0]); i++)
+    {
+        if (addr - simTrapPage[i] < SIM_PAGE)
+        {
+            return simTrapPage[i];
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief       Side effects of a CRC register access, from the core or a DMA channel
+ *
+ * @param       offset: register offset
+ *
+ * @param       old: register value before the access
+ *
+ * @param       value: register value after the access
+ *
+ * @param       write: 1 for a write
+ *
+ * @retval      None
+ */
+static void SIM_CrcAccess(uint32_t offset, uint32_t old, uint32_t value, uint8_t write)
+{
+    uint32_t crc;
+    uint8_t i;
+
+    if (!write)
+    {
+        return;
+    }
+
+    if (offset == SIM_CRC_DATA)
+    {
+        /* The written word goes through the register most significant bit first */
+        crc = old ^ value;
+        for (i = 0; i < 32; i++)
+        {
+            crc = (crc & 0x80000000) ? ((crc << 1) ^ SIM_CRC_POLY) : (crc << 1);
+        }
+        SIM_REG(CRC_BASE + SIM_CRC_DATA) = crc;
+    }
+    else if (offset == SIM_CRC_INDATA)
+    {
+        SIM_REG(CRC_BASE + SIM_CRC_INDATA) = value & 0xFF;
+    }
+    else if (offset == SIM_CRC_CTRL)
+    {
+        /* RST reloads the register and reads back as 0 */
+        if (value & 1)
+        {
+            SIM_REG(CRC_BASE + SIM_CRC_DATA) = SIM_CRC_RESET;
+        }
+        SIM_REG(CRC_BASE + SIM_CRC_CTRL) = 0;
+    }
+}
+
+/*!
+ * @brief       Register block address of a DMA channel
+ *
+ * @param       ch: channel index
+ *
+ * @retval      Address of CHCFG
+ */
+static uint32_t SIM_ChannelBase(uint8_t ch)
+{
+    if (ch < 7)
+    {
+        return DMA1_Channel1_BASE + SIM_DMA_STRIDE * ch;
+    }
+
+    return DMA2_Channel1_BASE + SIM_DMA_STRIDE * (ch - 7);
+}
+
+/*!
+ * @brief       INTSTS register of the controller of a DMA channel
+ *
+ * @param       ch: channel index
+ *
+ * @retval      Model view of INTSTS
+ */
+static volatile uint32_t* SIM_ChannelSts(uint8_t ch)
+{
+    return &SIM_REG((ch < 7) ? DMA1_BASE : DMA2_BASE);
+}
+
+/*!
+ * @brief       Flag position of a DMA channel in INTSTS
+ *
+ * @param       ch: channel index
+ *
+ * @retval      Bit position of the GINT flag
+ */
+static uint8_t SIM_ChannelShift(uint8_t ch)
+{
+    return 4 * ((ch < 7) ? ch : (ch - 7));
+}
+
+/*!
+ * @brief       Device IRQ of a DMA channel
+ *
+ * @param       ch: channel index
+ *
+ * @retval      IRQ number
+ */
+static IRQn_Type SIM_ChannelIrq(uint8_t ch)
+{
+    if (ch < 7)
+    {
+        return (IRQn_Type)(DMA1_Channel1_IRQn + ch);
+    }
+
+#if defined (APM32F10X_CL)
+    return (IRQn_Type)(DMA2_Channel1_IRQn + ch - 7);
+#else
+    return (ch < 10) ? (IRQn_Type)(DMA2_Channel1_IRQn + ch - 7) : DMA2_Channel4_5_IRQn;
+#endif
+}
+
+/*!
+ * @brief       Channel has a transfer left
+ *
+ * @param       ch: channel index
+ *
+ * @retval      1 if enabled with a non zero count
+ */
+static uint8_t SIM_ChannelReady(uint8_t ch)
+{
+    uint32_t base = SIM_ChannelBase(ch);
+
+    return (SIM_REG(base + SIM_DMA_CHCFG) & SIM_CHCFG_EN) && (SIM_REG(base + SIM_DMA_CHNDATA) & 0xFFFF);
+}
+
+/*!
+ * @brief       Address of the next transfer on one side of a channel
+ *
+ * @param       ch: channel index
+ *
+ * @param       mem: 1 for the memory side, 0 for the peripheral side
+ *
+ * @retval      Device address
+ */
+static uint32_t SIM_ChannelAddr(uint8_t ch, uint8_t mem)
+{
+    uint32_t base = SIM_ChannelBase(ch);
+    uint32_t cfg = SIM_REG(base + SIM_DMA_CHCFG);
+    uint32_t size = 1 << ((cfg >> (mem ? SIM_CHCFG_MSIZE_POS : SIM_CHCFG_PSIZE_POS)) & 3);
+    uint32_t addr = SIM_REG(base + (mem ? SIM_DMA_CHMADDR : SIM_DMA_CHPADDR));
+
+    if (cfg & (mem ? SIM_CHCFG_MINC : SIM_CHCFG_PINC))
+    {
+        addr += simChannel[ch].index * size;
+    }
+
+    return addr;
+}
+
+/*!
+ * @brief       Read one data unit through a channel side
+ *
+ * @param       ch: channel index
+ *
+ * @param       mem: 1 for the memory side, 0 for the peripheral side
+ *
+ * @retval      Data
+ */
+static uint32_t SIM_ChannelRead(uint8_t ch, uint8_t mem)
+{
+    uint32_t cfg = SIM_REG(SIM_ChannelBase(ch) + SIM_DMA_CHCFG);
+    uint8_t* p = SIM_Alias(SIM_ChannelAddr(ch, mem));
+
+    switch ((cfg >> (mem ? SIM_CHCFG_MSIZE_POS : SIM_CHCFG_PSIZE_POS)) & 3)
+    {
+        case 0:
+            return *p;
+        case 1:
+            return *(uint16_t*)p;
+        default:
+            return *(uint32_t*)p;
+    }
+}
+
+/*!
+ * @brief       Write one data unit through a channel side
+ *
+ * @param       ch: channel index
+ *
+ * @param       mem: 1 for the memory side, 0 for the peripheral side
+ *
+ * @param       data: data
+ *
+ * @retval      None
+ */
+static void SIM_ChannelWrite(uint8_t ch, uint8_t mem, uint32_t data)
+{
+    uint32_t cfg = SIM_REG(SIM_ChannelBase(ch) + SIM_DMA_CHCFG);
+    uint32_t addr = SIM_ChannelAddr(ch, mem);
+    uint8_t* p = SIM_Alias(addr);
+    uint32_t old = *(uint32_t*)SIM_Alias(addr & ~3);
+
+    switch ((cfg >> (mem ? SIM_CHCFG_MSIZE_POS : SIM_CHCFG_PSIZE_POS)) & 3)
+    {
+        case 0:
+            *p = (uint8_t)data;
+            break;
+        case 1:
+            *(uint16_t*)p = (uint16_t)data;
+            break;
+        default:
+            *(uint32_t*)p = data;
+            break;
+    }
+
+    /* The CRC unit takes memory to memory writes like core writes */
+    if ((addr & ~3) - CRC_BASE < SIM_CRC_SIZE)
+    {
+        SIM_CrcAccess((addr & ~3) - CRC_BASE, old, SIM_REG(addr & ~3), 1);
+    }
+}
+
+/*!
+ * @brief       Stop a channel whose next transfer touches reserved memory
+ *
+ * @param       ch: channel index
+ *
+ * @retval      1 if the channel was stopped with a TERR event
+ *
+ * @note        As on the device the channel is disabled and CHNDATA keeps
+ *              the items left; nothing is read or written.
+ */
+static uint8_t SIM_ChannelBusError(uint8_t ch)
+{
+    uint32_t base = SIM_ChannelBase(ch);
+    uint8_t mem;
+
+    for (mem = 0; mem < 2; mem++)
+    {
+        if (SIM_ChannelAddr(ch, mem) - SIM_RESERVED_BASE < SIM_RESERVED_END - SIM_RESERVED_BASE)
+        {
+            SIM_REG(base + SIM_DMA_CHCFG) &= ~SIM_CHCFG_EN;
+            *SIM_ChannelSts(ch) |= (uint32_t)(SIM_DMA_GINT | SIM_DMA_TERR) << SIM_ChannelShift(ch);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief       Count one transfer of a channel and raise its HT/TC events
+ *
+ * @param       ch: channel index
+ *
+ * @retval      None
+ */
+static void SIM_ChannelAdvance(uint8_t ch)
+{
+    uint32_t base = SIM_ChannelBase(ch);
+    volatile uint32_t* count = &SIM_REG(base + SIM_DMA_CHNDATA);
+    uint32_t left = (*count & 0xFFFF) - 1;
+    uint32_t flags = 0;
+
+    simChannel[ch].index++;
+    *count = left;
+
+    if (left == simChannel[ch].reload / 2)
+    {
+        flags |= SIM_DMA_GINT | SIM_DMA_HT;
+    }
+
+    if (left == 0)
+    {
+        flags |= SIM_DMA_GINT | SIM_DMA_TC;
+        if (SIM_REG(base + SIM_DMA_CHCFG) & SIM_CHCFG_CIR)
+        {
+            *count = simChannel[ch].reload;
+            simChannel[ch].index = 0;
+        }
+    }
+
+    *SIM_ChannelSts(ch) |= flags << SIM_ChannelShift(ch);
+}
+
+/*!
+ * @brief       Run memory to memory channels to completion
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void SIM_ChannelM2M(void)
+{
+    uint8_t ch;
+    uint8_t fromMem;
+
+    for (ch = 0; ch < SIM_DMA_CHANNEL_NUM; ch++)
+    {
+        if (!(SIM_REG(SIM_ChannelBase(ch) + SIM_DMA_CHCFG) & SIM_CHCFG_M2M))
+        {
+            continue;
+        }
+
+        fromMem = (SIM_REG(SIM_ChannelBase(ch) + SIM_DMA_CHCFG) & SIM_CHCFG_DIR) != 0;
+        while (SIM_ChannelReady(ch) && !SIM_ChannelBusError(ch))
+        {
+            SIM_ChannelWrite(ch, !fromMem, SIM_ChannelRead(ch, fromMem));
+            SIM_ChannelAdvance(ch);
+        }
+    }
+}
+
+/*!
+ * @brief       Core cycles of one bit on a line
+ *
+ * @param       i: line index
+ *
+ * @retval      Cycles
+ */
+static uint32_t SIM_BitCycles(uint8_t i)
+{
+    uint32_t pclk1, pclk2;
+    uint32_t br = SIM_REG(simLineHw[i].usart + SIM_USART_BR) & 0xFFFF;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+
+    /* BR is the USART divider times 16, i.e. PCLK cycles per bit */
+    if (br < 16)
+    {
+        br = 16;
+    }
+
+    return (uint32_t)((uint64_t)br * RCM_ReadHCLKFreq() / ((simLineHw[i].apb == 2) ? pclk2 : pclk1));
+}
+
+/*!
+ * @brief       Core cycles of one bit sent to a line
+ *
+ * @param       i: line index
+ *
+ * @retval      Cycles of the sender, the line's own bit time unless SIM_LineRate() set one
+ */
+static uint32_t SIM_SenderBitCycles(uint8_t i)
+{
+    return (simLine[i].bitCycles != 0) ? simLine[i].bitCycles : SIM_BitCycles(i);
+}
+
+/*!
+ * @brief       Core cycles of one character in the frame format of a line
+ *
+ * @param       i: line index
+ *
+ * @param       bitCycles: bit time
+ *
+ * @retval      Cycles, start and stop bits included
+ */
+static uint32_t SIM_FrameCycles(uint8_t i, uint32_t bitCycles)
+{
+    static const uint8_t stopHalfBits[4] = {2, 1, 4, 3};
+    uint32_t usart = simLineHw[i].usart;
+    uint32_t halfBits;
+
+    halfBits = 2 * ((SIM_REG(usart + SIM_USART_CTRL1) & SIM_CTRL1_WLEN) ? 10 : 9) +
+               stopHalfBits[(SIM_REG(usart + SIM_USART_CTRL2) >> SIM_CTRL2_STOP_POS) & 3];
+
+    return halfBits * bitCycles / 2;
+}
+
+/*!
+ * @brief       Core cycles of one character on a line, start and stop bits included
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @retval      Cycles
+ */
+uint32_t SIM_LineCharCycles(uint8_t line)
+{
+    return SIM_FrameCycles(line, SIM_BitCycles(line));
+}
+
+/*!
+ * @brief       Core cycles of a break on a line, its stop bit included
+ *
+ * @param       i: line index
+ *
+ * @retval      Cycles
+ *
+ * @note        13 low bits in LIN mode, else a character of zeros with a
+ *              low stop bit.
+ */
+static uint32_t SIM_BreakCycles(uint8_t i)
+{
+    uint32_t usart = simLineHw[i].usart;
+    uint32_t bits;
+
+    if (SIM_REG(usart + SIM_USART_CTRL2) & SIM_CTRL2_LINMEN)
+    {
+        bits = 13;
+    }
+    else
+    {
+        bits = (SIM_REG(usart + SIM_USART_CTRL1) & SIM_CTRL1_WLEN) ? 11 : 10;
+    }
+
+    return (bits + 1) * SIM_BitCycles(i);
+}
+
+/*!
+ * @brief       Level of a pin as the device reads it
+ *
+ * @param       port: GPIO register block
+ *
+ * @param       pin: GPIO_PIN_x
+ *
+ * @retval      1 when high
+ */
+static uint8_t SIM_PinLevel(uint32_t port, uint16_t pin)
+{
+    return (SIM_REG(port + SIM_GPIO_IDATA) & pin) != 0;
+}
+
+/*!
+ * @brief       EINT IRQ of a GPIO line
+ *
+ * @param       n: EINT line 0 to 15
+ *
+ * @retval      IRQ number
+ */
+static IRQn_Type SIM_EintIrq(uint8_t n)
+{
+    if (n < 5)
+    {
+        return (IRQn_Type)(EINT0_IRQn + n);
+    }
+
+    return (n < 10) ? EINT9_5_IRQn : EINT15_10_IRQn;
+}
+
+/*!
+ * @brief       Count the turnaround of a line whose driver enable just went low
+ *
+ * @param       i: line index
+ *
+ * @retval      None
+ */
+static void SIM_DriverTurn(uint8_t i)
+{
+    uint64_t turn = simStats.time + simStats.coreCycles - simLine[i].deIdleAt;
+
+    simStats.deTurns[i]++;
+    if (turn > simStats.deTurnMax[i])
+    {
+        simStats.deTurnMax[i] = (uint32_t)turn;
+    }
+    simLine[i].deIdleAt = 0;
+}
+
+/*!
+ * @brief       Recompute the pin levels of a GPIO port, latching EINT edges
+ *              and CTS toggles
+ *
+ * @param       p: port index, 0 for GPIOA
+ *
+ * @retval      None
+ */
+static void SIM_GpioUpdate(uint8_t p)
+{
+    uint32_t port = GPIOA_BASE + SIM_GPIO_STRIDE * p;
+    SIM_Line_T* line;
+    uint64_t cfg = ((uint64_t)SIM_REG(port + SIM_GPIO_CFGHIG) << 32) | SIM_REG(port + SIM_GPIO_CFGLOW);
+    uint32_t usart;
+    uint32_t sel;
+    uint16_t out = 0;
+    uint16_t level;
+    uint16_t changed;
+    uint16_t bit;
+    uint8_t n;
+
+    /* A pin with MODE bits set is an output and reads back its ODATA bit */
+    for (n = 0; n < 16; n++)
+    {
+        if ((cfg >> (4 * n)) & 3)
+        {
+            out |= 1 << n;
+        }
+    }
+
+    level = (SIM_REG(port + SIM_GPIO_ODATA) & out) | (simPinIn[p] & ~out);
+    changed = level ^ SIM_REG(port + SIM_GPIO_IDATA);
+    SIM_REG(port + SIM_GPIO_IDATA) = level;
+
+    for (n = 0; n < SIM_EINT_GPIO_LINES; n++)
+    {
+        bit = 1 << n;
+        sel = SIM_REG(AFIO_BASE + SIM_AFIO_EINTSEL + 4 * (n / 4)) >> (4 * (n % 4));
+
+        if ((changed & bit) && ((sel & 0x0F) == p) &&
+            (SIM_REG(EINT_BASE + ((level & bit) ? SIM_EINT_RTEN : SIM_EINT_FTEN)) & bit))
+        {
+            SIM_REG(EINT_BASE + SIM_EINT_IPEND) |= bit;
+        }
+    }
+
+    for (n = 0; n < SIM_LINE_NUM; n++)
+    {
+        usart = simLineHw[n].usart;
+        if ((simLineHw[n].ctsPort == port) && (changed & simLineHw[n].ctsPin) &&
+            (SIM_REG(usart + SIM_USART_CTRL3) & SIM_CTRL3_CTSEN))
+        {
+            SIM_REG(usart + SIM_USART_STS) |= SIM_STS_CTS;
+        }
+
+        /* RTS going high in an idle gap keeps the next character back */
+        line = &simLine[n];
+        if ((line->rtsPort == port) && (changed & level & line->rtsPin) &&
+            line->rxBusy && (line->rxStart > simStats.time))
+        {
+            line->rxBusy = 0;
+            line->idleAt = line->idleCancel;
+        }
+
+        /* Bus turned around after the last character */
+        if ((line->dePort == port) && (changed & ~level & line->dePin) && line->deIdleAt)
+        {
+            SIM_DriverTurn(n);
+        }
+    }
+}
+
+/*!
+ * @brief       Timer wired to the RX pin of a line
+ *
+ * @param       i: line index
+ *
+ * @retval      Timer index, -1 if none
+ */
+static int SIM_LineTmr(uint8_t i)
+{
+    int t;
+
+    for (t = 0; t < SIM_TMR_NUM; t++)
+    {
+        if (simTmrHw[t].line == i)
+        {
+            return t;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * @brief       Counter ticks of a timer in a span of simulated time
+ *
+ * @param       t: timer index
+ *
+ * @param       cycles: core cycles
+ *
+ * @retval      Ticks after the prescaler
+ */
+static uint64_t SIM_TmrTicks(uint8_t t, uint64_t cycles)
+{
+    uint32_t pclk1, pclk2;
+    uint32_t pclk;
+    uint32_t clock;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+    pclk = (simTmrHw[t].apb == 2) ? pclk2 : pclk1;
+
+    /* Timers run at twice PCLK behind a divided APB */
+    clock = (pclk == RCM_ReadHCLKFreq()) ? pclk : 2 * pclk;
+
+    return cycles * clock / ((uint64_t)RCM_ReadHCLKFreq() * ((SIM_REG(simTmrHw[t].base + SIM_TMR_PSC) & 0xFFFF) + 1));
+}
+
+/*!
+ * @brief       Counter value of a timer
+ *
+ * @param       t: timer index
+ *
+ * @retval      CNT at the simulated time, charged core cycles left out
+ */
+static uint32_t SIM_TmrCount(uint8_t t)
+{
+    uint32_t base = simTmrHw[t].base;
+
+    if (!(SIM_REG(base + SIM_TMR_CTRL1) & SIM_TMR_CEN))
+    {
+        return SIM_REG(base + SIM_TMR_CNT) & 0xFFFF;
+    }
+
+    return (uint32_t)((simTmr[t].base + SIM_TmrTicks(t, simStats.time - simTmr[t].origin)) %
+                      ((SIM_REG(base + SIM_TMR_AUTORLD) & 0xFFFF) + 1));
+}
+
+/*!
+ * @brief       Time of the next compare match of the modelled channel
+ *
+ * @param       t: timer index
+ *
+ * @retval      None
+ */
+static void SIM_TmrSchedule(uint8_t t)
+{
+    const SIM_TmrHw_T* hw = &simTmrHw[t];
+    uint32_t period = (SIM_REG(hw->base + SIM_TMR_AUTORLD) & 0xFFFF) + 1;
+    uint32_t delta;
+    uint64_t ticks;
+    uint64_t lo;
+    uint64_t hi;
+
+    simTmr[t].compareAt = 0;
+    if (!(SIM_REG(hw->base + SIM_TMR_CTRL1) & SIM_TMR_CEN) || (SIM_TMR_SEL(hw->base, hw->channel) != 0))
+    {
+        return;
+    }
+
+    delta = ((SIM_REG(hw->base + SIM_TMR_CC1 + 4 * hw->channel) & 0xFFFF) + period - SIM_TmrCount(t)) % period;
+    ticks = SIM_TmrTicks(t, simStats.time - simTmr[t].origin) + ((delta != 0) ? delta : period);
+
+    /* First cycle that counts that many ticks */
+    lo = simStats.time - simTmr[t].origin;
+    hi = lo + 1;
+    while (SIM_TmrTicks(t, hi) < ticks)
+    {
+        hi = lo + 2 * (hi - lo);
+    }
+    while (hi - lo > 1)
+    {
+        if (SIM_TmrTicks(t, lo + (hi - lo) / 2) < ticks)
+        {
+            lo += (hi - lo) / 2;
+        }
+        else
+        {
+            hi = lo + (hi - lo) / 2;
+        }
+    }
+
+    simTmr[t].compareAt = simTmr[t].origin + hi;
+}
+
+/*!
+ * @brief       Edge on the RX pin of a line: input capture of its timer channel
+ *
+ * @param       t: timer index
+ *
+ * @param       level: pin level after the edge
+ *
+ * @retval      None
+ */
+static void SIM_TmrEdge(uint8_t t, uint8_t level)
+{
+    const SIM_TmrHw_T* hw = &simTmrHw[t];
+    volatile uint32_t* sts = &SIM_REG(hw->base + SIM_TMR_STS);
+    uint32_t ccen = SIM_REG(hw->base + SIM_TMR_CCEN) >> (4 * hw->channel);
+
+    /* POL selects the falling edge, POL with NPOL both edges */
+    if (level ? ((ccen & SIM_TMR_CCEN_POL) && !(ccen & SIM_TMR_CCEN_NPOL)) : !(ccen & SIM_TMR_CCEN_POL))
+    {
+        return;
+    }
+
+    if (*sts & (SIM_TMR_STS_CC1 << hw->channel))
+    {
+        *sts |= SIM_TMR_STS_CC1RC << hw->channel;
+    }
+    *sts |= SIM_TMR_STS_CC1 << hw->channel;
+    SIM_REG(hw->base + SIM_TMR_CC1 + 4 * hw->channel) = SIM_TmrCount(t);
+    simStats.captures[hw->line]++;
+}
+
+/*!
+ * @brief       Timer channel on the RX pin of a line takes edges
+ *
+ * @param       i: line index
+ *
+ * @retval      Timer index, -1 if the line has none or it is not capturing
+ */
+static int SIM_LineCapture(uint8_t i)
+{
+    int t = SIM_LineTmr(i);
+
+    if ((t < 0) || !(SIM_REG(simTmrHw[t].base + SIM_TMR_CTRL1) & SIM_TMR_CEN) ||
+        (SIM_TMR_SEL(simTmrHw[t].base, simTmrHw[t].channel) != 1) ||
+        !(SIM_REG(simTmrHw[t].base + SIM_TMR_CCEN) & (1U << (4 * simTmrHw[t].channel))))
+    {
+        return -1;
+    }
+
+    return t;
+}
+
+/*!
+ * @brief       Edges of a character on the wire of a line with a timer on its RX pin
+ *
+ * @param       i: line index
+ *
+ * @param       data: character and SIM_CHAR_xxx flags
+ *
+ * @param       bitCycles: bit time of the sender
+ *
+ * @retval      None
+ */
+static void SIM_LineEdges(uint8_t i, uint16_t data, uint32_t bitCycles)
+{
+    SIM_Line_T* line = &simLine[i];
+    uint8_t bits = (SIM_REG(simLineHw[i].usart + SIM_USART_CTRL1) & SIM_CTRL1_WLEN) ? 9 : 8;
+    uint8_t prev = 1;
+    uint8_t level;
+    uint8_t k;
+
+    line->edgeNum = 0;
+    line->edgeNext = 0;
+
+    if (SIM_LineTmr(i) < 0)
+    {
+        return;
+    }
+
+    if (data & SIM_CHAR_BREAK)
+    {
+        line->edge[0] = line->rxStart;
+        line->edgeLevel[0] = 0;
+        line->edge[1] = line->rxEnd - bitCycles;
+        line->edgeLevel[1] = 1;
+        line->edgeNum = 2;
+        return;
+    }
+
+    /* Start bit, data bits LSB first, stop bit */
+    for (k = 0; k <= bits + 1; k++)
+    {
+        level = (k == 0) ? 0 : ((k <= bits) ? ((data >> (k - 1)) & 1) : 1);
+        if (level != prev)
+        {
+            line->edge[line->edgeNum] = line->rxStart + (uint64_t)k * bitCycles;
+            line->edgeLevel[line->edgeNum] = level;
+            line->edgeNum++;
+        }
+        prev = level;
+    }
+}
+
+/*!
+ * @brief       Put the next queued character of a line on the wire
+ *
+ * @param       i: line index
+ *
+ * @retval      None
+ */
+static void SIM_RxNext(uint8_t i)
+{
+    SIM_Line_T* line = &simLine[i];
+    SIM_RxChar_T* c;
+    uint64_t start;
+
+    if (line->rxBusy || (line->rxHead == line->rxTail))
+    {
+        return;
+    }
+
+    /* The sender finishes the character it is on, then waits for RTS */
+    if ((line->rtsPort != 0) && SIM_PinLevel(line->rtsPort, line->rtsPin))
+    {
+        return;
+    }
+
+    c = &line->rxQueue[line->rxTail];
+    start = (line->rxFree > simStats.time) ? line->rxFree : simStats.time;
+    start += (uint64_t)c->idleBits * SIM_SenderBitCycles(i);
+
+    /* A start bit before a full idle character cancels IDLE detection */
+    line->idleCancel = 0;
+    if (line->idleAt > start)
+    {
+        line->idleCancel = line->idleAt;
+        line->idleAt = 0;
+    }
+
+    line->rxBusy = 1;
+    line->rxMissed = 0;
+    line->rxStart = start;
+    line->rxEnd = start + ((c->data & SIM_CHAR_BREAK) ? SIM_BreakCycles(i) :
+                           SIM_FrameCycles(i, SIM_SenderBitCycles(i)));
+    SIM_LineEdges(i, c->data, SIM_SenderBitCycles(i));
+}
+
+/*!
+ * @brief       DMA requests and transmit shift register of a line
+ *
+ * @param       i: line index
+ *
+ * @retval      None
+ */
+static void SIM_LineService(uint8_t i)
+{
+    SIM_Line_T* line = &simLine[i];
+    const SIM_LineHw_T* hw = &simLineHw[i];
+    volatile uint32_t* sts = &SIM_REG(hw->usart + SIM_USART_STS);
+    uint32_t ctrl1 = SIM_REG(hw->usart + SIM_USART_CTRL1);
+    uint32_t ctrl3 = SIM_REG(hw->usart + SIM_USART_CTRL3);
+    uint8_t progress = 1;
+
+    while (progress)
+    {
+        progress = 0;
+
+        if ((ctrl3 & SIM_CTRL3_DMARXEN) && (*sts & SIM_STS_RXBNE) &&
+            (hw->rxDma >= 0) && SIM_ChannelReady(hw->rxDma) && !SIM_ChannelBusError(hw->rxDma))
+        {
+            SIM_ChannelWrite(hw->rxDma, 1, line->rdr);
+            SIM_ChannelAdvance(hw->rxDma);
+            *sts &= ~SIM_STS_RXBNE;
+            progress = 1;
+        }
+
+        if ((ctrl3 & SIM_CTRL3_DMATXEN) && (*sts & SIM_STS_TXBE) &&
+            (hw->txDma >= 0) && SIM_ChannelReady(hw->txDma) && !SIM_ChannelBusError(hw->txDma))
+        {
+            line->tdr = SIM_ChannelRead(hw->txDma, 1) & SIM_CHAR_DATA;
+            line->tdrFull = 1;
+            SIM_ChannelAdvance(hw->txDma);
+            *sts &= ~SIM_STS_TXBE;
+            progress = 1;
+        }
+
+        /* A requested break goes before the data register, TXBF clears at its stop bit */
+        if (((ctrl1 & (SIM_CTRL1_UEN | SIM_CTRL1_TXEN | SIM_CTRL1_TXBF)) ==
+             (SIM_CTRL1_UEN | SIM_CTRL1_TXEN | SIM_CTRL1_TXBF)) && !line->txBusy)
+        {
+            line->shift = SIM_CHAR_BREAK;
+            line->txBusy = 1;
+            line->txEnd = simStats.time + SIM_BreakCycles(i);
+        }
+        /* With CTSEN, the next character only leaves while CTS is low */
+        else if (((ctrl1 & (SIM_CTRL1_UEN | SIM_CTRL1_TXEN)) == (SIM_CTRL1_UEN | SIM_CTRL1_TXEN)) &&
+                 !line->txBusy && line->tdrFull &&
+                 (!(ctrl3 & SIM_CTRL3_CTSEN) || !SIM_PinLevel(hw->ctsPort, hw->ctsPin)))
+        {
+            line->shift = line->tdr;
+            line->tdrFull = 0;
+            line->txBusy = 1;
+            line->txEnd = simStats.time + SIM_LineCharCycles(i);
+            *sts |= SIM_STS_TXBE;
+        }
+        else
+        {
+            continue;
+        }
+
+        /* An RS-485 transceiver only drives the bus while DE is high */
+        line->deIdleAt = 0;
+        line->deLost = (line->dePort != 0) && !SIM_PinLevel(line->dePort, line->dePin);
+
+        /* Started together, the looped back character ends with this one */
+        if (simLink[i] != 0)
+        {
+            SIM_LineFeed(simLink[i] - 1, line->shift, 0);
+        }
+        progress = 1;
+    }
+}
+
+/*!
+ * @brief       Update DWT CYCCNT from the simulated time and the charged core cycles
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void SIM_SyncCycleCounter(void)
+{
+    if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+    {
+        DWT->CYCCNT = (uint32_t)(simStats.time + simStats.coreCycles);
+    }
+}
+
+/*!
+ * @brief       Let the model react to register changes, no time passes
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void SIM_Update(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        SIM_LineService(i);
+    }
+
+    SIM_ChannelM2M();
+    SIM_SyncCycleCounter();
+}
+
+/*!
+ * @brief       Side effects of a USART register access
+ *
+ * @param       i: line index
+ *
+ * @param       offset: register offset
+ *
+ * @param       old: register value before the access
+ *
+ * @param       value: register value after the access
+ *
+ * @param       write: 1 for a write
+ *
+ * @retval      None
+ */
+static void SIM_UsartAccess(uint8_t i, uint32_t offset, uint32_t old, uint32_t value, uint8_t write)
+{
+    SIM_Line_T* line = &simLine[i];
+    volatile uint32_t* sts = &SIM_REG(simLineHw[i].usart + SIM_USART_STS);
+    volatile uint32_t* reg = &SIM_REG(simLineHw[i].usart + offset);
+
+    /* A receiver turned on after a start bit waits for the next one */
+    if ((offset == SIM_USART_CTRL1) &&
+        ((old & (SIM_CTRL1_UEN | SIM_CTRL1_RXEN)) != (SIM_CTRL1_UEN | SIM_CTRL1_RXEN)) &&
+        ((value & (SIM_CTRL1_UEN | SIM_CTRL1_RXEN)) == (SIM_CTRL1_UEN | SIM_CTRL1_RXEN)) &&
+        line->rxBusy && (line->rxStart <= simStats.time))
+    {
+        line->rxMissed = 1;
+    }
+
+    if (offset == SIM_USART_STS)
+    {
+        if (write)
+        {
+            /* RXBNE, TC, LBD and CTS clear on 0, the other flags are read only */
+            *reg = old & (value | ~SIM_STS_RC_W0);
+        }
+        else
+        {
+            line->stsRead = 1;
+            line->stsSnapshot = old;
+        }
+    }
+    else if (offset == SIM_USART_DATA)
+    {
+        if (write)
+        {
+            line->tdr = value & SIM_CHAR_DATA;
+            line->tdrFull = 1;
+            *sts &= ~(SIM_STS_TXBE | (line->stsRead ? SIM_STS_TC : 0));
+            *reg = line->rdr;
+        }
+        else
+        {
+            *sts &= ~(SIM_STS_RXBNE | (line->stsRead ?
+                      (line->stsSnapshot & (SIM_STS_PE | SIM_STS_FE | SIM_STS_NE | SIM_STS_ORE | SIM_STS_IDLE)) : 0));
+        }
+        line->stsRead = 0;
+    }
+}
+
+/*!
+ * @brief       Side effects of a GPIO register access
+ *
+ * @param       p: port index, 0 for GPIOA
+ *
+ * @param       offset: register offset
+ *
+ * @param       old: register value before the access
+ *
+ * @param       value: register value after the access
+ *
+ * @param       write: 1 for a write
+ *
+ * @retval      None
+ */
+static void SIM_GpioAccess(uint8_t p, uint32_t offset, uint32_t old, uint32_t value, uint8_t write)
+{
+    uint32_t port = GPIOA_BASE + SIM_GPIO_STRIDE * p;
+    volatile uint32_t* odata = &SIM_REG(port + SIM_GPIO_ODATA);
+
+    if (!write)
+    {
+        return;
+    }
+
+    if (offset == SIM_GPIO_IDATA)
+    {
+        SIM_REG(port + offset) = old;
+        return;
+    }
+
+    /* BSC and BC are write only, a set bit of BSC wins over its reset bit */
+    if (offset == SIM_GPIO_BSC)
+    {
+        *odata = (*odata & ~(value >> 16)) | (value & 0xFFFF);
+        SIM_REG(port + offset) = 0;
+    }
+    else if (offset == SIM_GPIO_BC)
+    {
+        *odata &= ~(value & 0xFFFF);
+        SIM_REG(port + offset) = 0;
+    }
+
+    SIM_GpioUpdate(p);
+}
+
+/*!
+ * @brief       Bring the CNT register of a timer up to date ahead of an access
+ *
+ * @param       addr: register address being accessed
+ *
+ * @retval      None
+ */
+static void SIM_TmrRefresh(uint32_t addr)
+{
+    uint8_t t;
+
+    for (t = 0; t < SIM_TMR_NUM; t++)
+    {
+        if (addr - simTmrHw[t].base < SIM_TMR_SIZE)
+        {
+            SIM_REG(simTmrHw[t].base + SIM_TMR_CNT) = SIM_TmrCount(t);
+        }
+    }
+}
+
+/*!
+ * @brief       Side effects of a timer register access
+ *
+ * @param       t: timer index
+ *
+ * @param       offset: register offset
+ *
+ * @param       old: register value before the access
+ *
+ * @param       value: register value after the access
+ *
+ * @param       write: 1 for a write
+ *
+ * @retval      None
+ *
+ * @note        CNT was brought up to date before the access, so after a
+ *              write the counter goes on from the register contents.
+ */
+static void SIM_TmrAccess(uint8_t t, uint32_t offset, uint32_t old, uint32_t value, uint8_t write)
+{
+    const SIM_TmrHw_T* hw = &simTmrHw[t];
+    volatile uint32_t* reg = &SIM_REG(hw->base + offset);
+
+    if (!write)
+    {
+        /* Reading a capture clears its flag */
+        if ((offset == (uint32_t)(SIM_TMR_CC1 + 4 * hw->channel)) && (SIM_TMR_SEL(hw->base, hw->channel) == 1))
+        {
+            SIM_REG(hw->base + SIM_TMR_STS) &= ~(SIM_TMR_STS_CC1 << hw->channel);
+        }
+        return;
+    }
+
+    if (offset == SIM_TMR_STS)
+    {
+        /* Every flag clears on 0 */
+        *reg = old & value;
+    }
+    else if (offset == SIM_TMR_CEG)
+    {
+        /* An update event restarts the count */
+        if (value & SIM_TMR_UEG)
+        {
+            SIM_REG(hw->base + SIM_TMR_CNT) = 0;
+        }
+        *reg = 0;
+    }
+
+    simTmr[t].origin = simStats.time;
+    simTmr[t].base = SIM_REG(hw->base + SIM_TMR_CNT) & 0xFFFF;
+    SIM_TmrSchedule(t);
+}
+
+/*!
+ * @brief       Side effects of a DMA register access
+ *
+ * @param       offset: register offset from DMA1_BASE
+ *
+ * @param       old: register value before the access
+ *
+ * @param       value: register value after the access
+ *
+ * @param       write: 1 for a write
+ *
+ * @retval      None
+ */
+static void SIM_DmaAccess(uint32_t offset, uint32_t old, uint32_t value, uint8_t write)
+{
+    uint32_t dma = (offset >= DMA2_BASE - DMA1_BASE) ? DMA2_BASE : DMA1_BASE;
+    volatile uint32_t* reg = &SIM_REG(DMA1_BASE + offset);
+    uint32_t clear = 0;
+    uint8_t ch;
+    uint8_t c;
+
+    offset -= dma - DMA1_BASE;
+
+    if (!write)
+    {
+        return;
+    }
+
+    if (offset == SIM_DMA_INTSTS)
+    {
+        *reg = old;
+        return;
+    }
+
+    if (offset == SIM_DMA_INTFCLR)
+    {
+        /* GINT clears all flags of its channel */
+        for (c = 0; c < 7; c++)
+        {
+            if (value & (SIM_DMA_GINT << (4 * c)))
+            {
+                clear |= 0x0F << (4 * c);
+            }
+        }
+        SIM_REG(dma + SIM_DMA_INTSTS) &= ~(clear | value);
+        *reg = 0;
+        return;
+    }
+
+    if (offset < SIM_DMA_CHANNEL)
+    {
+        return;
+    }
+
+    ch = (offset - SIM_DMA_CHANNEL) / SIM_DMA_STRIDE + ((dma == DMA2_BASE) ? 7 : 0);
+    offset = (offset - SIM_DMA_CHANNEL) % SIM_DMA_STRIDE;
+
+    if (ch >= SIM_DMA_CHANNEL_NUM)
+    {
+        return;
+    }
+
+    if (offset == SIM_DMA_CHCFG)
+    {
+        if (!(old & SIM_CHCFG_EN) && (value & SIM_CHCFG_EN))
+        {
+            simChannel[ch].reload = SIM_REG(SIM_ChannelBase(ch) + SIM_DMA_CHNDATA) & 0xFFFF;
+            simChannel[ch].index = 0;
+        }
+    }
+    else if (SIM_REG(SIM_ChannelBase(ch) + SIM_DMA_CHCFG) & SIM_CHCFG_EN)
+    {
+        /* Count and addresses are read only while the channel runs */
+        *reg = old;
+    }
+}
+
+/*!
+ * @brief       Side effects of an NVIC register access
+ *
+ * @param       offset: register offset from SCS_BASE
+ *
+ * @param       old: register value before the access
+ *
+ * @param       value: register value after the access
+ *
+ * @param       write: 1 for a write
+ *
+ * @retval      None
+ */
+static void SIM_NvicAccess(uint32_t offset, uint32_t old, uint32_t value, uint8_t write)
+{
+    uint32_t group = offset & ~0x7F;
+    uint32_t word = offset & 0x1C;
+    uint32_t base;
+    uint32_t state;
+
+    /* ICSR reads back PENDSVSET while PendSV is pending, the other bits are not modelled */
+    if (offset == SIM_SCB_ICSR)
+    {
+        state = old & SIM_ICSR_PENDSVSET;
+        if (write && (value & SIM_ICSR_PENDSVSET))
+        {
+            state = SIM_ICSR_PENDSVSET;
+        }
+        if (write && (value & SIM_ICSR_PENDSVCLR))
+        {
+            state = 0;
+        }
+        SIM_REG(SCS_BASE + SIM_SCB_ICSR) = state;
+        return;
+    }
+
+    if (!write || (offset < SIM_NVIC_ISER) || (offset >= SIM_NVIC_ICPR + 0x20) || ((offset & 0x7F) >= 0x20))
+    {
+        return;
+    }
+
+    /* Write 1 to set or clear, both registers of a pair read back the state */
+    base = (group < SIM_NVIC_ISPR) ? SIM_NVIC_ISER : SIM_NVIC_ISPR;
+    state = (group == base) ? (old | value) : (old & ~value);
+
+    SIM_REG(SCS_BASE + base + word) = state;
+    SIM_REG(SCS_BASE + base + 0x80 + word) = state;
+}
+
+/*!
+ * @brief       Give a trapped register access its hardware meaning
+ *
+ * @param       addr: register address
+ *
+ * @param       old: register value before the access
+ *
+ * @param       write: access faulted as a write
+ *
+ * @retval      None
+ */
+static void SIM_Access(uint32_t addr, uint32_t old, uint8_t write)
+{
+    uint32_t value = SIM_REG(addr);
+    uint8_t i;
+
+    write = write || (value != old);
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        if (addr - simLineHw[i].usart < SIM_USART_SIZE)
+        {
+            SIM_UsartAccess(i, addr - simLineHw[i].usart, old, value, write);
+        }
+    }
+
+    if ((addr - GPIOA_BASE < SIM_GPIO_NUM * SIM_GPIO_STRIDE) &&
+        ((addr - GPIOA_BASE) % SIM_GPIO_STRIDE < SIM_GPIO_SIZE))
+    {
+        SIM_GpioAccess((addr - GPIOA_BASE) / SIM_GPIO_STRIDE, (addr - GPIOA_BASE) % SIM_GPIO_STRIDE,
+                       old, value, write);
+    }
+
+    if (addr - CRC_BASE < SIM_CRC_SIZE)
+    {
+        SIM_CrcAccess(addr - CRC_BASE, old, value, write);
+    }
+
+    for (i = 0; i < SIM_TMR_NUM; i++)
+    {
+        if (addr - simTmrHw[i].base < SIM_TMR_SIZE)
+        {
+            SIM_TmrAccess(i, addr - simTmrHw[i].base, old, value, write);
+        }
+    }
+
+    /* EINT pending bits clear on 1 */
+    if ((addr == EINT_BASE + SIM_EINT_IPEND) && write)
+    {
+        SIM_REG(addr) = old & ~value;
+    }
+
+    if (addr - DMA1_BASE < 2 * (DMA2_BASE - DMA1_BASE))
+    {
+        SIM_DmaAccess(addr - DMA1_BASE, old, value, write);
+    }
+
+    if (addr - SCS_BASE < SIM_PAGE)
+    {
+        SIM_NvicAccess(addr - SCS_BASE, old, value, write);
+    }
+
+    SIM_Update();
+}
+
+/*!
+ * @brief       First fault of a trapped access
+ *
+ * @param       sig: SIGSEGV
+ *
+ * @param       info: fault address
+ *
+ * @param       context: interrupted context
+ *
+ * @retval      None
+ */
+static void SIM_FaultHandler(int sig, siginfo_t* info, void* context)
+{
+    ucontext_t* uc = (ucontext_t*)context;
+    uintptr_t addr = (uintptr_t)info->si_addr;
+    uint32_t page = SIM_TrapPage(addr);
+
+    (void)sig;
+
+    if ((page == 0) || (simTrap.addr != 0))
+    {
+        /* A real fault, let it terminate the process on return */
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+
+    simTrap.addr = (uint32_t)addr & ~3;
+    SIM_TmrRefresh(simTrap.addr);
+    simTrap.old = SIM_REG(simTrap.addr);
+    simTrap.write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+    simTrap.alarmBlocked = sigismember(&uc->uc_sigmask, SIGALRM);
+
+    /* Let the access execute alone, no tick may run before it is handled */
+    mprotect((void*)(uintptr_t)page, SIM_PAGE, PROT_READ | PROT_WRITE);
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+    sigaddset(&uc->uc_sigmask, SIGALRM);
+}
+
+/*!
+ * @brief       Single step trap after a trapped access
+ *
+ * @param       sig: SIGTRAP
+ *
+ * @param       info: unused
+ *
+ * @param       context: interrupted context
+ *
+ * @retval      None
+ */
+static void SIM_StepHandler(int sig, siginfo_t* info, void* context)
+{
+    ucontext_t* uc = (ucontext_t*)context;
+    uint32_t addr = simTrap.addr;
+
+    (void)sig;
+    (void)info;
+
+    if (addr == 0)
+    {
+        return;
+    }
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+    mprotect((void*)(uintptr_t)SIM_TrapPage(addr), SIM_PAGE, PROT_NONE);
+    if (!simTrap.alarmBlocked)
+    {
+        sigdelset(&uc->uc_sigmask, SIGALRM);
+    }
+    simTrap.addr = 0;
+
+    simStats.traps++;
+    simStats.coreCycles += SIM_BUS_CYCLES;
+    SIM_Access(addr, simTrap.old, simTrap.write);
+}
+
+/*!
+ * @brief       Find the interrupt to enter
+ *
+ * @param       None
+ *
+ * @retval      Asserted and enabled IRQ of highest priority, -1 if none
+ */
+static int SIM_NextIrq(void)
+{
+    uint8_t asserted[SIM_IRQ_NUM] = {0};
+    uint32_t usart;
+    uint32_t sts;
+    uint32_t cfg;
+    uint32_t flags;
+    uint32_t pend;
+    int best = -1;
+    int irq;
+    uint8_t i;
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        usart = simLineHw[i].usart;
+        sts = SIM_REG(usart + SIM_USART_STS);
+
+        if (SIM_USART_IRQ_CTRL1(sts, SIM_REG(usart + SIM_USART_CTRL1)) ||
+            ((sts & SIM_STS_LBD) && (SIM_REG(usart + SIM_USART_CTRL2) & SIM_CTRL2_LBDIEN)) ||
+            ((sts & SIM_STS_CTS) && (SIM_REG(usart + SIM_USART_CTRL3) & SIM_CTRL3_CTSIEN)) ||
+            ((sts & (SIM_STS_FE | SIM_STS_NE | SIM_STS_ORE)) &&
+             ((SIM_REG(usart + SIM_USART_CTRL3) & (SIM_CTRL3_ERRIEN | SIM_CTRL3_DMARXEN)) ==
+              (SIM_CTRL3_ERRIEN | SIM_CTRL3_DMARXEN))))
+        {
+            asserted[simLineHw[i].irq] = 1;
+        }
+    }
+
+    for (i = 0; i < SIM_DMA_CHANNEL_NUM; i++)
+    {
+        cfg = SIM_REG(SIM_ChannelBase(i) + SIM_DMA_CHCFG);
+        flags = *SIM_ChannelSts(i) >> SIM_ChannelShift(i);
+
+        if (((flags & SIM_DMA_TC) && (cfg & SIM_CHCFG_TCINTEN)) ||
+            ((flags & SIM_DMA_HT) && (cfg & SIM_CHCFG_HTINTEN)) ||
+            ((flags & SIM_DMA_TERR) && (cfg & SIM_CHCFG_TERRINTEN)))
+        {
+            asserted[SIM_ChannelIrq(i)] = 1;
+        }
+    }
+
+    /* Capture/compare interrupts only */
+    for (i = 0; i < SIM_TMR_NUM; i++)
+    {
+        if (SIM_REG(simTmrHw[i].base + SIM_TMR_STS) & SIM_REG(simTmrHw[i].base + SIM_TMR_DIEN) & SIM_TMR_STS_CC)
+        {
+            asserted[simTmrHw[i].irq] = 1;
+        }
+    }
+
+    pend = SIM_REG(EINT_BASE + SIM_EINT_IPEND) & SIM_REG(EINT_BASE + SIM_EINT_IMASK);
+    for (i = 0; i < SIM_EINT_GPIO_LINES; i++)
+    {
+        if (pend & (1U << i))
+        {
+            asserted[SIM_EintIrq(i)] = 1;
+        }
+    }
+
+    for (irq = 0; irq < SIM_IRQ_NUM; irq++)
+    {
+        if (SIM_REG(SCS_BASE + SIM_NVIC_ISPR + 4 * (irq >> 5)) & (1U << (irq & 31)))
+        {
+            asserted[irq] = 1;
+        }
+
+        if (!asserted[irq] || (simVector[irq] == NULL) ||
+            !(SIM_REG(SCS_BASE + SIM_NVIC_ISER + 4 * (irq >> 5)) & (1U << (irq & 31))))
+        {
+            continue;
+        }
+
+        if ((best < 0) || (SIM_Alias(SCS_BASE + SIM_NVIC_IP)[irq] < SIM_Alias(SCS_BASE + SIM_NVIC_IP)[best]))
+        {
+            best = irq;
+        }
+    }
+
+    return best;
+}
+
+/*!
+ * @brief       Enter the pending interrupts
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Handlers run one at a time, there is no preemption between them.
+ */
+static void SIM_Dispatch(void)
+{
+    void (*handler)(void);
+    uint64_t start;
+    uint64_t cost;
+    uint32_t traps;
+    uint32_t n;
+    uint8_t priority;
+    int irq;
+
+    if (simIpsr != 0)
+    {
+        return;
+    }
+
+    for (n = 0; n < SIM_DISPATCH_MAX; n++)
+    {
+        irq = SIM_NextIrq();
+        if (irq >= 0)
+        {
+            priority = SIM_Alias(SCS_BASE + SIM_NVIC_IP)[irq];
+        }
+        else if (SIM_REG(SCS_BASE + SIM_SCB_ICSR) & SIM_ICSR_PENDSVSET)
+        {
+            /* PendSV is entered once no interrupt is left, as at the lowest priority */
+            priority = SIM_Alias(SCS_BASE + SIM_SCB_SHP_PENDSV)[0];
+        }
+        else
+        {
+            return;
+        }
+
+        if (simPrimask || ((simBasepri != 0) && (priority >= simBasepri)))
+        {
+            simIrqPending = 1;
+            return;
+        }
+
+        /* Entry clears the pending bit and the exclusive monitor */
+        if (irq >= 0)
+        {
+            SIM_REG(SCS_BASE + SIM_NVIC_ISPR + 4 * (irq >> 5)) &= ~(1U << (irq & 31));
+            SIM_REG(SCS_BASE + SIM_NVIC_ICPR + 4 * (irq >> 5)) &= ~(1U << (irq & 31));
+            simIpsr = irq + 16;
+            handler = simVector[irq];
+        }
+        else
+        {
+            SIM_REG(SCS_BASE + SIM_SCB_ICSR) &= ~SIM_ICSR_PENDSVSET;
+            simIpsr = SIM_PENDSV_EXC;
+            handler = PendSV_Handler;
+        }
+        simExclusive = 0;
+        simStats.coreCycles += SIM_EXC_ENTRY_CYCLES;
+        SIM_SyncCycleCounter();
+
+        traps = simStats.traps;
+        start = __rdtsc();
+        handler();
+        cost = __rdtsc() - start;
+
+        /* Leave out the time the host spends on the register traps */
+        traps = simStats.traps - traps;
+        simStats.isrHostCycles += (cost > traps * simTrapCost) ? (cost - traps * simTrapCost) : 0;
+        simStats.irqs++;
+
+        simIpsr = 0;
+        simStats.coreCycles += SIM_EXC_RETURN_CYCLES;
+        SIM_Update();
+    }
+
+    simStats.irqStorms++;
+}
+
+/*!
+ * @brief       Interrupts were unmasked, enter the ones held back
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+void SIM_IrqUnmasked(void)
+{
+    sigset_t alarm;
+    sigset_t saved;
+
+    if (!simIrqPending || (simIpsr != 0))
+    {
+        return;
+    }
+
+    sigemptyset(&alarm);
+    sigaddset(&alarm, SIGALRM);
+    sigprocmask(SIG_BLOCK, &alarm, &saved);
+
+    simIrqPending = 0;
+    SIM_Run(0);
+
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+}
+
+/*!
+ * @brief       Sleep until the next tick, with interrupts masked until one is pending
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Time goes on while the core sleeps, masked or not, and counts
+ *              as time asleep. As on the core, a masked interrupt ends WFI
+ *              and is entered once interrupts are unmasked.
+ */
+void SIM_WaitForInterrupt(void)
+{
+    sigset_t mask;
+    uint64_t start = simStats.time;
+
+    sigprocmask(SIG_SETMASK, NULL, &mask);
+    sigdelset(&mask, SIGALRM);
+
+    simSleeping = 1;
+    do
+    {
+        sigsuspend(&mask);
+    } while (simPrimask && !simIrqPending);
+    simSleeping = 0;
+
+    simStats.sleepCycles += simStats.time - start;
+    simStats.sleeps++;
+}
+
+/*!
+ * @brief       Character as the receiver samples it from a sender at another rate
+ *
+ * @param       i: line index
+ *
+ * @param       data: character sent and SIM_CHAR_xxx flags
+ *
+ * @retval      Character received, SIM_CHAR_FE if the stop bit sample is low
+ *
+ * @note        Bits are sampled in the middle of the receiver bit times,
+ *              counted from the start bit of the sender.
+ */
+static uint16_t SIM_RxSample(uint8_t i, uint16_t data)
+{
+    uint32_t sender = simLine[i].bitCycles;
+    uint32_t bitCycles = SIM_BitCycles(i);
+    uint8_t bits = (SIM_REG(simLineHw[i].usart + SIM_USART_CTRL1) & SIM_CTRL1_WLEN) ? 9 : 8;
+    uint16_t out = data & ~SIM_CHAR_DATA;
+    uint32_t k;
+    uint32_t r;
+    uint8_t level;
+
+    if ((sender == 0) || (data & SIM_CHAR_BREAK))
+    {
+        return data;
+    }
+
+    for (k = 1; k <= (uint32_t)bits + 1; k++)
+    {
+        r = (uint32_t)((2 * (uint64_t)k + 1) * bitCycles / (2 * (uint64_t)sender));
+        level = (r == 0) ? 0 : ((r <= bits) ? ((data >> (r - 1)) & 1) : 1);
+
+        if (k <= bits)
+        {
+            out |= level << (k - 1);
+        }
+        else if (!level)
+        {
+            out |= SIM_CHAR_FE;
+        }
+    }
+
+    return out;
+}
+
+/*!
+ * @brief       A character on the wire has reached its stop bit
+ *
+ * @param       i: line index
+ *
+ * @retval      None
+ */
+static void SIM_RxDone(uint8_t i)
+{
+    SIM_Line_T* line = &simLine[i];
+    SIM_RxChar_T* c = &line->rxQueue[line->rxTail];
+    volatile uint32_t* sts = &SIM_REG(simLineHw[i].usart + SIM_USART_STS);
+    volatile uint32_t* ctrl1Reg = &SIM_REG(simLineHw[i].usart + SIM_USART_CTRL1);
+    uint32_t ctrl1 = *ctrl1Reg;
+    uint16_t data;
+    uint16_t mark;
+
+    line->rxBusy = 0;
+    line->rxFree = line->rxEnd;
+    line->rxTail = (line->rxTail + 1) % SIM_RX_QUEUE_LEN;
+
+    if (((ctrl1 & (SIM_CTRL1_UEN | SIM_CTRL1_RXEN)) != (SIM_CTRL1_UEN | SIM_CTRL1_RXEN)) || line->rxMissed)
+    {
+        return;
+    }
+
+    data = SIM_RxSample(i, c->data);
+
+    /* Address mark wake up: the top data bit marks an address, matched on its low 4 bits */
+    if (ctrl1 & SIM_CTRL1_WUPMCFG)
+    {
+        mark = (ctrl1 & SIM_CTRL1_WLEN) ? 0x100 : 0x80;
+        if (data & mark)
+        {
+            if ((data & SIM_CTRL2_ADDR) == (SIM_REG(simLineHw[i].usart + SIM_USART_CTRL2) & SIM_CTRL2_ADDR))
+            {
+                *ctrl1Reg &= ~SIM_CTRL1_RXMUTEEN;
+            }
+            else
+            {
+                *ctrl1Reg |= SIM_CTRL1_RXMUTEEN;
+            }
+        }
+    }
+
+    /* A muted receiver sets no flag, not even idle after the character */
+    if (*ctrl1Reg & SIM_CTRL1_RXMUTEEN)
+    {
+        simStats.muted[i]++;
+        return;
+    }
+
+    simStats.rxChars[i]++;
+
+    /* LIN break detection runs beside the receiver, which takes a 0 with FE */
+    if (data & SIM_CHAR_BREAK)
+    {
+        simStats.breaks[i]++;
+        if (SIM_REG(simLineHw[i].usart + SIM_USART_CTRL2) & SIM_CTRL2_LINMEN)
+        {
+            *sts |= SIM_STS_LBD;
+        }
+    }
+
+    if (*sts & SIM_STS_RXBNE)
+    {
+        /* DATA is kept, the new character is lost */
+        *sts |= SIM_STS_ORE;
+        simStats.overruns[i]++;
+    }
+    else
+    {
+        line->rdr = data & SIM_CHAR_DATA;
+        SIM_REG(simLineHw[i].usart + SIM_USART_DATA) = line->rdr;
+        *sts |= SIM_STS_RXBNE |
+                ((data & SIM_CHAR_PE) ? SIM_STS_PE : 0) |
+                ((data & (SIM_CHAR_FE | SIM_CHAR_BREAK)) ? SIM_STS_FE : 0) |
+                ((data & SIM_CHAR_NE) ? SIM_STS_NE : 0);
+    }
+
+    line->idleAt = line->rxEnd + SIM_LineCharCycles(i);
+}
+
+/*!
+ * @brief       Advance simulated time
+ *
+ * @param       cycles: core cycles to run, 0 only settles pending events
+ *
+ * @retval      None
+ */
+void SIM_Run(uint32_t cycles)
+{
+    uint64_t end = simStats.time + cycles;
+    uint64_t next;
+    SIM_Line_T* line;
+    int t;
+    uint8_t i;
+
+    SIM_Update();
+    SIM_Dispatch();
+
+    for (;;)
+    {
+        next = end;
+        for (i = 0; i < SIM_LINE_NUM; i++)
+        {
+            line = &simLine[i];
+            SIM_RxNext(i);
+
+            if (line->rxBusy && (line->rxEnd < next))
+            {
+                next = line->rxEnd;
+            }
+            if (line->idleAt && (line->idleAt < next))
+            {
+                next = line->idleAt;
+            }
+            if (line->txBusy && (line->txEnd < next))
+            {
+                next = line->txEnd;
+            }
+
+            /* Edges are events only while a timer channel captures them */
+            while ((line->edgeNext < line->edgeNum) && (line->edge[line->edgeNext] < simStats.time))
+            {
+                line->edgeNext++;
+            }
+            if ((line->edgeNext < line->edgeNum) && (line->edge[line->edgeNext] < next) &&
+                (SIM_LineCapture(i) >= 0))
+            {
+                next = line->edge[line->edgeNext];
+            }
+        }
+
+        for (t = 0; t < SIM_TMR_NUM; t++)
+        {
+            if (simTmr[t].compareAt && (simTmr[t].compareAt < next))
+            {
+                next = simTmr[t].compareAt;
+            }
+        }
+
+        simStats.time = next;
+
+        for (t = 0; t < SIM_TMR_NUM; t++)
+        {
+            if (simTmr[t].compareAt == next)
+            {
+                SIM_REG(simTmrHw[t].base + SIM_TMR_STS) |= SIM_TMR_STS_CC1 << simTmrHw[t].channel;
+                SIM_TmrSchedule(t);
+            }
+        }
+
+        for (i = 0; i < SIM_LINE_NUM; i++)
+        {
+            line = &simLine[i];
+
+            t = SIM_LineCapture(i);
+            if ((line->edgeNext < line->edgeNum) && (line->edge[line->edgeNext] == next) && (t >= 0))
+            {
+                SIM_TmrEdge(t, line->edgeLevel[line->edgeNext]);
+                line->edgeNext++;
+            }
+
+            if (line->rxBusy && (line->rxEnd == next))
+            {
+                SIM_RxDone(i);
+            }
+
+            if (line->idleAt && (line->idleAt == next))
+            {
+                SIM_REG(simLineHw[i].usart + SIM_USART_STS) |= SIM_STS_IDLE;
+                simStats.idles[i]++;
+                line->idleAt = 0;
+            }
+
+            if (line->txBusy && (line->txEnd == next))
+            {
+                line->txBusy = 0;
+                simStats.txChars[i]++;
+                if (line->shift & SIM_CHAR_BREAK)
+                {
+                    SIM_REG(simLineHw[i].usart + SIM_USART_CTRL1) &= ~SIM_CTRL1_TXBF;
+                }
+                if (simTxHook != NULL)
+                {
+                    simTxHook(i, line->shift);
+                }
+
+                if ((line->dePort != 0) && (line->deLost || !SIM_PinLevel(line->dePort, line->dePin)))
+                {
+                    simStats.deClipped[i]++;
+                }
+
+                SIM_LineService(i);
+                if (!line->txBusy)
+                {
+                    SIM_REG(simLineHw[i].usart + SIM_USART_STS) |= SIM_STS_TC;
+                    if ((line->dePort != 0) && SIM_PinLevel(line->dePort, line->dePin))
+                    {
+                        line->deIdleAt = simStats.time + simStats.coreCycles;
+                    }
+                }
+            }
+        }
+
+        SIM_Update();
+        SIM_Dispatch();
+
+        /* A masked interrupt wakes a core in WFI here, the rest of the tick is left out */
+        if ((next == end) || (simSleeping && simIrqPending))
+        {
+            return;
+        }
+    }
+}
+
+/*!
+ * @brief       Periodic tick, advances the model
+ *
+ * @param       sig: SIGALRM
+ *
+ * @retval      None
+ */
+static void SIM_TickHandler(int sig)
+{
+    (void)sig;
+
+    /* A critical section takes no simulated time, the tick is left out unless the core sleeps in it */
+    if (!simPrimask || simSleeping)
+    {
+        SIM_Run(simTickCycles);
+    }
+
+    if (simTickHook != NULL)
+    {
+        simTickHook();
+    }
+
+    /* One shot, so the application always gets a full tick of host time */
+    setitimer(ITIMER_REAL, &simTickTimer, NULL);
+}
+
+/*!
+ * @brief       Start advancing the model from a host interval timer
+ *
+ * @param       tickCycles: simulated core cycles per tick
+ *
+ * @param       tickUs: host microseconds the application runs between ticks
+ *
+ * @param       hook: called after every tick, may be NULL
+ *
+ * @retval      None
+ */
+void SIM_Start(uint32_t tickCycles, uint32_t tickUs, void (*hook)(void))
+{
+    struct sigaction sa;
+
+    simTickCycles = tickCycles;
+    simTickHook = hook;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIM_TickHandler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGALRM, &sa, NULL);
+
+    simTickTimer.it_value.tv_sec = 0;
+    simTickTimer.it_value.tv_usec = tickUs;
+    setitimer(ITIMER_REAL, &simTickTimer, NULL);
+}
+
+/*!
+ * @brief       Set the callback of transmitted characters
+ *
+ * @param       hook: callback, NULL for none
+ *
+ * @retval      None
+ */
+void SIM_SetTxHook(SIM_TxHook_T hook)
+{
+    simTxHook = hook;
+}
+
+/*!
+ * @brief       Queue a character for a line to receive
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @param       data: character and SIM_CHAR_xxx error flags
+ *
+ * @param       idleBits: idle bit times before the start bit, a full
+ *                        character time or more lets IDLE be detected
+ *
+ * @retval      1 if queued, 0 if the line queue is full
+ */
+uint8_t SIM_LineFeed(uint8_t line, uint16_t data, uint16_t idleBits)
+{
+    SIM_Line_T* l = &simLine[line];
+    uint32_t next = (l->rxHead + 1) % SIM_RX_QUEUE_LEN;
+
+    if (next == l->rxTail)
+    {
+        return 0;
+    }
+
+    l->rxQueue[l->rxHead].data = data;
+    l->rxQueue[l->rxHead].idleBits = idleBits;
+    l->rxHead = next;
+
+    return 1;
+}
+
+/*!
+ * @brief       Send to a line at a rate of its own
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @param       baudRate: rate of the sender, 0 to follow the BR register of the line
+ *
+ * @retval      None
+ *
+ * @note        The receiver samples the characters at its own BR, a rate
+ *              too far off gives other data and framing errors.
+ */
+void SIM_LineRate(uint8_t line, uint32_t baudRate)
+{
+    simLine[line].bitCycles = (baudRate != 0) ? (SIM_HCLK + baudRate / 2) / baudRate : 0;
+}
+
+/*!
+ * @brief       Wire the transmit pin of a line to the receive pin of another
+ *
+ * @param       from: SIM_LINE_xxx that sends
+ *
+ * @param       to: SIM_LINE_xxx that receives, SIM_LINE_NUM to open the wire
+ *
+ * @retval      None
+ *
+ * @note        The receiving line takes the characters with its own timing,
+ *              both lines should run the same frame format and rate.
+ */
+void SIM_LineConnect(uint8_t from, uint8_t to)
+{
+    simLink[from] = (to < SIM_LINE_NUM) ? to + 1 : 0;
+}
+
+/*!
+ * @brief       Hold back the characters fed to a line while a pin is high
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @param       rtsPort: GPIO of the RTS output of the line, NULL for none
+ *
+ * @param       rtsPin: GPIO_PIN_x
+ *
+ * @retval      None
+ */
+void SIM_LineFlow(uint8_t line, GPIO_T* rtsPort, uint16_t rtsPin)
+{
+    simLine[line].rtsPort = (uint32_t)(uintptr_t)rtsPort;
+    simLine[line].rtsPin = rtsPin;
+}
+
+/*!
+ * @brief       Put an RS-485 transceiver on the transmit side of a line
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @param       dePort: GPIO of the driver enable output, NULL for none
+ *
+ * @param       dePin: GPIO_PIN_x
+ *
+ * @retval      None
+ *
+ * @note        A character that starts or ends with DE low counts in
+ *              deClipped. The time from the last stop bit to DE going low
+ *              counts in deTurnMax.
+ */
+void SIM_LineDriver(uint8_t line, GPIO_T* dePort, uint16_t dePin)
+{
+    simLine[line].dePort = (uint32_t)(uintptr_t)dePort;
+    simLine[line].dePin = dePin;
+}
+
+/*!
+ * @brief       Drive input pins from outside the device
+ *
+ * @param       port: GPIOA to GPIOF
+ *
+ * @param       pin: GPIO_PIN_x, may be combined
+ *
+ * @param       level: 1 for high, the reset level of every input
+ *
+ * @retval      None
+ */
+void SIM_PinSet(GPIO_T* port, uint16_t pin, uint8_t level)
+{
+    uint8_t p = ((uint32_t)(uintptr_t)port - GPIOA_BASE) / SIM_GPIO_STRIDE;
+
+    if (level)
+    {
+        simPinIn[p] |= pin;
+    }
+    else
+    {
+        simPinIn[p] &= ~pin;
+    }
+
+    SIM_GpioUpdate(p);
+    SIM_Update();
+}
+
+/*!
+ * @brief       Characters not yet received by a line
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @retval      Number of queued characters, the one on the wire included
+ */
+uint32_t SIM_LinePending(uint8_t line)
+{
+    return (simLine[line].rxHead + SIM_RX_QUEUE_LEN - simLine[line].rxTail) % SIM_RX_QUEUE_LEN;
+}
+
+/*!
+ * @brief       Line is still sending
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @retval      1 while a character is in the shift or data register
+ */
+uint8_t SIM_LineBusy(uint8_t line)
+{
+    return simLine[line].txBusy || simLine[line].tdrFull;
+}
+
+/*!
+ * @brief       Cycle counter read of the application timestamps
+ *
+ * @param       None
+ *
+ * @retval      Simulated time plus charged core cycles, like DWT CYCCNT
+ *
+ * @note        Time stands still in critical sections and handlers, so a
+ *              read there is charged as a bus access and a busy wait there
+ *              comes to an end.
+ */
+uint32_t SIM_ReadCycleCounter(void)
+{
+    if (simPrimask || simIpsr)
+    {
+        __atomic_fetch_add(&simStats.coreCycles, SIM_BUS_CYCLES, __ATOMIC_RELAXED);
+    }
+
+    return (uint32_t)(simStats.time + simStats.coreCycles);
+}
+
+/*!
+ * @brief       Map the device memory and install the access traps
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Link with -no-pie: DMA address registers are 32 bits wide, so
+ *              buffers must live in the low 4 GB like on the device.
+ */
+void SIM_Init(void)
+{
+    struct sigaction sa;
+    uint64_t start;
+    uint32_t n;
+    uint8_t i;
+    int fd;
+
+    fd = memfd_create("apm32f10x", 0);
+    if ((fd < 0) || (ftruncate(fd, SIM_MEM_SIZE) != 0))
+    {
+        perror("sim: memfd");
+        exit(1);
+    }
+
+    simAlias = mmap(NULL, SIM_MEM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if ((simAlias == MAP_FAILED) ||
+        (mmap((void*)PERIPH_BASE, SIM_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0) != (void*)PERIPH_BASE) ||
+        (mmap((void*)SCS_BASE, SIM_PAGE, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED_NOREPLACE, fd, SIM_SCS_OFFSET) != (void*)SCS_BASE) ||
+        (mmap((void*)DWT_BASE, SIM_PAGE, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void*)DWT_BASE))
+    {
+        perror("sim: mmap");
+        exit(1);
+    }
+
+    /* Reset values, clock tree as left by SystemInit(): 72 MHz from PLL, APB1 at 36 MHz */
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        SIM_REG(simLineHw[i].usart + SIM_USART_STS) = SIM_STS_RESET;
+    }
+
+    for (i = 0; i < SIM_GPIO_NUM; i++)
+    {
+        SIM_REG(GPIOA_BASE + SIM_GPIO_STRIDE * i + SIM_GPIO_CFGLOW) = SIM_GPIO_CFG_RESET;
+        SIM_REG(GPIOA_BASE + SIM_GPIO_STRIDE * i + SIM_GPIO_CFGHIG) = SIM_GPIO_CFG_RESET;
+        simPinIn[i] = 0xFFFF;
+        SIM_GpioUpdate(i);
+    }
+
+    SIM_REG(CRC_BASE + SIM_CRC_DATA) = SIM_CRC_RESET;
+
+    for (i = 0; i < SIM_TMR_NUM; i++)
+    {
+        SIM_REG(simTmrHw[i].base + SIM_TMR_AUTORLD) = SIM_TMR_AUTORLD_RESET;
+    }
+
+    RCM->CFG_B.SCLKSEL = RCM_SYSCLK_SEL_PLL;
+    RCM->CFG_B.PLL1SRCSEL = BIT_SET;
+    RCM->CFG_B.PLL1MULCFG = RCM_PLLMF_9;
+    RCM->CFG_B.APB1PSC = RCM_APB_DIV_2;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = SIM_FaultHandler;
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, SIGALRM);
+    sigaction(SIGSEGV, &sa, NULL);
+
+    sa.sa_sigaction = SIM_StepHandler;
+    sigaction(SIGTRAP, &sa, NULL);
+
+    for (i = 0; i < sizeof(simTrapPage) / sizeof(simTrapPage[0]); i++)
+    {
+        mprotect((void*)(uintptr_t)simTrapPage[i], SIM_PAGE, PROT_NONE);
+    }
+
+    /* Host cost of one trapped access, from a reserved word of the DMA page */
+    start = __rdtsc();
+    for (n = 0; n < SIM_TRAP_CALIBRATE; n++)
+    {
+        (void)*(volatile uint32_t*)(DMA1_BASE + SIM_PAGE / 2);
+    }
+    simTrapCost = (__rdtsc() - start) / SIM_TRAP_CALIBRATE;
+    simStats.traps = 0;
+}
+
+/**@} end of group SIM_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
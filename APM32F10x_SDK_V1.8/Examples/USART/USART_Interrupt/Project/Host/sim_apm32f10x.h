@@ -0,0 +1,146 @@
+/*!
+ * @file        sim_apm32f10x.h
+ *
+ * @brief       Header for sim_apm32f10x.c module
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __SIM_APM32F10X_H
+#define __SIM_APM32F10X_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes */
+#include "apm32f10x.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup SIM_Macros Macros
+  @{
+*/
+
+/* Modelled serial lines, in SIM_LINE_xxx order */
+#define SIM_LINE_USART1         0
+#define SIM_LINE_USART2         1
+#define SIM_LINE_USART3         2
+#define SIM_LINE_UART4          3
+#define SIM_LINE_UART5          4
+#define SIM_LINE_NUM            5
+
+/* Modelled DMA channels, DMA1 channel 1 to 7 then DMA2 channel 1 to 5 */
+#define SIM_DMA_CHANNEL_NUM     12
+
+/* Characters that can wait on one receive line */
+#define SIM_RX_QUEUE_LEN        4096
+
+/* SIM_LineFeed() character: data and receive error flags */
+#define SIM_CHAR_DATA           0x01FF
+#define SIM_CHAR_BREAK          0x1000  /*!< Break, received as 0 with a framing error */
+#define SIM_CHAR_NE             0x2000  /*!< Noise error */
+#define SIM_CHAR_FE             0x4000  /*!< Framing error */
+#define SIM_CHAR_PE             0x8000  /*!< Parity error */
+
+/* Core clock of the simulated device */
+#define SIM_HCLK                72000000
+
+/**@} end of group SIM_Macros */
+
+/** @defgroup SIM_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Called with every character a line finishes sending, SIM_CHAR_BREAK for a break
+ */
+typedef void (*SIM_TxHook_T)(uint8_t line, uint16_t data);
+
+/**
+ * @brief   Model counters
+ */
+typedef struct
+{
+    uint64_t time;            /*!< Simulated core cycles since SIM_Init() */
+    uint32_t traps;           /*!< Trapped register accesses */
+    uint32_t irqs;            /*!< Dispatched interrupts */
+    uint32_t irqStorms;       /*!< Dispatch loops stopped with an interrupt still asserted */
+    uint64_t isrHostCycles;   /*!< Host TSC cycles spent in interrupt handlers, traps left out */
+    uint64_t coreCycles;      /*!< Charged for exception entry/return and register accesses */
+    uint64_t sleepCycles;     /*!< Simulated time the core spent in WFI */
+    uint32_t sleeps;          /*!< WFI entered */
+    uint32_t rxChars[SIM_LINE_NUM];
+    uint32_t txChars[SIM_LINE_NUM];
+    uint32_t overruns[SIM_LINE_NUM];
+    uint32_t idles[SIM_LINE_NUM];
+    uint32_t muted[SIM_LINE_NUM];       /*!< Characters dropped by the muted receiver */
+    uint32_t breaks[SIM_LINE_NUM];      /*!< Breaks received */
+    uint32_t deClipped[SIM_LINE_NUM];   /*!< Characters sent with the RS-485 driver off */
+    uint32_t deTurns[SIM_LINE_NUM];     /*!< Driver releases after the last stop bit */
+    uint32_t deTurnMax[SIM_LINE_NUM];   /*!< Longest last stop bit to release, core cycles */
+    uint32_t captures[SIM_LINE_NUM];    /*!< RX pin edges captured by a timer channel */
+} SIM_Stats_T;
+
+/**@} end of group SIM_Structures */
+
+/** @defgroup SIM_Variables Variables
+  @{
+*/
+
+extern SIM_Stats_T simStats;
+
+/**@} end of group SIM_Variables */
+
+/** @defgroup SIM_Functions Functions
+  @{
+*/
+
+void SIM_Init(void);
+void SIM_Run(uint32_t cycles);
+void SIM_Start(uint32_t tickCycles, uint32_t tickUs, void (*hook)(void));
+void SIM_SetTxHook(SIM_TxHook_T hook);
+uint8_t SIM_LineFeed(uint8_t line, uint16_t data, uint16_t idleBits);
+void SIM_LineRate(uint8_t line, uint32_t baudRate);
+void SIM_LineConnect(uint8_t from, uint8_t to);
+void SIM_LineFlow(uint8_t line, GPIO_T* rtsPort, uint16_t rtsPin);
+void SIM_LineDriver(uint8_t line, GPIO_T* dePort, uint16_t dePin);
+void SIM_PinSet(GPIO_T* port, uint16_t pin, uint8_t level);
+uint32_t SIM_LinePending(uint8_t line);
+uint8_t SIM_LineBusy(uint8_t line);
+uint32_t SIM_LineCharCycles(uint8_t line);
+uint64_t SIM_ReadHostCycles(void);
+
+/**@} end of group SIM_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_APM32F10X_H */
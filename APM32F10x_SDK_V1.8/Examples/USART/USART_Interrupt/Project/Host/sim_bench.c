@@ -0,0 +1,196 @@
+/*!
+ * @file        sim_bench.c
+ *
+ * @brief       Host run of the USART_Interrupt benchmark on the register model
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * The example is built with UART_DMA_BENCH and -Dmain=APP_Main. USART2 and
+ * USART1 are wired to each other like the loopback jumpers on the board and
+ * the result lines the benchmark sends on USART3 are copied to stdout.
+ * Usage: sim_bench [max seconds of simulated time]
+ */
+
+/* Includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_apm32f10x.h"
+#include "uart_dma.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup SIM_Bench_Macros Macros
+  @{
+*/
+
+/* The example is built with -Dmain=APP_Main, this file provides the real one */
+#undef main
+
+/* Longest result line */
+#define BENCH_LINE_MAX      512
+
+/**@} end of group SIM_Bench_Macros */
+
+/** @defgroup SIM_Bench_Variables Variables
+  @{
+*/
+
+static char     benchLine[BENCH_LINE_MAX];
+static uint32_t benchLineLen;
+static uint8_t  benchFailed;
+static uint64_t benchTimeout;
+
+/**@} end of group SIM_Bench_Variables */
+
+/** @defgroup SIM_Bench_Functions Functions
+  @{
+*/
+
+int APP_Main(void);
+
+/* Ports of the example */
+extern UART_DMA_Port_T uartPorts[SIM_LINE_NUM];
+
+/*!
+ * @brief       Print the model counters and exit
+ *
+ * @param       failed: 1 if the benchmark reported errors or did not finish
+ *
+ * @retval      None
+ */
+static void BENCH_Exit(uint8_t failed)
+{
+    printf("sim result=%s cycles=%llu core_cycles=%llu irqs=%u storms=%u traps=%u\n",
+           failed ? "fail" : "pass", (unsigned long long)simStats.time,
+           (unsigned long long)simStats.coreCycles, simStats.irqs, simStats.irqStorms, simStats.traps);
+
+    fflush(stdout);
+    exit(failed ? 1 : 0);
+}
+
+/*!
+ * @brief       Collect the result lines sent on USART3
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @param       data: character
+ *
+ * @retval      None
+ */
+static void BENCH_TxHook(uint8_t line, uint16_t data)
+{
+    const char* errors;
+
+    if ((line != SIM_LINE_USART3) || (data == '\r'))
+    {
+        return;
+    }
+
+    if ((data != '\n') && (benchLineLen < BENCH_LINE_MAX - 1))
+    {
+        benchLine[benchLineLen++] = (char)data;
+        return;
+    }
+
+    benchLine[benchLineLen] = 0;
+    benchLineLen = 0;
+    printf("%s\n", benchLine);
+
+    errors = strstr(benchLine, " errors=");
+    if ((errors != NULL) && (strtoul(errors + 8, NULL, 10) != 0))
+    {
+        benchFailed = 1;
+    }
+
+    if (strncmp(benchLine, "bench end", 9) == 0)
+    {
+        BENCH_Exit(benchFailed);
+    }
+}
+
+/*!
+ * @brief       Called after every model tick
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void BENCH_Tick(void)
+{
+    if (simStats.time > benchTimeout)
+    {
+        printf("sim timeout\n");
+        BENCH_Exit(1);
+    }
+}
+
+/*!
+ * @brief       Host entry
+ *
+ * @param       argc: argument count
+ *
+ * @param       argv: [max seconds of simulated time]
+ *
+ * @retval      0 when every run finished without errors
+ */
+int main(int argc, char* argv[])
+{
+    const UART_DMA_Flow_T* flow;
+    uint8_t i;
+
+    benchTimeout = (uint64_t)SIM_HCLK * ((argc > 1) ? strtoul(argv[1], NULL, 0) : 60);
+
+    SIM_Init();
+    SIM_SetTxHook(BENCH_TxHook);
+    SIM_LineConnect(SIM_LINE_USART2, SIM_LINE_USART1);
+    SIM_LineConnect(SIM_LINE_USART1, SIM_LINE_USART2);
+
+    /* With flow control, CTS stays asserted and each port paces its input with RTS */
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        flow = uartPorts[i].flow;
+        if ((flow != NULL) && (flow->ctsPort != NULL))
+        {
+            SIM_PinSet(flow->ctsPort, flow->ctsPin, 0);
+        }
+        if ((flow != NULL) && (flow->rtsPort != NULL))
+        {
+            SIM_LineFlow(i, flow->rtsPort, flow->rtsPin);
+        }
+    }
+
+    /* A 2250000 baud character every 320 cycles, so ticks stay shorter than that */
+    SIM_Start(250, 20, BENCH_Tick);
+
+    return APP_Main();
+}
+
+/**@} end of group SIM_Bench_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
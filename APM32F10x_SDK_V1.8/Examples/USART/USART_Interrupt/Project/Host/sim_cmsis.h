@@ -0,0 +1,298 @@
+/*!
+ * @file        sim_cmsis.h
+ *
+ * @brief       CMSIS compiler layer of the host simulation
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * Forced into every host translation unit with "-include sim_cmsis.h". It
+ * defines the cmsis_compiler.h include guard so the ARM inline assembly of
+ * cmsis_gcc.h is never seen, and provides the core intrinsics on top of the
+ * simulated PRIMASK and exclusive monitor of sim_apm32f10x.c.
+ */
+
+/* Define to prevent recursive inclusion */
+#ifndef __SIM_CMSIS_H
+#define __SIM_CMSIS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The model uses the glibc names of the x86-64 signal context registers */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+/* Includes */
+#include <stdint.h>
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup SIM_CMSIS_Macros Macros
+  @{
+*/
+
+/* Replaces cmsis_compiler.h */
+#define __CMSIS_COMPILER_H
+
+#define __ASM                   __asm
+#define __INLINE                inline
+#define __STATIC_INLINE         static inline
+#define __STATIC_FORCEINLINE    __attribute__((always_inline)) static inline
+#define __NO_RETURN             __attribute__((__noreturn__))
+#define __USED                  __attribute__((used))
+#define __WEAK                  __attribute__((weak))
+#define __PACKED                __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT         struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION          union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+#define __RESTRICT              __restrict
+#define __COMPILER_BARRIER()    __asm volatile("" ::: "memory")
+
+#define __BKPT(value)           __builtin_trap()
+#define __WFI()                 SIM_WaitForInterrupt()
+#define __WFE()                 SIM_WaitForInterrupt()
+#define __SEV()                 __COMPILER_BARRIER()
+
+/* Engine timestamps read the model clock, see SIM_ReadCycleCounter() */
+#define UART_DMA_TIMESTAMP()    SIM_ReadCycleCounter()
+#define UART_DMA_TIMESTAMP_HZ   SystemCoreClock
+
+/**@} end of group SIM_CMSIS_Macros */
+
+/** @defgroup SIM_CMSIS_Variables Variables
+  @{
+*/
+
+/* Core state kept by sim_apm32f10x.c */
+extern volatile uint32_t simPrimask;
+extern volatile uint32_t simBasepri;
+extern volatile uint32_t simIpsr;
+extern volatile uint32_t simExclusive;
+
+/**@} end of group SIM_CMSIS_Variables */
+
+/** @defgroup SIM_CMSIS_Functions Functions
+  @{
+*/
+
+void SIM_IrqUnmasked(void);
+void SIM_WaitForInterrupt(void);
+uint32_t SIM_ReadCycleCounter(void);
+
+__STATIC_FORCEINLINE void __NOP(void)
+{
+    __COMPILER_BARRIER();
+}
+
+__STATIC_FORCEINLINE void __DMB(void)
+{
+    __sync_synchronize();
+}
+
+__STATIC_FORCEINLINE void __DSB(void)
+{
+    __sync_synchronize();
+}
+
+__STATIC_FORCEINLINE void __ISB(void)
+{
+    __sync_synchronize();
+}
+
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)
+{
+    return simPrimask;
+}
+
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask)
+{
+    __COMPILER_BARRIER();
+    simPrimask = priMask & 1;
+    __COMPILER_BARRIER();
+
+    if (simPrimask == 0)
+    {
+        SIM_IrqUnmasked();
+    }
+}
+
+__STATIC_FORCEINLINE void __disable_irq(void)
+{
+    __set_PRIMASK(1);
+}
+
+__STATIC_FORCEINLINE void __enable_irq(void)
+{
+    __set_PRIMASK(0);
+}
+
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void)
+{
+    return simBasepri;
+}
+
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basePri)
+{
+    __COMPILER_BARRIER();
+    simBasepri = basePri & 0xFF;
+    __COMPILER_BARRIER();
+
+    if (simBasepri == 0)
+    {
+        SIM_IrqUnmasked();
+    }
+}
+
+__STATIC_FORCEINLINE void __set_BASEPRI_MAX(uint32_t basePri)
+{
+    if ((basePri != 0) && ((simBasepri == 0) || (basePri < simBasepri)))
+    {
+        __set_BASEPRI(basePri);
+    }
+}
+
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void)
+{
+    return simIpsr;
+}
+
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void)
+{
+    return 0;
+}
+
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value)
+{
+    return (value == 0) ? 32 : (uint8_t)__builtin_clz(value);
+}
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+    uint8_t i;
+
+    for (i = 0; i < 32; i++)
+    {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+
+    return result;
+}
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value)
+{
+    return ((value & 0xFF00FF00) >> 8) | ((value & 0x00FF00FF) << 8);
+}
+
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t value)
+{
+    return (int16_t)__builtin_bswap16((uint16_t)value);
+}
+
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+    op2 %= 32;
+    return (op2 == 0) ? op1 : ((op1 >> op2) | (op1 << (32 - op2)));
+}
+
+/*
+ * Exclusive access. The monitor is cleared on every simulated exception
+ * entry, so a STREX after an interrupted LDREX fails like on the core.
+ */
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t* addr)
+{
+    simExclusive = 1;
+    __COMPILER_BARRIER();
+    return *addr;
+}
+
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t* addr)
+{
+    simExclusive = 1;
+    __COMPILER_BARRIER();
+    return *addr;
+}
+
+__STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t* addr)
+{
+    simExclusive = 1;
+    __COMPILER_BARRIER();
+    return *addr;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t* addr)
+{
+    if (!__sync_bool_compare_and_swap(&simExclusive, 1, 0))
+    {
+        return 1;
+    }
+    *addr = value;
+    return 0;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t* addr)
+{
+    if (!__sync_bool_compare_and_swap(&simExclusive, 1, 0))
+    {
+        return 1;
+    }
+    *addr = value;
+    return 0;
+}
+
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t value, volatile uint8_t* addr)
+{
+    if (!__sync_bool_compare_and_swap(&simExclusive, 1, 0))
+    {
+        return 1;
+    }
+    *addr = value;
+    return 0;
+}
+
+__STATIC_FORCEINLINE void __CLREX(void)
+{
+    simExclusive = 0;
+}
+
+/**@} end of group SIM_CMSIS_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_CMSIS_H */
@@ -0,0 +1,2115 @@
+/*!
+ * @file        sim_main.c
+ *
+ * @brief       Host fuzz run of the USART_Interrupt example on the register model
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * The unmodified example main() is built as APP_Main() and runs as the
+ * application. Every port receives random frames separated by random gaps,
+ * some shorter and some longer than the idle detection time, and the echo
+ * sent back must match what was received. Ports built with flow control
+ * (-DUART_FLOW_CONTROL=1) get their CTS input toggled at random and the
+ * traffic fed to them waits while their RTS output is high. Ports built with
+ * the frame check (-DUART_FRAME_CRC=1) get FRAME_CRC bytes closing every
+ * frame, some of them wrong, and must count exactly the wrong ones unless
+ * flow control splits frames. Ports built with RS-485 (-DUART_RS485=1) must
+ * drive DE over every character they send and release it less than one
+ * character time after the last stop bit. Built with LIN (-DUART_LIN=1),
+ * every line is a single wire bus looped back on itself: the harness is
+ * the slave of the master ports, answering their headers with good and bad
+ * checksums or not at all, and the master of the slave ports, sending them
+ * headers with bad sync and parity among them. What every node publishes
+ * must be what it last took, and its counters must match. Built with the
+ * card reader (-DUART_SMARTCARD=1), the USART3 line is a T=0 or T=1 card,
+ * by seed, that answers RST, takes, declines or spoils PPS, and sends NULL,
+ * 6Cxx, 61xx, S(WTX) and blocks with a wrong LRC now and then; the reader
+ * counters must match and what it reads back must be what it wrote.
+ * Built with auto-baud (-DUART_AUTOBAUD=1), USART1 and USART2 are sent to
+ * at a rate picked by seed, after a 0x55 or a character with bit 0 set
+ * that the port measures and does not echo; the first frame follows within
+ * a bit time and the rate set must be within 2 % of the sender.
+ * Built with low power (-DUART_LOW_POWER=1), the main loop must have slept
+ * in WFI; every build prints the time the model spent asleep and the awake
+ * cycles per kilobyte received, to compare configurations.
+ * Usage: sim [seed] [frames per port]
+ */
+
+/* Includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_apm32f10x.h"
+#include "apm32f10x_rcm.h"
+#include "uart_dma.h"
+#include "frame_crc.h"
+#include "crc32.h"
+#include "modbus.h"
+#include "lin.h"
+#include "smartcard.h"
+#include "main.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup SIM_Main_Macros Macros
+  @{
+*/
+
+/* The example is built with -Dmain=APP_Main, this file provides the real one */
+#undef main
+
+/* Longest generated frame */
+#define FUZZ_FRAME_MAX      1500
+
+/* Simulated time a run may take after the last input character or the last one a line drained */
+#define FUZZ_TIMEOUT        (SIM_HCLK / 2)
+
+/* One input character in this many carries a receive error */
+#define FUZZ_ERROR_RATE     512
+
+/* Per tick chance of CTS going high, and of going low again, on a flow controlled port */
+#define FUZZ_CTS_HOLD_RATE      32
+#define FUZZ_CTS_RELEASE_RATE   8
+
+/* One frame in this many gets a wrong check on a port with frameCrc */
+#define FUZZ_CRC_BAD_RATE   16
+
+/* Multi-drop addresses the traffic is spread over */
+#define FUZZ_NODE_NUM       32
+
+/* Built with the Modbus slaves of the example in place of the echo */
+#ifndef UART_MODBUS
+#define UART_MODBUS         0
+#endif
+
+/* Bit times between the end of a response and the next request, t3.5 and a stop bit */
+#define FUZZ_MODBUS_GAP     36
+
+/* Built with the LIN nodes of the example in place of the echo */
+#ifndef UART_LIN
+#define UART_LIN            0
+#endif
+
+/* Frame the harness never answers, one frame in this many gets a wrong checksum */
+#define FUZZ_LIN_SILENT_ID  0x10
+#define FUZZ_LIN_BAD_RATE   16
+
+/* Header parser states on a master line */
+#define FUZZ_LIN_IDLE       0
+#define FUZZ_LIN_SYNC       1
+#define FUZZ_LIN_PID        2
+#define FUZZ_LIN_RESPONSE   3
+
+/* Built with the card reader of the example on USART3 */
+#ifndef UART_SMARTCARD
+#define UART_SMARTCARD      0
+#endif
+
+/* Line of the card, size of its file */
+#define FUZZ_CARD_LINE      SIM_LINE_USART3
+#define FUZZ_CARD_FILE      256
+
+/* One card block in this many gets a wrong LRC, one command a NULL, a 6Cxx or an S(WTX) */
+#define FUZZ_CARD_BAD_RATE  8
+#define FUZZ_CARD_WAIT_RATE 4
+
+/* Longest block the card sends in T=1, shorter than IFSD to chain the responses */
+#define FUZZ_CARD_CHUNK     24
+
+/* Card states */
+#define FUZZ_CARD_OFF       0   /*!< RST low */
+#define FUZZ_CARD_READY     1   /*!< Answer to reset sent */
+#define FUZZ_CARD_PPS       2   /*!< Taking a PPS request */
+#define FUZZ_CARD_HEADER    3   /*!< T=0 taking a command header */
+#define FUZZ_CARD_DATA      4   /*!< T=0 taking command data */
+#define FUZZ_CARD_BLOCK     5   /*!< T=1 taking a block */
+
+#ifndef UART_AUTOBAUD
+#define UART_AUTOBAUD       0
+#endif
+
+#ifndef UART_LOW_POWER
+#define UART_LOW_POWER      0
+#endif
+
+/* Largest auto-baud error of a port against its sender, in 1/10000 */
+#define FUZZ_BAUD_TOLERANCE 200
+
+/* Banner the example sends on its first port */
+#define FUZZ_BANNER         "start test..\r\n"
+
+/**@} end of group SIM_Main_Macros */
+
+/** @defgroup SIM_Main_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Traffic of one line
+ */
+typedef struct
+{
+    uint32_t state;       /*!< xorshift32 state */
+    uint32_t framesLeft;
+    uint32_t bytesLeft;   /*!< Of the frame being fed */
+    uint8_t* expect;      /*!< Bytes the line must send back */
+    uint32_t expectLen;
+    uint32_t sent;        /*!< Bytes sent back so far */
+    uint32_t mismatch;
+    uint32_t frames;
+    uint32_t fe;          /*!< Injected receive errors */
+    uint32_t ne;
+    uint32_t pe;
+    uint8_t  ctsHeld;     /*!< CTS driven high by the harness */
+    uint32_t ctsHolds;
+    uint32_t crc;         /*!< CRC32_Calc() of the frame being fed */
+    uint8_t  crcBad;      /*!< The frame being fed gets a wrong check */
+    uint32_t crcBads;
+    uint8_t  address;     /*!< First byte of the frame being fed, with multiDrop */
+    uint8_t  addressNext; /*!< The address is the next byte to feed */
+    uint8_t  heard;       /*!< The frame being fed wakes the muted receiver */
+    uint8_t  toPort;      /*!< The frame being fed carries the port address */
+    uint32_t drops;       /*!< Frames heard for another address */
+    uint32_t dropBytes;
+    uint8_t  req[MODBUS_ADU_MAX];  /*!< Modbus request being fed */
+    uint16_t reqLen;
+    uint16_t* holding;    /*!< Shadow of the slave holding registers, host order */
+    uint8_t*  coils;      /*!< Shadow of the slave coils, one per byte */
+    MODBUS_Stats_T modbus;  /*!< Counters the slave must show */
+    uint8_t  linState;    /*!< FUZZ_LIN_xxx of the master line sending */
+    uint8_t  linSignals[LIN_DATA_MAX * 2];  /*!< What the node must publish */
+    uint8_t  linExpect[LIN_DATA_MAX + 1];   /*!< Response the node must send */
+    uint8_t  linExpectLen;
+    uint8_t  linSent;
+    uint8_t  linDone;     /*!< Enough headers, counters taken */
+    uint32_t linHeaders;
+    uint64_t linNext;     /*!< Next header to a slave line */
+    LIN_Stats_T lin;      /*!< Counters the node must show */
+    LIN_Stats_T linSeen;  /*!< Counters of a master node when done */
+    uint32_t baudRate;    /*!< Rate of the sender with autoBaud */
+    uint8_t  syncGap;     /*!< Idle bits between the measured character and the first frame */
+} FUZZ_Line_T;
+
+/**
+ * @brief   Card emulated on the card line
+ */
+typedef struct
+{
+    uint8_t  mode;        /*!< FUZZ_CARD_xxx */
+    uint8_t  rst;         /*!< RST level seen last */
+    uint8_t  protocol;    /*!< T the answer to reset lists */
+    uint8_t  ta1;
+    uint8_t  ppsReply;    /*!< 0 to take PPS, 1 to decline it, 2 to answer it wrongly */
+    uint8_t  file[FUZZ_CARD_FILE];
+    uint8_t  in[SC_APDU_MAX + 8];  /*!< Header, data or block being received */
+    uint16_t inLen;
+    uint16_t need;        /*!< Bytes inLen must reach */
+    uint8_t  step;        /*!< T=0 procedure: 0 all data with INS, 1 a byte with ~INS */
+    uint8_t  resent;      /*!< T=0 header already answered with 6Cxx */
+    uint8_t  pending[SC_RESPONSE_MAX];  /*!< T=0 response for GET RESPONSE, T=1 response being chained */
+    uint16_t pendingLen;
+    uint16_t pendingSent;
+    uint8_t  cmd[SC_APDU_MAX];     /*!< T=1 command being chained */
+    uint16_t cmdLen;
+    uint8_t  ns;          /*!< T=1 send sequence number */
+    uint8_t  nr;          /*!< T=1 sequence number expected */
+    uint8_t  last[SC_IFSD + 5];    /*!< T=1 last block sent, for a retransmission */
+    uint16_t lastLen;
+    uint32_t apdus;       /*!< Commands answered */
+    uint32_t target;      /*!< Commands to answer before the counters are taken */
+    uint8_t  done;
+    uint32_t faults;      /*!< Protocol errors of the reader */
+    uint64_t start;       /*!< Time of the first command */
+    uint64_t end;         /*!< Time the counters were taken */
+    uint32_t mismatches;  /*!< Demo compare failures when done */
+    SC_Stats_T expect;    /*!< Counters the reader must show */
+    SC_Stats_T expectDone;  /*!< Counters expected when done */
+    SC_Stats_T seen;      /*!< Counters of the reader when done */
+} FUZZ_Card_T;
+
+/**@} end of group SIM_Main_Structures */
+
+/** @defgroup SIM_Main_Variables Variables
+  @{
+*/
+
+static FUZZ_Line_T fuzzLine[SIM_LINE_NUM];
+static uint64_t    fuzzLastFeed;
+static uint64_t    fuzzFirstFeed;
+static uint64_t    fuzzLastDrain;
+static uint32_t    fuzzPending;
+static uint32_t    fuzzSeed;
+static FUZZ_Card_T fuzzCard;
+
+static const char* const fuzzLineName[SIM_LINE_NUM] =
+{
+    "USART1", "USART2", "USART3", "UART4", "UART5"
+};
+
+/* Sender rates of the auto-baud ports, picked by seed; past 460800 the 512 byte ring
+   of an echo port without flow control overruns on the longest frames */
+static const uint32_t fuzzSyncRate[] = {57600, 100000, 230400, 250000, 460800};
+static const uint32_t fuzzStartRate[] = {38400, 57600, 76800, 115200};
+
+/**@} end of group SIM_Main_Variables */
+
+/** @defgroup SIM_Main_Functions Functions
+  @{
+*/
+
+int APP_Main(void);
+
+/* Ports and echo latency histograms of the example */
+extern UART_DMA_Port_T uartPorts[SIM_LINE_NUM];
+extern UART_DMA_Latency_T echoLatency[SIM_LINE_NUM];
+extern MODBUS_Slave_T modbusSlaves[SIM_LINE_NUM];
+extern LIN_Cluster_T linNodes[SIM_LINE_NUM];
+extern SC_Card_T scReader;
+extern uint32_t cardMismatches;
+extern LowPower_Stats_T lowPower;
+
+/*!
+ * @brief       Next pseudo random number of a line
+ *
+ * @param       line: line traffic
+ *
+ * @retval      Random value
+ */
+static uint32_t FUZZ_Rand(FUZZ_Line_T* line)
+{
+    line->state ^= line->state << 13;
+    line->state ^= line->state >> 17;
+    line->state ^= line->state << 5;
+
+    return line->state;
+}
+
+/*!
+ * @brief       Length of a new frame: mostly short, sometimes longer than the ring
+ *
+ * @param       line: line traffic
+ *
+ * @retval      Frame length
+ */
+static uint32_t FUZZ_FrameLen(FUZZ_Line_T* line)
+{
+    uint32_t r = FUZZ_Rand(line) % 10;
+
+    if (r < 5)
+    {
+        return 1 + FUZZ_Rand(line) % 32;
+    }
+    if (r < 8)
+    {
+        return 33 + FUZZ_Rand(line) % 300;
+    }
+
+    return 333 + FUZZ_Rand(line) % (FUZZ_FRAME_MAX - 332);
+}
+
+/*!
+ * @brief       Modbus CRC-16, bit by bit, independent of the slave table
+ *
+ * @param       data: bytes
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      CRC-16 value
+ */
+static uint16_t FUZZ_Crc16(const uint8_t* data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    uint8_t k;
+
+    while (len--)
+    {
+        crc ^= *data++;
+        for (k = 0; k < 8; k++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+        }
+    }
+
+    return crc;
+}
+
+/*!
+ * @brief       Append a big endian 16 bit field
+ *
+ * @param       buf: frame
+ *
+ * @param       len: frame length, advanced
+ *
+ * @param       value: field
+ *
+ * @retval      None
+ */
+static void FUZZ_Put16(uint8_t* buf, uint16_t* len, uint16_t value)
+{
+    buf[(*len)++] = (uint8_t)(value >> 8);
+    buf[(*len)++] = (uint8_t)value;
+}
+
+/*!
+ * @brief       Build the next Modbus request of a line and the response it must get
+ *
+ * @param       i: line index
+ *
+ * @retval      None
+ */
+static void FUZZ_ModbusRequest(uint8_t i)
+{
+    FUZZ_Line_T* line = &fuzzLine[i];
+    const MODBUS_Slave_T* slave = &modbusSlaves[i];
+    uint8_t* req = line->req;
+    uint8_t* rsp = &line->expect[line->expectLen];
+    uint16_t len = 0;
+    uint16_t rspLen = 0;
+    uint16_t start;
+    uint16_t count;
+    uint16_t value;
+    uint16_t crc;
+    uint16_t k;
+    uint8_t function;
+    uint8_t address = slave->address;
+    uint8_t exception = 0;
+    uint8_t badCrc = 0;
+    uint32_t r = FUZZ_Rand(line) % 16;
+
+    /* Read requests by default, start and count in range */
+    function = MODBUS_FC_READ_HOLDING_REGS;
+    start = FUZZ_Rand(line) % slave->holdingNum;
+    count = 1 + FUZZ_Rand(line) % (slave->holdingNum - start < 125 ? slave->holdingNum - start : 125);
+
+    if (r < 5)
+    {
+        function = MODBUS_FC_READ_HOLDING_REGS;
+    }
+    else if (r == 5)
+    {
+        function = MODBUS_FC_READ_INPUT_REGS;
+    }
+    else if (r < 8)
+    {
+        function = (r == 6) ? MODBUS_FC_READ_COILS : MODBUS_FC_READ_DISCRETE_INPUTS;
+        start = FUZZ_Rand(line) % slave->coilNum;
+        count = 1 + FUZZ_Rand(line) % (slave->coilNum - start);
+    }
+    else if (r < 10)
+    {
+        function = MODBUS_FC_WRITE_REG;
+        count = (uint16_t)FUZZ_Rand(line);
+    }
+    else if (r < 12)
+    {
+        function = MODBUS_FC_WRITE_REGS;
+        count = (count > 123) ? 123 : count;
+    }
+    else if (r == 12)
+    {
+        function = MODBUS_FC_WRITE_COIL;
+        start = FUZZ_Rand(line) % slave->coilNum;
+        count = (FUZZ_Rand(line) & 1) ? 0xFF00 : 0x0000;
+    }
+    else if (r == 13)
+    {
+        function = MODBUS_FC_WRITE_COILS;
+        start = FUZZ_Rand(line) % slave->coilNum;
+        count = 1 + FUZZ_Rand(line) % (slave->coilNum - start);
+    }
+    else
+    {
+        /* Faults: a wrong check, another slave, a broadcast write, out of range, unknown function, zero count */
+        switch (FUZZ_Rand(line) % 6)
+        {
+            case 0:
+                badCrc = 1;
+                break;
+            case 1:
+                address = address + 16;
+                break;
+            case 2:
+                address = MODBUS_BROADCAST;
+                function = MODBUS_FC_WRITE_REG;
+                count = (uint16_t)FUZZ_Rand(line);
+                break;
+            case 3:
+                start = slave->holdingNum - count + 1;
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+                break;
+            case 4:
+                function = 0x2B;
+                exception = MODBUS_EX_ILLEGAL_FUNCTION;
+                break;
+            default:
+                count = 0;
+                exception = MODBUS_EX_ILLEGAL_VALUE;
+                break;
+        }
+    }
+
+    req[len++] = address;
+    req[len++] = function;
+    FUZZ_Put16(req, &len, start);
+    FUZZ_Put16(req, &len, count);
+
+    rsp[rspLen++] = address;
+    rsp[rspLen++] = function;
+
+    if (exception)
+    {
+        rsp[1] |= 0x80;
+        rsp[rspLen++] = exception;
+    }
+    else if ((function == MODBUS_FC_READ_HOLDING_REGS) || (function == MODBUS_FC_READ_INPUT_REGS))
+    {
+        rsp[rspLen++] = 2 * count;
+        for (k = 0; k < count; k++)
+        {
+            value = (function == MODBUS_FC_READ_HOLDING_REGS) ? line->holding[start + k] : start + k;
+            FUZZ_Put16(rsp, &rspLen, value);
+        }
+    }
+    else if ((function == MODBUS_FC_READ_COILS) || (function == MODBUS_FC_READ_DISCRETE_INPUTS))
+    {
+        /* Discrete input byte n reads n */
+        rsp[rspLen++] = (count + 7) / 8;
+        memset(&rsp[rspLen], 0, (count + 7) / 8);
+        for (k = 0; k < count; k++)
+        {
+            value = (function == MODBUS_FC_READ_COILS) ? line->coils[start + k] :
+                    (((start + k) >> 3) >> ((start + k) & 7)) & 1;
+            rsp[rspLen + k / 8] |= value << (k & 7);
+        }
+        rspLen += (count + 7) / 8;
+    }
+    else
+    {
+        /* Writes are answered with the first 6 bytes of the request */
+        rspLen = 6;
+        memcpy(rsp, req, rspLen);
+
+        if (function == MODBUS_FC_WRITE_REG)
+        {
+            line->holding[start] = count;
+        }
+        else if (function == MODBUS_FC_WRITE_COIL)
+        {
+            line->coils[start] = (count != 0);
+        }
+        else if (function == MODBUS_FC_WRITE_REGS)
+        {
+            req[len++] = 2 * count;
+            for (k = 0; k < count; k++)
+            {
+                line->holding[start + k] = (uint16_t)FUZZ_Rand(line);
+                FUZZ_Put16(req, &len, line->holding[start + k]);
+            }
+        }
+        else
+        {
+            req[len++] = (count + 7) / 8;
+            memset(&req[len], 0, (count + 7) / 8);
+            for (k = 0; k < count; k++)
+            {
+                line->coils[start + k] = FUZZ_Rand(line) & 1;
+                req[len + k / 8] |= line->coils[start + k] << (k & 7);
+            }
+            len += (count + 7) / 8;
+        }
+    }
+
+    crc = FUZZ_Crc16(req, len);
+    req[len++] = (uint8_t)crc ^ badCrc;
+    req[len++] = (uint8_t)(crc >> 8);
+    line->reqLen = len;
+    line->bytesLeft = len;
+
+    if (badCrc)
+    {
+        line->modbus.crcErrors++;
+        return;
+    }
+    if ((address != slave->address) && (address != MODBUS_BROADCAST))
+    {
+        line->modbus.others++;
+        return;
+    }
+
+    line->modbus.requests++;
+    if (address == MODBUS_BROADCAST)
+    {
+        line->modbus.broadcasts++;
+        return;
+    }
+
+    crc = FUZZ_Crc16(rsp, rspLen);
+    rsp[rspLen++] = (uint8_t)crc;
+    rsp[rspLen++] = (uint8_t)(crc >> 8);
+    line->expectLen += rspLen;
+    line->modbus.responses++;
+    line->modbus.exceptions += (exception != 0);
+}
+
+/*!
+ * @brief       Feed Modbus requests, each once the response to the one before is back
+ *
+ * @param       i: line index
+ *
+ * @retval      None
+ */
+static void FUZZ_ModbusFeed(uint8_t i)
+{
+    FUZZ_Line_T* line = &fuzzLine[i];
+    uint16_t gap = 0;
+
+    while ((SIM_LinePending(i) < SIM_RX_QUEUE_LEN / 2) &&
+           ((line->bytesLeft != 0) || (line->framesLeft != 0)))
+    {
+        if (line->bytesLeft == 0)
+        {
+            if (line->sent < line->expectLen)
+            {
+                return;
+            }
+
+            FUZZ_ModbusRequest(i);
+            line->framesLeft--;
+            line->frames++;
+            gap = FUZZ_MODBUS_GAP;
+        }
+
+        SIM_LineFeed(i, line->req[line->reqLen - line->bytesLeft], gap);
+        line->bytesLeft--;
+        fuzzLastFeed = simStats.time;
+        gap = 0;
+    }
+}
+
+/*!
+ * @brief       LIN checksum, independent of the node code
+ *
+ * @param       pid: protected identifier, 0 for the classic checksum
+ *
+ * @param       data: response data
+ *
+ * @param       len: number of data bytes
+ *
+ * @retval      Checksum
+ */
+static uint8_t FUZZ_LinChecksum(uint8_t pid, const uint8_t* data, uint8_t len)
+{
+    uint32_t sum = pid;
+
+    while (len--)
+    {
+        sum += *data++;
+    }
+    while (sum > 0xFF)
+    {
+        sum = (sum & 0xFF) + (sum >> 8);
+    }
+
+    return (uint8_t)~sum;
+}
+
+/*!
+ * @brief       Frame of a node for an identifier
+ *
+ * @param       i: line index
+ *
+ * @param       id: frame identifier
+ *
+ * @retval      Frame table entry, NULL if none
+ */
+static const LIN_Frame_T* FUZZ_LinFrame(uint8_t i, uint8_t id)
+{
+    uint8_t k;
+
+    for (k = 0; k < linNodes[i].frameNum; k++)
+    {
+        if (linNodes[i].frames[k].id == id)
+        {
+            return &linNodes[i].frames[k];
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief       Take the response to a header from the harness side
+ *
+ * @param       i: line index
+ *
+ * @param       frame: frame of the header
+ *
+ * @retval      None
+ *
+ * @note        A node that publishes must send what it took last, a node
+ *              that subscribes gets random data and now and then a wrong
+ *              checksum or a response cut short, which it must not take.
+ */
+static void FUZZ_LinResponse(uint8_t i, const LIN_Frame_T* frame)
+{
+    FUZZ_Line_T* line = &fuzzLine[i];
+    uint8_t pid = (frame->classic || (frame->id >= LIN_ID_MASTER_REQUEST)) ? 0 : LIN_PID(frame->id);
+    uint8_t data[LIN_DATA_MAX + 1];
+    uint8_t len = frame->len + 1;
+    uint8_t bad;
+    uint8_t k;
+
+    line->lin.headers++;
+
+    if (frame->direction == LIN_PUBLISH)
+    {
+        memcpy(line->linExpect, &line->linSignals[frame->offset], frame->len);
+        line->linExpect[frame->len] = FUZZ_LinChecksum(pid, line->linExpect, frame->len);
+        line->linExpectLen = frame->len + 1;
+        line->linSent = 0;
+        line->lin.frames++;
+        return;
+    }
+
+    if (frame->id == FUZZ_LIN_SILENT_ID)
+    {
+        line->lin.noResponse++;
+        return;
+    }
+
+    for (k = 0; k < frame->len; k++)
+    {
+        data[k] = (uint8_t)FUZZ_Rand(line);
+    }
+    bad = FUZZ_Rand(line) % FUZZ_LIN_BAD_RATE;
+    data[frame->len] = FUZZ_LinChecksum(pid, data, frame->len) ^ (bad == 0);
+    if (bad == 1)
+    {
+        len = 1 + FUZZ_Rand(line) % frame->len;
+    }
+
+    /* Response space of up to 7 bit times, then back to back */
+    for (k = 0; k < len; k++)
+    {
+        SIM_LineFeed(i, data[k], (k == 0) ? FUZZ_Rand(line) % 8 : 0);
+    }
+    fuzzLastFeed = simStats.time;
+
+    if (bad == 0)
+    {
+        line->lin.checksumErrors++;
+    }
+    else if (bad == 1)
+    {
+        line->lin.incomplete++;
+    }
+    else
+    {
+        memcpy(&line->linSignals[frame->offset], data, frame->len);
+        line->lin.frames++;
+    }
+}
+
+/*!
+ * @brief       Send the next header to a slave line once its slot is over
+ *
+ * @param       i: line index
+ *
+ * @retval      None
+ */
+static void FUZZ_LinFeed(uint8_t i)
+{
+    FUZZ_Line_T* line = &fuzzLine[i];
+    const LIN_Frame_T* frame;
+    uint8_t sync = LIN_SYNC;
+    uint8_t id;
+    uint8_t pid;
+
+    if ((line->framesLeft == 0) || (simStats.time < line->linNext) || SIM_LinePending(i) || SIM_LineBusy(i))
+    {
+        return;
+    }
+
+    /* The response to the last header must be out in full */
+    if ((line->linSent != line->linExpectLen) && (line->mismatch++ == 0))
+    {
+        printf("sim line=%s first mismatch at header %u\n", fuzzLineName[i], line->linHeaders);
+    }
+    line->linExpectLen = 0;
+    line->linSent = 0;
+
+    line->framesLeft--;
+    line->frames++;
+    line->linHeaders++;
+    line->linNext = simStats.time + SIM_HCLK / 100;
+
+    frame = &linNodes[i].frames[FUZZ_Rand(line) % linNodes[i].frameNum];
+    id = frame->id;
+    pid = LIN_PID(id);
+
+    /* Faults: a wrong sync, a wrong parity bit, a frame the node does not know */
+    switch (FUZZ_Rand(line) % 16)
+    {
+        case 0:
+            sync ^= 0x01;
+            line->lin.syncErrors++;
+            frame = NULL;
+            break;
+        case 1:
+            pid ^= 0x80;
+            line->lin.parityErrors++;
+            frame = NULL;
+            break;
+        case 2:
+            pid = LIN_PID(FUZZ_LIN_SILENT_ID);
+            frame = NULL;
+            break;
+        default:
+            break;
+    }
+
+    SIM_LineFeed(i, SIM_CHAR_BREAK, 1 + FUZZ_Rand(line) % 20);
+    SIM_LineFeed(i, sync, FUZZ_Rand(line) % 4);
+    if (sync == LIN_SYNC)
+    {
+        SIM_LineFeed(i, pid, FUZZ_Rand(line) % 4);
+    }
+    fuzzLastFeed = simStats.time;
+
+    if (frame != NULL)
+    {
+        FUZZ_LinResponse(i, frame);
+    }
+}
+
+/*!
+ * @brief       Follow what a LIN line sends
+ *
+ * @param       i: line index
+ *
+ * @param       data: character or SIM_CHAR_BREAK
+ *
+ * @retval      None
+ *
+ * @note        On a master line this answers the headers. Its counters are
+ *              taken at the break after the last header that counts, when
+ *              every frame before it is over.
+ */
+static void FUZZ_LinTx(uint8_t i, uint16_t data)
+{
+    FUZZ_Line_T* line = &fuzzLine[i];
+    const LIN_Frame_T* frame;
+    uint8_t fault = 0;
+
+    if (line->linDone)
+    {
+        return;
+    }
+
+    if (data & SIM_CHAR_BREAK)
+    {
+        fault = !linNodes[i].master || (line->linSent != line->linExpectLen);
+        line->linExpectLen = 0;
+        line->linSent = 0;
+        line->linState = FUZZ_LIN_SYNC;
+
+        if (line->framesLeft == 0)
+        {
+            line->linSeen = linNodes[i].stats;
+            line->linDone = 1;
+        }
+    }
+    else if (line->linSent < line->linExpectLen)
+    {
+        fault = (line->linExpect[line->linSent++] != data);
+    }
+    else if (line->linState == FUZZ_LIN_SYNC)
+    {
+        fault = (data != LIN_SYNC);
+        line->linState = FUZZ_LIN_PID;
+    }
+    else if (line->linState == FUZZ_LIN_PID)
+    {
+        frame = FUZZ_LinFrame(i, data & 0x3F);
+        fault = (frame == NULL) || (data != LIN_PID(data & 0x3F));
+        line->linState = FUZZ_LIN_IDLE;
+        line->linHeaders++;
+        line->framesLeft--;
+        line->frames++;
+        if (!fault)
+        {
+            FUZZ_LinResponse(i, frame);
+        }
+    }
+    else
+    {
+        fault = 1;
+    }
+
+    if (fault && (line->mismatch++ == 0))
+    {
+        printf("sim line=%s first mismatch at header %u\n", fuzzLineName[i], line->linHeaders);
+    }
+}
+
+/*!
+ * @brief       Queue what the card sends
+ *
+ * @param       data: characters
+ *
+ * @param       len: number of characters
+ *
+ * @param       gap: idle bit times before the first one, the guard time of
+ *                   the direction change
+ *
+ * @retval      None
+ */
+static void FUZZ_CardSend(const uint8_t* data, uint16_t len, uint16_t gap)
+{
+    uint16_t k;
+
+    for (k = 0; k < len; k++)
+    {
+        SIM_LineFeed(FUZZ_CARD_LINE, data[k], (k == 0) ? gap : FUZZ_Rand(&fuzzLine[FUZZ_CARD_LINE]) % 2);
+    }
+    fuzzLastFeed = simStats.time;
+}
+
+/*!
+ * @brief       Answer to reset, RST just went high
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_CardReset(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    uint8_t atr[SC_ATR_MAX];
+    uint8_t len = 0;
+    uint8_t tck = 0;
+    uint8_t k;
+
+    card->mode = FUZZ_CARD_READY;
+    card->inLen = 0;
+    card->need = 1;
+    card->resent = 0;
+    card->pendingLen = 0;
+    card->cmdLen = 0;
+    card->ns = 0;
+    card->nr = 0;
+    card->expect.resets++;
+
+    atr[len++] = 0x3B;
+    atr[len++] = 0xD0 | 4;
+    atr[len++] = card->ta1;
+    if (card->protocol == SC_PROTOCOL_T0)
+    {
+        /* TC1 N = 2, TD1 for TC2 WI = 10 */
+        atr[len++] = 0x02;
+        atr[len++] = 0x40;
+        atr[len++] = 10;
+    }
+    else
+    {
+        /* TC1 N = 255, TD1 and TD2 for T=1, TA3 IFSC = 32, TB3 BWI = 4 CWI = 5 */
+        atr[len++] = 0xFF;
+        atr[len++] = 0x81;
+        atr[len++] = 0x31;
+        atr[len++] = 32;
+        atr[len++] = 0x45;
+    }
+    memcpy(&atr[len], "SIMC", 4);
+    len += 4;
+
+    if (card->protocol != SC_PROTOCOL_T0)
+    {
+        for (k = 1; k < len; k++)
+        {
+            tck ^= atr[k];
+        }
+        atr[len++] = tck;
+    }
+
+    FUZZ_CardSend(atr, len, 20);
+}
+
+/*!
+ * @brief       Watch the RST output of the reader
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_CardRst(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    uint8_t rst = GPIO_ReadOutputBit(scReader.rstPort, scReader.rstPin) != 0;
+
+    if (rst == card->rst)
+    {
+        return;
+    }
+
+    card->rst = rst;
+    if (!rst)
+    {
+        card->mode = FUZZ_CARD_OFF;
+        return;
+    }
+
+    /* The clock runs and the USART is in smart card mode before RST goes high */
+    if (!USART3->CTRL2_B.CLKEN || !USART3->CTRL3_B.SCEN)
+    {
+        card->faults++;
+    }
+
+    FUZZ_CardReset();
+}
+
+/*!
+ * @brief       Note the start of a command, take the reader counters once
+ *              enough commands were answered
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_CardCommand(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+
+    if (card->apdus == 0)
+    {
+        card->start = simStats.time;
+    }
+
+    if (!card->done && (card->apdus == card->target))
+    {
+        card->seen = scReader.stats;
+        card->expectDone = card->expect;
+        card->mismatches = cardMismatches;
+        card->end = simStats.time;
+        card->done = 1;
+    }
+}
+
+/*!
+ * @brief       Carry out a command on the card file
+ *
+ * @param       cmd: command APDU
+ *
+ * @param       len: command length
+ *
+ * @param       resp: response APDU
+ *
+ * @retval      Response length
+ *
+ * @note        UPDATE BINARY, READ BINARY, GET CHALLENGE, and INTERNAL
+ *              AUTHENTICATE answering the challenge XOR 0x5A.
+ */
+static uint16_t FUZZ_CardApdu(const uint8_t* cmd, uint16_t len, uint8_t* resp)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    uint16_t offset = (cmd[2] << 8) | cmd[3];
+    uint16_t n = cmd[4] ? cmd[4] : 256;
+    uint16_t rlen = 0;
+    uint16_t k;
+
+    if (((cmd[1] == 0xD6) || (cmd[1] == 0xB0)) && (offset + n > FUZZ_CARD_FILE))
+    {
+        card->faults++;
+        resp[0] = 0x6B;
+        resp[1] = 0x00;
+        return 2;
+    }
+
+    switch (cmd[1])
+    {
+        case 0xD6:
+            memcpy(&card->file[offset], &cmd[5], n);
+            break;
+        case 0xB0:
+            memcpy(resp, &card->file[offset], n);
+            rlen = n;
+            break;
+        case 0x84:
+            for (k = 0; k < n; k++)
+            {
+                resp[k] = (uint8_t)FUZZ_Rand(&fuzzLine[FUZZ_CARD_LINE]);
+            }
+            rlen = n;
+            break;
+        case 0x88:
+            for (k = 0; k < n; k++)
+            {
+                resp[k] = cmd[5 + k] ^ 0x5A;
+            }
+            rlen = n;
+            break;
+        default:
+            card->faults++;
+            resp[0] = 0x6D;
+            resp[1] = 0x00;
+            return 2;
+    }
+
+    (void)len;
+    resp[rlen++] = 0x90;
+    resp[rlen++] = 0x00;
+
+    return rlen;
+}
+
+/*!
+ * @brief       Answer a PPS request
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Takes it, declines it by leaving PPS1 out, or answers with
+ *              a wrong PCK, which costs the reader a warm reset.
+ */
+static void FUZZ_CardPps(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    uint8_t reply[4];
+
+    if ((card->in[1] != (0x10 | card->protocol)) || (card->in[2] != card->ta1) ||
+        ((card->in[0] ^ card->in[1] ^ card->in[2] ^ card->in[3]) != 0))
+    {
+        card->faults++;
+    }
+
+    memcpy(reply, card->in, 4);
+    switch (card->ppsReply)
+    {
+        case 0:
+            card->expect.ppsDone++;
+            FUZZ_CardSend(reply, 4, 12);
+            break;
+        case 1:
+            card->expect.ppsDeclined++;
+            reply[1] &= 0x0F;
+            reply[2] = reply[0] ^ reply[1];
+            FUZZ_CardSend(reply, 3, 12);
+            break;
+        default:
+            card->expect.ppsFailed++;
+            reply[3] ^= 0x01;
+            FUZZ_CardSend(reply, 4, 12);
+            break;
+    }
+
+    card->mode = (card->protocol == SC_PROTOCOL_T0) ? FUZZ_CARD_HEADER : FUZZ_CARD_BLOCK;
+    card->inLen = 0;
+    card->need = (card->protocol == SC_PROTOCOL_T0) ? 5 : 3;
+}
+
+/*!
+ * @brief       Send the next T=0 procedure byte while command data comes in
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Now and then a NULL first, then INS for the rest of the data
+ *              or ~INS for one more byte.
+ */
+static void FUZZ_CardProcedure(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    FUZZ_Line_T* line = &fuzzLine[FUZZ_CARD_LINE];
+    uint8_t out[2];
+    uint8_t len = 0;
+
+    if (FUZZ_Rand(line) % FUZZ_CARD_WAIT_RATE == 0)
+    {
+        out[len++] = 0x60;
+        card->expect.nulls++;
+    }
+
+    card->step = FUZZ_Rand(line) % 2;
+    out[len++] = card->step ? (uint8_t)~card->in[1] : card->in[1];
+    FUZZ_CardSend(out, len, 12);
+}
+
+/*!
+ * @brief       Answer a T=0 command header, or its data once all is in
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_CardT0(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    FUZZ_Line_T* line = &fuzzLine[FUZZ_CARD_LINE];
+    uint8_t resp[SC_RESPONSE_MAX];
+    uint8_t out[2 * SC_RESPONSE_MAX + 2];
+    uint8_t ins = card->in[1];
+    uint16_t outLen = 0;
+    uint16_t rlen;
+    uint16_t k;
+
+    if (card->mode == FUZZ_CARD_HEADER)
+    {
+        if ((ins != 0xC0) && !card->resent)
+        {
+            FUZZ_CardCommand();
+        }
+
+        /* Data to come: take it with procedure bytes */
+        if ((ins == 0xD6) || (ins == 0x88))
+        {
+            card->resent = 0;
+            card->mode = FUZZ_CARD_DATA;
+            card->need = 5 + card->in[4];
+            FUZZ_CardProcedure();
+            return;
+        }
+
+        if (FUZZ_Rand(line) % FUZZ_CARD_WAIT_RATE == 0)
+        {
+            out[outLen++] = 0x60;
+            card->expect.nulls++;
+        }
+
+        if (ins == 0xC0)
+        {
+            if (card->in[4] != card->pendingLen)
+            {
+                card->faults++;
+            }
+            memcpy(resp, card->pending, card->pendingLen);
+            rlen = card->pendingLen;
+            resp[rlen++] = 0x90;
+            resp[rlen++] = 0x00;
+            card->pendingLen = 0;
+        }
+        else if (!card->resent && (FUZZ_Rand(line) % FUZZ_CARD_WAIT_RATE == 0))
+        {
+            /* Wrong Le, the reader sends the header again */
+            card->resent = 1;
+            card->expect.resends++;
+            out[outLen++] = 0x6C;
+            out[outLen++] = card->in[4];
+            FUZZ_CardSend(out, outLen, 12);
+            card->inLen = 0;
+            return;
+        }
+        else
+        {
+            rlen = FUZZ_CardApdu(card->in, 5, resp);
+        }
+        card->resent = 0;
+
+        /* Data after INS in one go, or each byte after ~INS */
+        if ((rlen > 2) && (FUZZ_Rand(line) % 2))
+        {
+            out[outLen++] = ins;
+            memcpy(&out[outLen], resp, rlen - 2);
+            outLen += rlen - 2;
+        }
+        else
+        {
+            for (k = 0; k < rlen - 2; k++)
+            {
+                out[outLen++] = (uint8_t)~ins;
+                out[outLen++] = resp[k];
+            }
+        }
+    }
+    else
+    {
+        rlen = FUZZ_CardApdu(card->in, card->inLen, resp);
+        card->mode = FUZZ_CARD_HEADER;
+        card->need = 5;
+
+        if (ins == 0x88)
+        {
+            /* Response waiting for GET RESPONSE */
+            card->expect.getResponses++;
+            memcpy(card->pending, resp, rlen - 2);
+            card->pendingLen = rlen - 2;
+            out[outLen++] = 0x61;
+            out[outLen++] = (uint8_t)card->pendingLen;
+            FUZZ_CardSend(out, outLen, 12);
+            card->inLen = 0;
+            return;
+        }
+    }
+
+    out[outLen++] = resp[rlen - 2];
+    out[outLen++] = resp[rlen - 1];
+    card->apdus++;
+    card->expect.apdus++;
+    FUZZ_CardSend(out, outLen, 12);
+    card->inLen = 0;
+}
+
+/*!
+ * @brief       Send a T=1 block
+ *
+ * @param       pcb: protocol control byte
+ *
+ * @param       inf: information field
+ *
+ * @param       len: information field length
+ *
+ * @retval      None
+ *
+ * @note        Now and then with a wrong LRC, which the reader answers with
+ *              an R-block asking for it again.
+ */
+static void FUZZ_CardBlock(uint8_t pcb, const uint8_t* inf, uint8_t len)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    uint8_t out[SC_IFSD + 5];
+    uint8_t lrc = 0;
+    uint16_t k;
+
+    card->last[0] = 0;
+    card->last[1] = pcb;
+    card->last[2] = len;
+    memcpy(&card->last[3], inf, len);
+    for (k = 0; k < len + 3u; k++)
+    {
+        lrc ^= card->last[k];
+    }
+    card->last[len + 3] = lrc;
+    card->lastLen = len + 4;
+
+    memcpy(out, card->last, card->lastLen);
+    if (FUZZ_Rand(&fuzzLine[FUZZ_CARD_LINE]) % FUZZ_CARD_BAD_RATE == 0)
+    {
+        out[card->lastLen - 1] ^= 0x01;
+        card->expect.blockErrors++;
+    }
+
+    /* Block guard time 22 etu */
+    FUZZ_CardSend(out, card->lastLen, 22);
+}
+
+/*!
+ * @brief       Send the next I-block of the T=1 response
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_CardChunk(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    uint16_t chunk = card->pendingLen - card->pendingSent;
+    uint8_t more;
+
+    if (chunk > FUZZ_CARD_CHUNK)
+    {
+        chunk = FUZZ_CARD_CHUNK;
+    }
+    more = (card->pendingSent + chunk < card->pendingLen);
+
+    FUZZ_CardBlock((card->ns << 6) | (more << 5), &card->pending[card->pendingSent], (uint8_t)chunk);
+    card->pendingSent += chunk;
+    card->ns ^= 1;
+
+    if (!more)
+    {
+        card->apdus++;
+        card->expect.apdus++;
+    }
+}
+
+/*!
+ * @brief       Answer a T=1 block
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_CardT1(void)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+    uint8_t pcb = card->in[1];
+    uint8_t len = card->in[2];
+    uint8_t wtx = 2;
+    uint8_t lrc = 0;
+    uint16_t k;
+
+    card->inLen = 0;
+    card->need = 3;
+
+    for (k = 0; k < len + 4u; k++)
+    {
+        lrc ^= card->in[k];
+    }
+    if (lrc != 0)
+    {
+        card->faults++;
+        return;
+    }
+
+    if (!(pcb & 0x80))
+    {
+        /* I-block: part of a command, acknowledged while chained */
+        if (((pcb >> 6) & 1) != card->nr)
+        {
+            card->faults++;
+        }
+        if (card->cmdLen == 0)
+        {
+            FUZZ_CardCommand();
+        }
+        memcpy(&card->cmd[card->cmdLen], &card->in[3], len);
+        card->cmdLen += len;
+        card->nr ^= 1;
+
+        if (pcb & 0x20)
+        {
+            FUZZ_CardBlock(0x80 | (card->nr << 4), NULL, 0);
+            return;
+        }
+
+        card->pendingLen = FUZZ_CardApdu(card->cmd, card->cmdLen, card->pending);
+        card->pendingSent = 0;
+        card->cmdLen = 0;
+
+        if (FUZZ_Rand(&fuzzLine[FUZZ_CARD_LINE]) % FUZZ_CARD_WAIT_RATE == 0)
+        {
+            card->expect.waitExtensions++;
+            FUZZ_CardBlock(0xC3, &wtx, 1);
+            return;
+        }
+        FUZZ_CardChunk();
+    }
+    else if ((pcb & 0xC0) == 0x80)
+    {
+        /* R-block: send the last block again, or the next one of the response */
+        if (pcb & 0x0F)
+        {
+            FUZZ_CardSend(card->last, card->lastLen, 22);
+        }
+        else if (card->pendingSent < card->pendingLen)
+        {
+            FUZZ_CardChunk();
+        }
+        else
+        {
+            card->faults++;
+        }
+    }
+    else if (pcb == 0xC1)
+    {
+        FUZZ_CardBlock(0xE1, &card->in[3], len);
+    }
+    else if (pcb == 0xE3)
+    {
+        FUZZ_CardChunk();
+    }
+    else
+    {
+        card->faults++;
+    }
+}
+
+/*!
+ * @brief       Take a character the reader sent to the card
+ *
+ * @param       data: character
+ *
+ * @retval      None
+ */
+static void FUZZ_CardTx(uint16_t data)
+{
+    FUZZ_Card_T* card = &fuzzCard;
+
+    if ((card->mode == FUZZ_CARD_OFF) || (card->inLen >= sizeof(card->in)))
+    {
+        card->faults++;
+        return;
+    }
+
+    card->in[card->inLen++] = (uint8_t)data;
+
+    if (card->mode == FUZZ_CARD_READY)
+    {
+        if (data == 0xFF)
+        {
+            card->mode = FUZZ_CARD_PPS;
+            card->need = 4;
+        }
+        else
+        {
+            card->mode = (card->protocol == SC_PROTOCOL_T0) ? FUZZ_CARD_HEADER : FUZZ_CARD_BLOCK;
+            card->need = (card->protocol == SC_PROTOCOL_T0) ? 5 : 3;
+        }
+    }
+
+    if ((card->mode == FUZZ_CARD_BLOCK) && (card->inLen == 3))
+    {
+        card->need = card->in[2] + 4;
+    }
+
+    if (card->inLen < card->need)
+    {
+        /* ~INS was sent for this byte only */
+        if ((card->mode == FUZZ_CARD_DATA) && card->step)
+        {
+            FUZZ_CardProcedure();
+        }
+        return;
+    }
+
+    switch (card->mode)
+    {
+        case FUZZ_CARD_PPS:
+            FUZZ_CardPps();
+            break;
+        case FUZZ_CARD_BLOCK:
+            FUZZ_CardT1();
+            break;
+        default:
+            FUZZ_CardT0();
+            break;
+    }
+}
+
+/*!
+ * @brief       Keep the receive queue of every line filled
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_Feed(void)
+{
+    FUZZ_Line_T* line;
+    uint16_t flags;
+    uint16_t mark;
+    uint16_t gap;
+    uint8_t data;
+    uint8_t i;
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        line = &fuzzLine[i];
+
+        if (UART_MODBUS)
+        {
+            FUZZ_ModbusFeed(i);
+            continue;
+        }
+
+        if (UART_LIN)
+        {
+            if (!linNodes[i].master)
+            {
+                FUZZ_LinFeed(i);
+            }
+            continue;
+        }
+
+        while ((SIM_LinePending(i) < SIM_RX_QUEUE_LEN / 2) &&
+               ((line->bytesLeft != 0) || (line->framesLeft != 0)))
+        {
+            if (line->bytesLeft == 0)
+            {
+                /* Idle line between frames: at least one character time */
+                line->bytesLeft = FUZZ_FrameLen(line);
+                line->framesLeft--;
+                gap = 12 + FUZZ_Rand(line) % 200;
+
+                if ((uartPorts[i].autoBaud != NULL) && (line->frames == 0))
+                {
+                    /* The character the port measures, the first frame right behind it */
+                    SIM_LineFeed(i, uartPorts[i].autoBaud->sync ? 0x55 : ((FUZZ_Rand(line) & 0xFF) | 0x01), gap);
+                    gap = line->syncGap;
+                }
+                line->frames++;
+                line->heard = 1;
+                line->toPort = 1;
+
+                if (uartPorts[i].multiDrop)
+                {
+                    /* The port address, another one of the same low 4 bits, or any */
+                    switch (FUZZ_Rand(line) % 4)
+                    {
+                        case 0:
+                            line->address = uartPorts[i].address;
+                            break;
+                        case 1:
+                            line->address = uartPorts[i].address ^ 0x10;
+                            break;
+                        default:
+                            line->address = FUZZ_Rand(line) % FUZZ_NODE_NUM;
+                            break;
+                    }
+                    line->addressNext = 1;
+                    line->heard = (((line->address ^ uartPorts[i].address) & 0x0F) == 0);
+                    line->toPort = (line->address == uartPorts[i].address);
+                    line->drops += line->heard && !line->toPort;
+                }
+
+                if (uartPorts[i].frameCrc)
+                {
+                    line->bytesLeft += FRAME_CRC_LEN;
+                    line->crc = 0;
+                    line->crcBad = (FUZZ_Rand(line) % FUZZ_CRC_BAD_RATE == 0);
+                    line->crcBads += line->crcBad && line->toPort;
+                }
+            }
+            else
+            {
+                /* Inside a frame: back to back or a gap too short for IDLE */
+                gap = (FUZZ_Rand(line) % 8 == 0) ? (FUZZ_Rand(line) % 9) : 0;
+            }
+
+            /* Errors keep the data, only the flag is added, the muted receiver flags none */
+            flags = 0;
+            mark = 0;
+            if (line->heard && (FUZZ_Rand(line) % FUZZ_ERROR_RATE == 0))
+            {
+                switch (FUZZ_Rand(line) % 3)
+                {
+                    case 0:
+                        flags = SIM_CHAR_FE;
+                        line->fe++;
+                        break;
+                    case 1:
+                        flags = SIM_CHAR_NE;
+                        line->ne++;
+                        break;
+                    default:
+                        flags = SIM_CHAR_PE;
+                        line->pe++;
+                        break;
+                }
+            }
+
+            if (uartPorts[i].frameCrc && (line->bytesLeft <= FRAME_CRC_LEN))
+            {
+                /* Check bytes least significant first, the last one spoilt in a bad frame */
+                data = (uint8_t)(line->crc >> (8 * (FRAME_CRC_LEN - line->bytesLeft)));
+                if (line->crcBad && (line->bytesLeft == 1))
+                {
+                    data ^= 0x80;
+                }
+            }
+            else
+            {
+                data = (uint8_t)FUZZ_Rand(line);
+                if (line->addressNext)
+                {
+                    /* The address character, ninth bit set */
+                    data = line->address;
+                    mark = 0x100;
+                    line->addressNext = 0;
+                }
+                line->crc = CRC32_Calc(line->crc, &data, 1);
+            }
+
+            SIM_LineFeed(i, mark | data | flags, gap);
+            if (line->toPort)
+            {
+                line->expect[line->expectLen++] = data;
+            }
+            else if (line->heard)
+            {
+                line->dropBytes++;
+            }
+            line->bytesLeft--;
+            fuzzLastFeed = simStats.time;
+        }
+    }
+}
+
+/*!
+ * @brief       Bytes in the receive ring of a port not handed on yet
+ *
+ * @param       i: line index
+ *
+ * @retval      Byte count, e.g. of a frame for another address waiting for
+ *              idle, or of the header a LIN master is sending
+ */
+static uint16_t FUZZ_RxUnread(uint8_t i)
+{
+    const UART_DMA_Port_T* port = &uartPorts[i];
+    uint16_t head = (port->rxChannel != NULL) ? (port->rxRingSize - port->rxChannel->CHNDATA) : port->rxWrite;
+
+    return (head + port->rxRingSize - port->rxRead) % port->rxRingSize;
+}
+
+/*!
+ * @brief       Print the card results
+ *
+ * @param       None
+ *
+ * @retval      1 if the reader counters or the card file went wrong, 0 if not
+ */
+static uint8_t FUZZ_CardReport(void)
+{
+    const FUZZ_Card_T* card = &fuzzCard;
+    const SC_Stats_T* seen = &card->seen;
+    const SC_Stats_T* expect = &card->expectDone;
+    uint32_t pclk1;
+    uint32_t pclk2;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+
+    printf("sim card T=%u ta1=0x%02X pps=%s baud=%u resets=%u/%u pps_done=%u/%u pps_declined=%u/%u "
+           "pps_failed=%u/%u apdus=%u/%u nulls=%u/%u get_responses=%u/%u resends=%u/%u wtx=%u/%u "
+           "block_errors=%u/%u timeouts=%u errors=%u mismatches=%u faults=%u\n",
+           card->protocol, card->ta1, (card->ppsReply == 0) ? "take" : ((card->ppsReply == 1) ? "decline" : "garble"),
+           pclk1 / USART3->BR, seen->resets, expect->resets,
+           seen->ppsDone, expect->ppsDone, seen->ppsDeclined, expect->ppsDeclined,
+           seen->ppsFailed, expect->ppsFailed, seen->apdus, expect->apdus, seen->nulls, expect->nulls,
+           seen->getResponses, expect->getResponses, seen->resends, expect->resends,
+           seen->waitExtensions, expect->waitExtensions, seen->blockErrors, expect->blockErrors,
+           seen->timeouts, seen->errors, card->mismatches, card->faults);
+
+    printf("sim card apdus_per_s=%.1f\n",
+           (card->end > card->start) ? (double)card->target * SIM_HCLK / (card->end - card->start) : 0.0);
+
+    return !card->done || (memcmp(seen, expect, sizeof(*seen)) != 0) || card->mismatches || card->faults;
+}
+
+/*!
+ * @brief       Print the run results and exit
+ *
+ * @param       timeout: 1 if the run did not finish in time
+ *
+ * @retval      None
+ */
+static void FUZZ_Report(uint8_t timeout)
+{
+    UART_DMA_Stats_T stats;
+    DMA_MGR_Stats_T dmaStats;
+    DMA_Channel_T* probe;
+    const MODBUS_Stats_T* slave;
+    const LIN_Stats_T* lin;
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+    uint32_t errors = 0;
+    uint32_t splits;
+    uint32_t baud;
+    uint32_t baudError;
+    uint8_t statsOk;
+    uint8_t i;
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        /* RTS stops the sender inside frames, each extra idle splits one into two failing checks */
+        splits = (simStats.idles[i] > fuzzLine[i].frames) ? (simStats.idles[i] - fuzzLine[i].frames) : 0;
+
+        /* The port counters must match what the line saw */
+        UART_DMA_ReadStats(&uartPorts[i], &stats, 0);
+        /* A LIN break is received as a 0x00 with a framing error, and dropped */
+        statsOk = (stats.framingErrors == fuzzLine[i].fe + stats.breaks) && (stats.breaks == simStats.breaks[i]) && (stats.noiseErrors == fuzzLine[i].ne) &&
+                  (stats.parityErrors == fuzzLine[i].pe) && (stats.overruns == simStats.overruns[i]) &&
+                  (stats.idleEvents == simStats.idles[i]) &&
+                  (stats.rxBytes == simStats.rxChars[i] - simStats.overruns[i] - fuzzLine[i].dropBytes - stats.breaks - FUZZ_RxUnread(i)) &&
+                  (stats.frameDrops == 0) && (stats.addressDrops == fuzzLine[i].drops) &&
+                  (stats.crcErrors >= fuzzLine[i].crcBads) &&
+                  (simStats.overruns[i] || (stats.crcErrors <= fuzzLine[i].crcBads + 2 * splits));
+
+        printf("sim line=%s fe=%u/%u ne=%u/%u pe=%u/%u max_frame=%u ring_high=%u "
+               "rts_holds=%u cts_holds=%u drops=%u crc_errors=%u/%u stats=%s\n",
+               fuzzLineName[i], stats.framingErrors, fuzzLine[i].fe + stats.breaks, stats.noiseErrors, fuzzLine[i].ne,
+               stats.parityErrors, fuzzLine[i].pe, stats.maxFrameLen, stats.ringHighWater,
+               stats.rtsHolds, fuzzLine[i].ctsHolds, stats.frameDrops, stats.crcErrors, fuzzLine[i].crcBads,
+               statsOk ? "ok" : "bad");
+
+        errors += !statsOk;
+        printf("sim line=%s frames=%u rx=%u tx=%u idle=%u ore=%u mismatch=%u missing=%u "
+               "echo_lat_min=%u echo_lat_max=%u\n",
+               fuzzLineName[i], fuzzLine[i].frames, simStats.rxChars[i], simStats.txChars[i],
+               simStats.idles[i], simStats.overruns[i], fuzzLine[i].mismatch,
+               fuzzLine[i].expectLen - fuzzLine[i].sent,
+               echoLatency[i].count ? echoLatency[i].min : 0, echoLatency[i].max);
+
+        if (UART_MODBUS)
+        {
+            slave = &modbusSlaves[i].stats;
+            printf("sim line=%s modbus requests=%u/%u responses=%u/%u exceptions=%u/%u broadcasts=%u/%u "
+                   "crc_errors=%u/%u others=%u/%u overlong=%u\n",
+                   fuzzLineName[i], slave->requests, fuzzLine[i].modbus.requests,
+                   slave->responses, fuzzLine[i].modbus.responses,
+                   slave->exceptions, fuzzLine[i].modbus.exceptions,
+                   slave->broadcasts, fuzzLine[i].modbus.broadcasts,
+                   slave->crcErrors, fuzzLine[i].modbus.crcErrors,
+                   slave->others, fuzzLine[i].modbus.others, slave->overlong);
+
+            errors += memcmp(slave, &fuzzLine[i].modbus, sizeof(*slave)) != 0;
+            transactions += slave->responses;
+        }
+
+        if (UART_LIN)
+        {
+            lin = linNodes[i].master ? &fuzzLine[i].linSeen : &linNodes[i].stats;
+            printf("sim line=%s lin %s headers=%u/%u frames=%u/%u no_response=%u/%u incomplete=%u/%u "
+                   "checksum_errors=%u/%u readback_errors=%u sync_errors=%u/%u parity_errors=%u/%u breaks=%u\n",
+                   fuzzLineName[i], linNodes[i].master ? "master" : "slave",
+                   lin->headers, fuzzLine[i].lin.headers, lin->frames, fuzzLine[i].lin.frames,
+                   lin->noResponse, fuzzLine[i].lin.noResponse, lin->incomplete, fuzzLine[i].lin.incomplete,
+                   lin->checksumErrors, fuzzLine[i].lin.checksumErrors, lin->readbackErrors,
+                   lin->syncErrors, fuzzLine[i].lin.syncErrors, lin->parityErrors, fuzzLine[i].lin.parityErrors,
+                   stats.breaks);
+
+            errors += memcmp(lin, &fuzzLine[i].lin, sizeof(*lin)) != 0;
+            transactions += lin->frames;
+        }
+
+        if (uartPorts[i].multiDrop)
+        {
+            printf("sim line=%s address=%u address_drops=%u/%u drop_bytes=%u muted=%u\n",
+                   fuzzLineName[i], uartPorts[i].address, stats.addressDrops, fuzzLine[i].drops,
+                   fuzzLine[i].dropBytes, simStats.muted[i]);
+        }
+
+        if (uartPorts[i].rs485 != NULL)
+        {
+            printf("sim line=%s de_clipped=%u de_turns=%u de_turn_max=%u char_cycles=%u de_left_on=%u\n",
+                   fuzzLineName[i], simStats.deClipped[i], simStats.deTurns[i], simStats.deTurnMax[i],
+                   SIM_LineCharCycles(i), uartPorts[i].deOn);
+
+            errors += (simStats.deClipped[i] != 0) || (simStats.deTurns[i] == 0) ||
+                      (simStats.deTurnMax[i] >= SIM_LineCharCycles(i)) || uartPorts[i].deOn;
+        }
+
+        if (uartPorts[i].autoBaud != NULL)
+        {
+            baud = UART_DMA_ReadBaudRate(&uartPorts[i]);
+            baudError = (uint32_t)(10000ULL * ((baud > fuzzLine[i].baudRate) ? (baud - fuzzLine[i].baudRate) :
+                                               (fuzzLine[i].baudRate - baud)) / fuzzLine[i].baudRate);
+            printf("sim line=%s autobaud %s rate=%u/%u error=%u.%02u%% sets=%u rejects=%u captures=%u sync_gap=%u\n",
+                   fuzzLineName[i], uartPorts[i].autoBaud->sync ? "0x55" : "start_bit", baud, fuzzLine[i].baudRate,
+                   baudError / 100, baudError % 100, stats.autoBauds, stats.baudRejects, simStats.captures[i],
+                   fuzzLine[i].syncGap);
+
+            /* Five falling edges of 0x55, both edges of a start bit */
+            errors += (baudError > FUZZ_BAUD_TOLERANCE) || (stats.autoBauds != 1) || (stats.baudRejects != 0) ||
+                      (simStats.captures[i] != (uartPorts[i].autoBaud->sync ? 5U : 2U));
+        }
+
+        bytes += simStats.rxChars[i];
+        errors += fuzzLine[i].mismatch + (fuzzLine[i].expectLen - fuzzLine[i].sent);
+    }
+
+    if (UART_LIN)
+    {
+        printf("sim lin frames=%u\n", transactions);
+    }
+
+    if (UART_SMARTCARD)
+    {
+        errors += FUZZ_CardReport();
+    }
+
+    if (UART_MODBUS)
+    {
+        printf("sim modbus transactions=%u per_s=%.0f\n", transactions,
+               (double)transactions * SIM_HCLK / (fuzzLastFeed - fuzzFirstFeed));
+    }
+
+    /* Awake time of the model, and of the main loop as the example measures it */
+    printf("sim power sleeps=%u awake_permille=%llu awake_cycles_per_kb=%llu app_sleeps=%u app_cycles_per_kb=%u\n",
+           simStats.sleeps, (unsigned long long)(1000 * (simStats.time - simStats.sleepCycles) / simStats.time),
+           (unsigned long long)(bytes ? (simStats.time - simStats.sleepCycles) * 1024 / bytes : 0),
+           lowPower.sleeps, low_power_cycles_per_kb());
+
+    if (UART_LOW_POWER && (lowPower.sleeps == 0))
+    {
+        errors++;
+    }
+
+    /* SPI2 RX shares DMA1 channel 4 with USART1 TX, the claim must be refused */
+    probe = DMA_MGR_Claim(DMA_MGR_REQ_SPI2_RX, NULL, NULL, 0);
+    DMA_MGR_ReadStats(&dmaStats, 0);
+    printf("sim dma claims=%u conflicts=%u events=%u unowned=%u probe=%s\n",
+           dmaStats.claims, dmaStats.conflicts, dmaStats.events, dmaStats.unowned,
+           (probe == NULL) ? "refused" : "granted");
+
+    errors += (probe != NULL) || (dmaStats.conflicts != 1) || (dmaStats.unowned != 0);
+
+    printf("sim result=%s seed=%u cycles=%llu irqs=%u storms=%u traps=%u "
+           "traps_per_byte=%.2f isr_host_cycles_per_byte=%.1f bytes_per_isr_host_kcycle=%.2f\n",
+           (errors || timeout || simStats.irqStorms) ? "fail" : "pass", fuzzSeed,
+           (unsigned long long)simStats.time, simStats.irqs, simStats.irqStorms, simStats.traps,
+           bytes ? (double)simStats.traps / bytes : 0.0,
+           bytes ? (double)simStats.isrHostCycles / bytes : 0.0,
+           simStats.isrHostCycles ? 1000.0 * bytes / simStats.isrHostCycles : 0.0);
+
+    fflush(stdout);
+    exit((errors || timeout || simStats.irqStorms) ? 1 : 0);
+}
+
+/*!
+ * @brief       Check a character sent back by a line
+ *
+ * @param       line: SIM_LINE_xxx
+ *
+ * @param       data: character
+ *
+ * @retval      None
+ */
+static void FUZZ_TxHook(uint8_t line, uint16_t data)
+{
+    FUZZ_Line_T* l = &fuzzLine[line];
+
+    if (UART_LIN)
+    {
+        FUZZ_LinTx(line, data);
+        return;
+    }
+
+    if (UART_SMARTCARD && (line == FUZZ_CARD_LINE))
+    {
+        FUZZ_CardTx(data);
+        return;
+    }
+
+    if ((l->sent >= l->expectLen) || (l->expect[l->sent] != (uint8_t)data))
+    {
+        if (l->mismatch++ == 0)
+        {
+            printf("sim line=%s first mismatch at byte %u\n", fuzzLineName[line], l->sent);
+        }
+    }
+
+    l->sent++;
+}
+
+/*!
+ * @brief       Move the CTS input of the flow controlled ports at random
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_Cts(void)
+{
+    const UART_DMA_Flow_T* flow;
+    FUZZ_Line_T* line;
+    uint8_t i;
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        flow = uartPorts[i].flow;
+        line = &fuzzLine[i];
+
+        if ((flow == NULL) || (flow->ctsPort == NULL))
+        {
+            continue;
+        }
+
+        if (FUZZ_Rand(line) % (line->ctsHeld ? FUZZ_CTS_RELEASE_RATE : FUZZ_CTS_HOLD_RATE) == 0)
+        {
+            line->ctsHeld = !line->ctsHeld;
+            line->ctsHolds += line->ctsHeld;
+            SIM_PinSet(flow->ctsPort, flow->ctsPin, line->ctsHeld);
+        }
+    }
+}
+
+/*!
+ * @brief       Called after every model tick
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+static void FUZZ_Tick(void)
+{
+    uint8_t done = 1;
+    uint8_t i;
+    uint32_t pending;
+
+    if (UART_SMARTCARD)
+    {
+        FUZZ_CardRst();
+    }
+
+    /* Start the traffic once the banner, the first LIN header or the latency reset after the last init shows the ports are up */
+    if (UART_LIN ? (fuzzLine[0].linHeaders == 0) :
+        (UART_AUTOBAUD ? (echoLatency[SIM_LINE_NUM - 1].min == 0) : (fuzzLine[0].sent == 0)))
+    {
+        fuzzLastFeed = simStats.time;
+        fuzzFirstFeed = simStats.time;
+        return;
+    }
+
+    FUZZ_Feed();
+    FUZZ_Cts();
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        if (UART_LIN)
+        {
+            /* The masters never stop, a slave line is done one slot after its last header */
+            if (linNodes[i].master ? !fuzzLine[i].linDone : (fuzzLine[i].framesLeft || (simStats.time < fuzzLine[i].linNext)))
+            {
+                done = 0;
+            }
+        }
+        else if (UART_SMARTCARD && (i == FUZZ_CARD_LINE))
+        {
+            /* The card line is done once the reader counters are taken */
+            if (!fuzzCard.done)
+            {
+                done = 0;
+            }
+        }
+        else if (fuzzLine[i].framesLeft || fuzzLine[i].bytesLeft || SIM_LinePending(i) || FUZZ_RxUnread(i) ||
+                 SIM_LineBusy(i) || (fuzzLine[i].sent < fuzzLine[i].expectLen))
+        {
+            done = 0;
+        }
+    }
+
+    if (done)
+    {
+        FUZZ_Report(0);
+    }
+
+    /* Slow lines drain long queues well past the last feed, any progress restarts the timeout */
+    pending = 0;
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        pending += SIM_LinePending(i);
+    }
+    if (pending < fuzzPending)
+    {
+        fuzzLastDrain = simStats.time;
+    }
+    fuzzPending = pending;
+
+    if (simStats.time - ((fuzzLastDrain > fuzzLastFeed) ? fuzzLastDrain : fuzzLastFeed) > FUZZ_TIMEOUT)
+    {
+        FUZZ_Report(1);
+    }
+}
+
+/*!
+ * @brief       Host entry
+ *
+ * @param       argc: argument count
+ *
+ * @param       argv: [seed] [frames per line]
+ *
+ * @retval      0 when every line echoed its input exactly
+ */
+int main(int argc, char* argv[])
+{
+    uint32_t frames = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 100;
+    uint8_t i;
+
+    fuzzSeed = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1;
+
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        fuzzLine[i].state = fuzzSeed * 2654435761U + i + 1;
+        fuzzLine[i].framesLeft = frames;
+        fuzzLine[i].expect = malloc(frames * FUZZ_FRAME_MAX + sizeof(FUZZ_BANNER));
+        fuzzLine[i].holding = calloc(modbusSlaves[i].holdingNum, sizeof(uint16_t));
+        fuzzLine[i].coils = calloc(modbusSlaves[i].coilNum, 1);
+    }
+
+    if (UART_SMARTCARD)
+    {
+        /* T=0 or T=1, a TA1 of 372/12, 512/32 or 372/4, PPS taken, declined or answered wrongly */
+        fuzzCard.protocol = fuzzSeed % 2;
+        fuzzCard.ta1 = (fuzzSeed / 2 % 3 == 0) ? 0x18 : ((fuzzSeed / 2 % 3 == 1) ? 0x96 : 0x13);
+        fuzzCard.ppsReply = fuzzSeed / 6 % 3;
+        fuzzCard.target = frames;
+
+        /* The reader holds the main loop for a whole command, the echo ports get no traffic */
+        for (i = 0; i < SIM_LINE_NUM; i++)
+        {
+            fuzzLine[i].framesLeft = 0;
+        }
+    }
+
+    if (UART_AUTOBAUD)
+    {
+        /* USART1 anywhere up to 921600, USART2 up to 115200, rates the ports do not start at */
+        fuzzLine[0].baudRate = fuzzSyncRate[fuzzSeed % (sizeof(fuzzSyncRate) / sizeof(fuzzSyncRate[0]))];
+        fuzzLine[1].baudRate = fuzzStartRate[fuzzSeed % (sizeof(fuzzStartRate) / sizeof(fuzzStartRate[0]))];
+        for (i = 0; i < 2; i++)
+        {
+            fuzzLine[i].syncGap = (fuzzSeed >> i) & 1;
+            SIM_LineRate(i, fuzzLine[i].baudRate);
+        }
+    }
+
+    if (!UART_LIN && !UART_AUTOBAUD)
+    {
+        memcpy(fuzzLine[0].expect, FUZZ_BANNER, sizeof(FUZZ_BANNER) - 1);
+        fuzzLine[0].expectLen = sizeof(FUZZ_BANNER) - 1;
+    }
+
+    SIM_Init();
+    SIM_SetTxHook(FUZZ_TxHook);
+
+    /* CTS starts asserted, the traffic waits on RTS */
+    for (i = 0; i < SIM_LINE_NUM; i++)
+    {
+        /* A LIN node reads back what it sends on the single wire */
+        if (UART_LIN)
+        {
+            SIM_LineConnect(i, i);
+        }
+
+        if (uartPorts[i].rs485 != NULL)
+        {
+            SIM_LineDriver(i, uartPorts[i].rs485->dePort, uartPorts[i].rs485->dePin);
+        }
+
+        if (uartPorts[i].flow != NULL)
+        {
+            if (uartPorts[i].flow->ctsPort != NULL)
+            {
+                SIM_PinSet(uartPorts[i].flow->ctsPort, uartPorts[i].flow->ctsPin, 0);
+            }
+            if (uartPorts[i].flow->rtsPort != NULL)
+            {
+                SIM_LineFlow(i, uartPorts[i].flow->rtsPort, uartPorts[i].flow->rtsPin);
+            }
+        }
+    }
+
+    /* Two 115200 baud characters per 50 us tick */
+    SIM_Start(2 * 10 * (SIM_HCLK / 115200), 50, FUZZ_Tick);
+
+    return APP_Main();
+}
+
+/**@} end of group SIM_Main_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
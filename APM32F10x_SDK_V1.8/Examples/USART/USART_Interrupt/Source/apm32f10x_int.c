@@ -149,6 +149,7 @@ void DebugMon_Handler(void)
  */
 void PendSV_Handler(void)
 {
+    FRAME_CRC_Isr();
 }
 
 /*!
@@ -173,11 +174,11 @@ void SysTick_Handler(void)
  */
 void USART1_IRQHandler(void)
 {
-    USART1_Isr();
+    UART_DMA_Isr(USART1_IRQn);
 }
 
 /*!
- * @brief   This function handles USART1 Handler
+ * @brief   This function handles USART2 Handler
  *
  * @param   None
  *
@@ -186,8 +187,271 @@ void USART1_IRQHandler(void)
  */
 void USART2_IRQHandler(void)
 {
-    
+    UART_DMA_Isr(USART2_IRQn);
+}
+
+/*!
+ * @brief   This function handles USART3 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void USART3_IRQHandler(void)
+{
+    UART_DMA_Isr(USART3_IRQn);
+}
+
+/*!
+ * @brief   This function handles UART4 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void UART4_IRQHandler(void)
+{
+    UART_DMA_Isr(UART4_IRQn);
+}
+
+/*!
+ * @brief   This function handles UART5 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void UART5_IRQHandler(void)
+{
+    UART_DMA_Isr(UART5_IRQn);
+}
+
+/*!
+ * @brief   This function handles EINT3 Handler, UART5 CTS
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void EINT3_IRQHandler(void)
+{
+    UART_DMA_Isr(EINT3_IRQn);
+}
+
+/*!
+ * @brief   This function handles EINT9_5 Handler, UART4 CTS
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void EINT9_5_IRQHandler(void)
+{
+    UART_DMA_Isr(EINT9_5_IRQn);
+}
+
+/*!
+ * @brief   This function handles TMR1 capture compare Handler, USART1 auto-baud
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void TMR1_CC_IRQHandler(void)
+{
+    UART_DMA_Isr(TMR1_CC_IRQn);
+}
+
+/*!
+ * @brief   This function handles TMR2 Handler, USART2 auto-baud
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void TMR2_IRQHandler(void)
+{
+    UART_DMA_Isr(TMR2_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA1 Channel1 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA1_Channel1_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA1_Channel1_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA1 Channel2 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA1_Channel2_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA1_Channel2_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA1 Channel3 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA1_Channel3_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA1_Channel3_IRQn);
 }
+
+/*!
+ * @brief   This function handles DMA1 Channel4 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA1_Channel4_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA1_Channel4_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA1 Channel5 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA1_Channel5_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA1_Channel5_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA1 Channel6 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA1_Channel6_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA1_Channel6_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA1 Channel7 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA1_Channel7_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA1_Channel7_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA2 Channel1 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA2_Channel1_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA2_Channel1_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA2 Channel2 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA2_Channel2_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA2_Channel2_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA2 Channel3 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA2_Channel3_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA2_Channel3_IRQn);
+}
+
+#if defined (APM32F10X_CL)
+/*!
+ * @brief   This function handles DMA2 Channel4 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA2_Channel4_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA2_Channel4_IRQn);
+}
+
+/*!
+ * @brief   This function handles DMA2 Channel5 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA2_Channel5_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA2_Channel5_IRQn);
+}
+#else
+/*!
+ * @brief   This function handles DMA2 Channel4 and Channel5 Handler
+ *
+ * @param   None
+ *
+ * @retval  None
+ *
+ */
+void DMA2_Channel4_5_IRQHandler(void)
+{
+    DMA_MGR_Isr(DMA2_Channel4_5_IRQn);
+}
+#endif
+
 /**@} end of group USART_Interrupt_INT_Functions */
 /**@} end of group USART_Interrupt */
 /**@} end of group Examples */
@@ -0,0 +1,1279 @@
+/*!
+ * @file        bench.c
+ *
+ * @brief       Throughput and latency benchmark of the echo path
+ *              queued scatter-gather DMA transmit on any number of ports
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Includes */
+#include "main.h"
+#include "bench.h"
+#include "crc32.h"
+#include "dma_chain.h"
+#include "dma_copy.h"
+#include "apm32f10x_crc.h"
+#include "reg_inline.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined (UART_DMA_BENCH)
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup BENCH_Macros Macros
+  @{
+*/
+
+/* Largest frame of the run matrix, half the receive ring keeps frames whole */
+#define BENCH_SIZE_MAX          200
+
+/* Bits of an 8N1 character */
+#define BENCH_CHAR_BITS         10
+
+/* Longest run, in line time of the whole run */
+#define BENCH_TIMEOUT_FACTOR    4
+
+/* Largest input of the CRC comparison */
+#define BENCH_CRC_SIZE_MAX      1024
+
+/* Largest job of the copy comparison */
+#define BENCH_COPY_SIZE_MAX     1024
+
+/* Fill byte of the copy destination outside the job */
+#define BENCH_COPY_GUARD        0xA5
+
+/* Payload words of the chain comparison */
+#define BENCH_CHAIN_PAYLOAD     64
+
+/* Padding words of the chain comparison, one word repeated */
+#define BENCH_CHAIN_PAD         3
+
+/* Reserved address after the AHB peripherals, a DMA read there ends in a bus error */
+#define BENCH_CHAIN_RESERVED    0x40030000
+
+/* Switches timed per line setting and method, the fastest one counts */
+#define BENCH_SWITCH_REPEAT     8
+
+/* Register sequences timed per access method, the fastest one counts */
+#define BENCH_REGS_REPEAT       16
+
+/**@} end of group BENCH_Macros */
+
+/** @defgroup BENCH_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Measurements of the port under test
+ */
+typedef struct
+{
+    uint32_t isrCycles;   /*!< Cycles spent in the port interrupts */
+    uint32_t enterStamp;  /*!< Entry time of the running port interrupt */
+    uint32_t latStamp;    /*!< Entry time of the interrupt that queued a frame */
+    uint8_t  latPending;  /*!< A frame waits for its echo to start */
+    uint32_t latCount;
+    uint32_t latMin;
+    uint32_t latMax;
+    uint64_t latSum;
+} BENCH_Stats_T;
+
+/**
+ * @brief   Line setting of the rate switch comparison
+ */
+typedef struct
+{
+    const char*       format;
+    uint32_t          baudRate;
+    USART_WORD_LEN_T  wordLength;
+    USART_PARITY_T    parity;
+    USART_STOP_BIT_T  stopBits;
+} BENCH_Line_T;
+
+/**@} end of group BENCH_Structures */
+
+/** @defgroup BENCH_Variables Variables
+  @{
+*/
+
+/* Run matrix */
+static const uint32_t benchBaud[] = {115200, 460800, 921600, 2250000};
+static const uint16_t benchSize[] = {1, 8, 64, BENCH_SIZE_MAX};
+static const uint16_t benchCrcSize[] = {1, 3, 8, 16, 64, 256, BENCH_CRC_SIZE_MAX};
+static const uint16_t benchCopySize[] = {8, 16, 32, 64, 128, 256, BENCH_COPY_SIZE_MAX};
+
+/* Rate switch settings, each one is switched to from the one before it */
+static const BENCH_Line_T benchLine[] =
+{
+    {"8N1", 115200,  USART_WORD_LEN_8B, USART_PARITY_NONE, USART_STOP_BIT_1},
+    {"8N1", 921600,  USART_WORD_LEN_8B, USART_PARITY_NONE, USART_STOP_BIT_1},
+    {"8E1", 9600,    USART_WORD_LEN_9B, USART_PARITY_EVEN, USART_STOP_BIT_1},
+    {"8O2", 57600,   USART_WORD_LEN_9B, USART_PARITY_ODD,  USART_STOP_BIT_2},
+    {"8N1", 2250000, USART_WORD_LEN_8B, USART_PARITY_NONE, USART_STOP_BIT_1},
+};
+
+static UART_DMA_Port_T* volatile benchDut;
+static volatile BENCH_Stats_T    benchStats;
+
+/* Generator frame, sent straight from benchPattern */
+static uint8_t            benchPattern[BENCH_SIZE_MAX];
+static UART_DMA_Segment_T benchSegment;
+static UART_DMA_Request_T benchRequest;
+
+/* CRC input, three spare bytes for the unaligned starts */
+static uint8_t            benchCrcData[BENCH_CRC_SIZE_MAX + 3];
+
+/* Copy comparison buffers, three spare bytes for the unaligned starts and one guard byte */
+static uint8_t            benchCopySrc[BENCH_COPY_SIZE_MAX + 3];
+static uint8_t            benchCopyDst[BENCH_COPY_SIZE_MAX + 4];
+static DMA_COPY_Job_T     benchCopyJob;
+
+/* Chain comparison: header, payload, padding and trailer apart, and the same words in one buffer */
+static uint32_t           benchChainHeader[2];
+static uint32_t           benchChainPayload[BENCH_CHAIN_PAYLOAD];
+static uint32_t           benchChainPad;
+static uint32_t           benchChainTrailer;
+static uint32_t           benchChainFlat[2 + BENCH_CHAIN_PAYLOAD + BENCH_CHAIN_PAD + 1];
+static DMA_CHAIN_T        benchChain;
+static volatile uint8_t   benchChainEnded;
+static volatile uint8_t   benchChainError;
+
+/* Addresses of the idle channel of the register and image comparisons, never written by it */
+static uint32_t           benchRegsScratch[2];
+
+/**@} end of group BENCH_Variables */
+
+/** @defgroup BENCH_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Port interrupt entered
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ */
+void BENCH_IsrEnter(UART_DMA_Port_T* port)
+{
+    if (port == benchDut)
+    {
+        benchStats.enterStamp = UART_DMA_TIMESTAMP();
+    }
+}
+
+/*!
+ * @brief       Port interrupt left
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ */
+void BENCH_IsrExit(UART_DMA_Port_T* port)
+{
+    if (port == benchDut)
+    {
+        benchStats.isrCycles += UART_DMA_TIMESTAMP() - benchStats.enterStamp;
+    }
+}
+
+/*!
+ * @brief       Port interrupt queued a received frame
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ */
+void BENCH_RxFrame(UART_DMA_Port_T* port)
+{
+    if ((port == benchDut) && !benchStats.latPending)
+    {
+        benchStats.latStamp = benchStats.enterStamp;
+        benchStats.latPending = 1;
+    }
+}
+
+/*!
+ * @brief       Port starts sending a segment
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ *
+ * @note        Called with interrupts masked or from the port interrupt.
+ */
+void BENCH_TxStart(UART_DMA_Port_T* port)
+{
+    uint32_t lat;
+
+    if ((port != benchDut) || !benchStats.latPending)
+    {
+        return;
+    }
+
+    lat = UART_DMA_TIMESTAMP() - benchStats.latStamp;
+    benchStats.latPending = 0;
+    benchStats.latCount++;
+    benchStats.latSum += lat;
+
+    if (lat < benchStats.latMin)
+    {
+        benchStats.latMin = lat;
+    }
+    if (lat > benchStats.latMax)
+    {
+        benchStats.latMax = lat;
+    }
+}
+
+/*!
+ * @brief       Busy wait
+ *
+ * @param       cycles: core cycles to wait
+ *
+ * @retval      None
+ */
+static void BENCH_Wait(uint32_t cycles)
+{
+    uint32_t start = UART_DMA_TIMESTAMP();
+
+    while (UART_DMA_TIMESTAMP() - start < cycles);
+}
+
+/*!
+ * @brief       Send a result line and wait until it is out
+ *
+ * @param       report: port the results go to
+ *
+ * @param       line: text to send
+ *
+ * @retval      None
+ */
+static void BENCH_Print(UART_DMA_Port_T* report, const char* line)
+{
+    uint16_t len = strlen(line);
+    uint16_t sent = 0;
+
+    while (sent < len)
+    {
+        sent += UART_DMA_Write(report, (const uint8_t*)&line[sent], len - sent);
+    }
+
+    while (report->txFirst != NULL);
+}
+
+/*!
+ * @brief       Reconfigure a port for a new line rate once it has sent everything
+ *
+ * @param       port: UART port
+ *
+ * @param       baud: line rate
+ *
+ * @retval      None
+ */
+static void BENCH_PortConfig(UART_DMA_Port_T* port, uint32_t baud)
+{
+    USART_Config_T usartConfig;
+
+    while ((port->txFirst != NULL) || !USART_ReadStatusFlag(port->usart, USART_FLAG_TXC));
+
+    USART_Disable(port->usart);
+
+    usartConfig.baudRate = baud;
+    usartConfig.hardwareFlow = USART_HARDWARE_FLOW_NONE;
+    usartConfig.mode = USART_MODE_TX_RX;
+    usartConfig.parity = USART_PARITY_NONE;
+    usartConfig.stopBits = USART_STOP_BIT_1;
+    usartConfig.wordLength = USART_WORD_LEN_8B;
+    UART_DMA_Init(port, &usartConfig);
+}
+
+/*!
+ * @brief       Check the echo received by the generator
+ *
+ * @param       gen: generator port
+ *
+ * @param       size: frame size of the run
+ *
+ * @param       rxBytes: echo bytes received so far, advanced
+ *
+ * @retval      Number of wrong bytes
+ */
+static uint32_t BENCH_CheckEcho(UART_DMA_Port_T* gen, uint16_t size, uint32_t* rxBytes)
+{
+    UART_DMA_Frame_T frame;
+    UART_DMA_Segment_T seg[2];
+    uint32_t errors = 0;
+    uint16_t i;
+    uint8_t count;
+    uint8_t n;
+
+    while (UART_DMA_GetFrame(gen, &frame))
+    {
+        count = UART_DMA_FrameSegments(gen, &frame, seg);
+        for (n = 0; n < count; n++)
+        {
+            for (i = 0; i < seg[n].len; i++)
+            {
+                if (seg[n].data[i] != benchPattern[*rxBytes % size])
+                {
+                    errors++;
+                }
+                (*rxBytes)++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+/*!
+ * @brief       Run one line rate and frame size and send its result line
+ *
+ * @param       dut: port under test, echoes with echo_frame()
+ *
+ * @param       gen: generator port, looped back to dut
+ *
+ * @param       report: port the results go to
+ *
+ * @param       baud: line rate of dut and gen
+ *
+ * @param       size: frame size
+ *
+ * @retval      None
+ */
+static void BENCH_Run(UART_DMA_Port_T* dut, UART_DMA_Port_T* gen, UART_DMA_Port_T* report,
+                      uint32_t baud, uint16_t size)
+{
+    UART_DMA_Frame_T echo;
+    char line[320];
+    uint32_t charCycles = SystemCoreClock / baud * BENCH_CHAR_BITS;
+    uint32_t gapCycles = BENCH_GAP_CHARS * charCycles;
+    uint32_t total = (uint32_t)BENCH_FRAMES * size;
+    uint64_t timeout;
+    uint32_t start, now, elapsed, gapStart;
+    uint32_t rxBytes = 0;
+    uint32_t errors = 0;
+    uint32_t sent = 0;
+    uint16_t n;
+    uint8_t gapping = 1;
+
+    BENCH_PortConfig(dut, baud);
+    BENCH_PortConfig(gen, baud);
+
+    /* Let stale idle events of the old line rate pass, then forget them */
+    BENCH_Wait(2 * charCycles);
+    while (UART_DMA_GetFrame(dut, &echo));
+    while (UART_DMA_GetFrame(gen, &echo));
+    echo.len = 0;
+
+    timeout = (uint64_t)BENCH_TIMEOUT_FACTOR * BENCH_FRAMES * (size + BENCH_GAP_CHARS) * charCycles;
+    if (timeout > 0x7FFFFFFF)
+    {
+        timeout = 0x7FFFFFFF;
+    }
+
+    for (n = 0; n < size; n++)
+    {
+        benchPattern[n] = (uint8_t)(n * 37 + size);
+    }
+    benchSegment.data = benchPattern;
+    benchSegment.len = size;
+    benchRequest.segments = &benchSegment;
+    benchRequest.count = 1;
+    benchRequest.callback = NULL;
+
+    __disable_irq();
+    memset((void*)&benchStats, 0, sizeof(benchStats));
+    benchStats.latMin = 0xFFFFFFFF;
+    benchDut = dut;
+    __enable_irq();
+
+    start = UART_DMA_TIMESTAMP();
+    gapStart = start - gapCycles;
+
+    while (rxBytes < total)
+    {
+        now = UART_DMA_TIMESTAMP();
+        if (now - start > (uint32_t)timeout)
+        {
+            break;
+        }
+
+        /* Device under test: the echo path of the example */
+        while ((echo.len != 0) || UART_DMA_GetFrame(dut, &echo))
+        {
+            if (!echo_frame(dut, &echo))
+            {
+                break;
+            }
+        }
+
+        /* Generator: next frame once the line has been idle for the gap */
+        if ((sent < BENCH_FRAMES) && (gen->txFirst == NULL))
+        {
+            if (!gapping && USART_ReadStatusFlag(gen->usart, USART_FLAG_TXC))
+            {
+                gapStart = now;
+                gapping = 1;
+            }
+            else if (gapping && (now - gapStart >= gapCycles))
+            {
+                gapping = 0;
+                sent++;
+                USART_ClearStatusFlag(gen->usart, USART_FLAG_TXC);
+                UART_DMA_Send(gen, &benchRequest);
+            }
+        }
+
+        errors += BENCH_CheckEcho(gen, size, &rxBytes);
+    }
+
+    elapsed = UART_DMA_TIMESTAMP() - start;
+    benchDut = NULL;
+
+    if (rxBytes < total)
+    {
+        errors += total - rxBytes;
+    }
+
+    snprintf(line, sizeof(line),
+             "bench platform=%s baud=%lu size=%u frames=%lu bytes=%lu errors=%lu cycles=%lu "
+             "bytes_per_s=%lu frames_per_s=%lu lat_min=%lu lat_avg=%lu lat_max=%lu "
+             "isr_cycles=%lu isr_permille=%lu\r\n",
+             BENCH_PLATFORM, (unsigned long)baud, size, (unsigned long)(rxBytes / size),
+             (unsigned long)rxBytes, (unsigned long)errors, (unsigned long)elapsed,
+             (unsigned long)((uint64_t)rxBytes * SystemCoreClock / elapsed),
+             (unsigned long)((uint64_t)(rxBytes / size) * SystemCoreClock / elapsed),
+             (unsigned long)(benchStats.latCount ? benchStats.latMin : 0),
+             (unsigned long)(benchStats.latCount ? benchStats.latSum / benchStats.latCount : 0),
+             (unsigned long)benchStats.latMax,
+             (unsigned long)benchStats.isrCycles,
+             (unsigned long)((uint64_t)benchStats.isrCycles * 1000 / elapsed));
+
+    BENCH_Print(report, line);
+}
+
+/*!
+ * @brief       Compare the CRC unit and the software CRC-32 and send a result line per size
+ *
+ * @param       report: port the results go to
+ *
+ * @retval      None
+ *
+ * @note        Every size is computed at the four alignments and, on the
+ *              CRC unit, also in two pieces. Any value that differs from
+ *              the software one counts as an error. Cycles are the average
+ *              of the four alignments.
+ */
+static void BENCH_Crc(UART_DMA_Port_T* report)
+{
+    char line[256];
+    const uint8_t* data;
+    uint32_t hardCycles, softCycles;
+    uint32_t start;
+    uint32_t errors;
+    uint32_t soft, hard;
+    uint16_t size;
+    uint16_t n;
+    uint8_t align;
+    uint8_t s;
+
+    for (n = 0; n < sizeof(benchCrcData); n++)
+    {
+        benchCrcData[n] = (uint8_t)(n * 151 + 7);
+    }
+
+    /* Known value of both paths */
+    errors = 0;
+    while (!CRC32_Claim());
+    if ((CRC32_Hard(0, (const uint8_t*)"123456789", 9) != CRC32_CHECK) ||
+        (CRC32_Soft(0, (const uint8_t*)"123456789", 9) != CRC32_CHECK))
+    {
+        errors++;
+    }
+    CRC32_Release();
+
+    snprintf(line, sizeof(line), "bench crc platform=%s check=0x%08lX errors=%lu\r\n",
+             BENCH_PLATFORM, (unsigned long)CRC32_CHECK, (unsigned long)errors);
+    BENCH_Print(report, line);
+
+    for (s = 0; s < sizeof(benchCrcSize) / sizeof(benchCrcSize[0]); s++)
+    {
+        size = benchCrcSize[s];
+        hardCycles = 0;
+        softCycles = 0;
+        errors = 0;
+
+        for (align = 0; align < 4; align++)
+        {
+            data = &benchCrcData[align];
+
+            start = UART_DMA_TIMESTAMP();
+            soft = CRC32_Soft(0, data, size);
+            softCycles += UART_DMA_TIMESTAMP() - start;
+
+            while (!CRC32_Claim());
+            start = UART_DMA_TIMESTAMP();
+            hard = CRC32_Hard(0, data, size);
+            hardCycles += UART_DMA_TIMESTAMP() - start;
+
+            if (hard != soft)
+            {
+                errors++;
+            }
+
+            /* The second piece goes on from the value of the first */
+            hard = CRC32_Hard(CRC32_Hard(0, data, size / 3), &data[size / 3], size - size / 3);
+            CRC32_Release();
+
+            if (hard != soft)
+            {
+                errors++;
+            }
+        }
+
+        snprintf(line, sizeof(line),
+                 "bench crc platform=%s size=%u hard_cycles=%lu soft_cycles=%lu "
+                 "hard_bytes_per_s=%lu soft_bytes_per_s=%lu errors=%lu\r\n",
+                 BENCH_PLATFORM, size, (unsigned long)(hardCycles / 4), (unsigned long)(softCycles / 4),
+                 (unsigned long)(hardCycles ? (uint64_t)4 * size * SystemCoreClock / hardCycles : 0),
+                 (unsigned long)(softCycles ? (uint64_t)4 * size * SystemCoreClock / softCycles : 0),
+                 (unsigned long)errors);
+        BENCH_Print(report, line);
+    }
+}
+
+/*!
+ * @brief       Fill a USART configuration from a rate switch setting
+ *
+ * @param       setting: line setting
+ *
+ * @param       usartConfig: configuration to fill
+ *
+ * @retval      None
+ */
+static void BENCH_LineConfig(const BENCH_Line_T* setting, USART_Config_T* usartConfig)
+{
+    usartConfig->baudRate = setting->baudRate;
+    usartConfig->hardwareFlow = USART_HARDWARE_FLOW_NONE;
+    usartConfig->mode = USART_MODE_TX_RX;
+    usartConfig->parity = setting->parity;
+    usartConfig->stopBits = setting->stopBits;
+    usartConfig->wordLength = setting->wordLength;
+}
+
+/*!
+ * @brief       Compare rate switches by USART_Config() and by profile
+ *
+ * @param       dut: port switched, idle and initialized again afterwards
+ *
+ * @param       report: port the results go to
+ *
+ * @retval      None
+ *
+ * @note        Cycles are the fewest of BENCH_SWITCH_REPEAT switches from
+ *              the setting before, which leaves out interrupts of the
+ *              other ports. A profile whose BR differs from the one
+ *              USART_Config() writes by more than one 1/16 step, or whose
+ *              format bits differ, counts as an error.
+ */
+static void BENCH_Switch(UART_DMA_Port_T* dut, UART_DMA_Port_T* report)
+{
+    char line[256];
+    UART_DMA_Profile_T profile[sizeof(benchLine) / sizeof(benchLine[0])];
+    USART_Config_T usartConfig[sizeof(benchLine) / sizeof(benchLine[0])];
+    uint32_t configCycles, profileCycles;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t errors;
+    uint32_t br, ctrl1, ctrl2;
+    uint8_t n = sizeof(benchLine) / sizeof(benchLine[0]);
+    uint8_t prev;
+    uint8_t i, r;
+
+    for (i = 0; i < n; i++)
+    {
+        BENCH_LineConfig(&benchLine[i], &usartConfig[i]);
+        UART_DMA_MakeProfile(dut, &usartConfig[i], &profile[i]);
+    }
+
+    while (!UART_DMA_ApplyProfile(dut, &profile[n - 1]));
+
+    for (i = 0; i < n; i++)
+    {
+        prev = (i + n - 1) % n;
+        configCycles = 0xFFFFFFFF;
+        profileCycles = 0xFFFFFFFF;
+
+        for (r = 0; r < BENCH_SWITCH_REPEAT; r++)
+        {
+            USART_Config(dut->usart, &usartConfig[prev]);
+            start = UART_DMA_TIMESTAMP();
+            USART_Config(dut->usart, &usartConfig[i]);
+            cycles = UART_DMA_TIMESTAMP() - start;
+            if (cycles < configCycles)
+            {
+                configCycles = cycles;
+            }
+        }
+
+        br = dut->usart->BR;
+        ctrl1 = dut->usart->CTRL1 & (USART_WORD_LEN_9B | USART_PARITY_ODD);
+        ctrl2 = dut->usart->CTRL2 & USART_STOP_BIT_1_5;
+
+        for (r = 0; r < BENCH_SWITCH_REPEAT; r++)
+        {
+            UART_DMA_ApplyProfile(dut, &profile[prev]);
+            start = UART_DMA_TIMESTAMP();
+            UART_DMA_ApplyProfile(dut, &profile[i]);
+            cycles = UART_DMA_TIMESTAMP() - start;
+            if (cycles < profileCycles)
+            {
+                profileCycles = cycles;
+            }
+        }
+
+        errors = 0;
+        if ((dut->usart->BR + 1 < br) || (dut->usart->BR > br + 1) ||
+            ((dut->usart->CTRL1 & (USART_WORD_LEN_9B | USART_PARITY_ODD)) != ctrl1) ||
+            ((dut->usart->CTRL2 & USART_STOP_BIT_1_5) != ctrl2))
+        {
+            errors++;
+        }
+
+        snprintf(line, sizeof(line),
+                 "bench switch platform=%s baud=%lu format=%s config_cycles=%lu profile_cycles=%lu errors=%lu\r\n",
+                 BENCH_PLATFORM, (unsigned long)benchLine[i].baudRate, benchLine[i].format,
+                 (unsigned long)configCycles, (unsigned long)profileCycles, (unsigned long)errors);
+        BENCH_Print(report, line);
+    }
+}
+
+/*!
+ * @brief       Compare the driver functions and the inline accessors on an interrupt path sequence
+ *
+ * @param       dut: port whose USART and receive pin are read, idle
+ *
+ * @param       report: port the results go to
+ *
+ * @retval      None
+ *
+ * @note        The sequence is what a transmit DMA completion does: a USART
+ *              interrupt flag test, a CHNDATA read, a channel re-arm and a
+ *              pin read. The channel is a spare one with no request source,
+ *              so enabling it moves nothing. Cycles are the fewest of
+ *              BENCH_REGS_REPEAT runs. Results that differ between the two
+ *              methods count as errors.
+ */
+static void BENCH_Regs(UART_DMA_Port_T* dut, UART_DMA_Port_T* report)
+{
+    char line[160];
+    DMA_Channel_T* channel;
+    uint32_t libraryCycles, inlineCycles;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t errors = 0;
+    uint16_t libraryCount, inlineCount;
+    uint8_t libraryFlag, inlineFlag;
+    uint8_t libraryPin, inlinePin;
+    uint8_t r;
+
+    channel = DMA_MGR_Claim(DMA_MGR_REQ_MEM_ANY, NULL, NULL, 0);
+    if (channel == NULL)
+    {
+        return;
+    }
+
+    channel->CHPADDR = (uint32_t)&benchRegsScratch[0];
+    channel->CHMADDR = (uint32_t)&benchRegsScratch[1];
+
+    libraryCycles = 0xFFFFFFFF;
+    inlineCycles = 0xFFFFFFFF;
+
+    for (r = 0; r < BENCH_REGS_REPEAT; r++)
+    {
+        start = UART_DMA_TIMESTAMP();
+        libraryFlag = USART_ReadIntFlag(dut->usart, USART_INT_TXC);
+        libraryCount = DMA_ReadDataNumber(channel);
+        DMA_Disable(channel);
+        channel->CHMADDR = (uint32_t)&benchRegsScratch[1];
+        DMA_ConfigDataNumber(channel, r + 1);
+        DMA_Enable(channel);
+        libraryPin = GPIO_ReadInputBit(dut->rxPort, dut->rxPin);
+        cycles = UART_DMA_TIMESTAMP() - start;
+        if (cycles < libraryCycles)
+        {
+            libraryCycles = cycles;
+        }
+
+        start = UART_DMA_TIMESTAMP();
+        inlineFlag = REG_USART_ReadIntFlag(dut->usart, REG_USART_TXC);
+        inlineCount = REG_DMA_ReadDataNumber(channel);
+        REG_DMA_Rearm(channel, (uint32_t)&benchRegsScratch[1], r + 2);
+        inlinePin = REG_GPIO_ReadInputBit(dut->rxPort, dut->rxPin);
+        cycles = UART_DMA_TIMESTAMP() - start;
+        if (cycles < inlineCycles)
+        {
+            inlineCycles = cycles;
+        }
+
+        /* Each method reads back the count the other one left */
+        if ((libraryFlag != inlineFlag) || (libraryPin != inlinePin) ||
+            (inlineCount != r + 1) || ((r != 0) && (libraryCount != r + 1)))
+        {
+            errors++;
+        }
+    }
+
+    if ((REG_DMA_ReadDataNumber(channel) != BENCH_REGS_REPEAT + 1) ||
+        (channel->CHMADDR != (uint32_t)&benchRegsScratch[1]))
+    {
+        errors++;
+    }
+
+    DMA_MGR_Release(channel);
+
+    snprintf(line, sizeof(line), "bench regs platform=%s library_cycles=%lu inline_cycles=%lu errors=%lu\r\n",
+             BENCH_PLATFORM, (unsigned long)libraryCycles, (unsigned long)inlineCycles, (unsigned long)errors);
+    BENCH_Print(report, line);
+}
+
+/*!
+ * @brief       Compare channel re-arms by DMA_Config() and by DMA_MGR_ApplyImage()
+ *
+ * @param       report: port the results go to
+ *
+ * @retval      None
+ *
+ * @note        A spare channel with no request source is re-armed in turn
+ *              with two setups that differ in every register, by
+ *              DMA_Disable(), DMA_Config() and DMA_Enable(), and from the
+ *              images of the same setups. Cycles are the fewest of
+ *              BENCH_REGS_REPEAT re-arms. A channel left other than its
+ *              image counts as an error.
+ */
+static void BENCH_Image(UART_DMA_Port_T* report)
+{
+    char line[160];
+    DMA_Channel_T* channel;
+    DMA_Config_T dmaConfig[2];
+    DMA_MGR_Image_T image[2];
+    uint32_t configCycles, imageCycles;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t errors = 0;
+    uint8_t i, r;
+
+    channel = DMA_MGR_Claim(DMA_MGR_REQ_MEM_ANY, NULL, NULL, 0);
+    if (channel == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        DMA_ConfigStructInit(&dmaConfig[i]);
+        dmaConfig[i].peripheralBaseAddr = (uint32_t)&benchRegsScratch[i];
+        dmaConfig[i].memoryBaseAddr = (uint32_t)&benchRegsScratch[1 - i];
+        dmaConfig[i].bufferSize = 1 + i;
+        dmaConfig[i].dir = i ? DMA_DIR_PERIPHERAL_DST : DMA_DIR_PERIPHERAL_SRC;
+        dmaConfig[i].memoryInc = i ? DMA_MEMORY_INC_ENABLE : DMA_MEMORY_INC_DISABLE;
+        dmaConfig[i].peripheralDataSize = i ? DMA_PERIPHERAL_DATA_SIZE_WOED : DMA_PERIPHERAL_DATA_SIZE_BYTE;
+        dmaConfig[i].memoryDataSize = i ? DMA_MEMORY_DATA_SIZE_WOED : DMA_MEMORY_DATA_SIZE_BYTE;
+        dmaConfig[i].priority = i ? DMA_PRIORITY_HIGH : DMA_PRIORITY_LOW;
+        DMA_MGR_MakeImage(&dmaConfig[i], 0, &image[i]);
+    }
+
+    configCycles = 0xFFFFFFFF;
+    imageCycles = 0xFFFFFFFF;
+
+    for (r = 0; r < BENCH_REGS_REPEAT; r++)
+    {
+        i = r & 1;
+
+        start = UART_DMA_TIMESTAMP();
+        DMA_Disable(channel);
+        DMA_Config(channel, &dmaConfig[i]);
+        DMA_Enable(channel);
+        cycles = UART_DMA_TIMESTAMP() - start;
+        if (cycles < configCycles)
+        {
+            configCycles = cycles;
+        }
+
+        if ((channel->CHCFG != (image[i].chcfg | REG_DMA_CHCFG_EN)) || (channel->CHNDATA != image[i].chndata) ||
+            (channel->CHPADDR != image[i].chpaddr) || (channel->CHMADDR != image[i].chmaddr))
+        {
+            errors++;
+        }
+
+        i = 1 - i;
+
+        start = UART_DMA_TIMESTAMP();
+        DMA_MGR_ApplyImage(channel, &image[i]);
+        cycles = UART_DMA_TIMESTAMP() - start;
+        if (cycles < imageCycles)
+        {
+            imageCycles = cycles;
+        }
+
+        if ((channel->CHCFG != (image[i].chcfg | REG_DMA_CHCFG_EN)) || (channel->CHNDATA != image[i].chndata) ||
+            (channel->CHPADDR != image[i].chpaddr) || (channel->CHMADDR != image[i].chmaddr))
+        {
+            errors++;
+        }
+    }
+
+    DMA_MGR_Release(channel);
+
+    snprintf(line, sizeof(line),
+             "bench image platform=%s config_cycles=%lu image_cycles=%lu image_ns=%lu errors=%lu\r\n",
+             BENCH_PLATFORM, (unsigned long)configCycles, (unsigned long)imageCycles,
+             (unsigned long)((uint64_t)imageCycles * 1000000000 / SystemCoreClock), (unsigned long)errors);
+    BENCH_Print(report, line);
+}
+
+/*!
+ * @brief       Check a copy or fill job against the source and the guard bytes
+ *
+ * @param       dst: destination offset in benchCopyDst
+ *
+ * @param       src: source, NULL for a fill
+ *
+ * @param       value: fill byte
+ *
+ * @param       size: bytes
+ *
+ * @retval      Number of errors, 0 or 1
+ */
+static uint32_t BENCH_CopyCheck(uint8_t dst, const uint8_t* src, uint8_t value, uint16_t size)
+{
+    uint16_t n;
+
+    if (benchCopyJob.busy || benchCopyJob.error)
+    {
+        return 1;
+    }
+
+    for (n = 0; n < sizeof(benchCopyDst); n++)
+    {
+        if ((n < dst) || (n >= dst + size))
+        {
+            if (benchCopyDst[n] != BENCH_COPY_GUARD)
+            {
+                return 1;
+            }
+        }
+        else if (benchCopyDst[n] != ((src != NULL) ? src[n - dst] : value))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief       Compare memcpy() with DMA_COPY_Copy() and find the crossover size
+ *
+ * @param       report: port the results go to
+ *
+ * @retval      None
+ *
+ * @note        Cycles are of word aligned jobs, the fewest of
+ *              BENCH_REGS_REPEAT. dma_cycles run from the call to the end
+ *              of the job, submit_cycles to the return of the call, when
+ *              the CPU is free again. Every size is also copied at the 16
+ *              source and destination alignments and filled at the four
+ *              destination alignments; a byte that differs, or a guard
+ *              byte written, counts as an error. The smallest size whose
+ *              DMA job ends before memcpy() becomes the service minimum;
+ *              with none the crossover is reported as not_measured and
+ *              DMA_COPY_MIN is kept.
+ */
+static void BENCH_Copy(UART_DMA_Port_T* report)
+{
+    char line[256];
+    DMA_COPY_Stats_T stats;
+    uint32_t cpuCycles, dmaCycles, submitCycles, fillCpuCycles, fillDmaCycles;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t errors;
+    uint32_t crossover = 0;
+    uint16_t size;
+    uint16_t n;
+    uint8_t s, r;
+    uint8_t so, dof;
+
+    for (n = 0; n < sizeof(benchCopySrc); n++)
+    {
+        benchCopySrc[n] = (uint8_t)(n * 73 + 11);
+    }
+
+    benchCopyJob.callback = NULL;
+    benchCopyJob.context = NULL;
+
+    /* Every size on the channel, including the ones below the crossover */
+    DMA_COPY_ConfigMin(0);
+    DMA_COPY_ReadStats(&stats, 1);
+
+    for (s = 0; s < sizeof(benchCopySize) / sizeof(benchCopySize[0]); s++)
+    {
+        size = benchCopySize[s];
+        cpuCycles = dmaCycles = submitCycles = fillCpuCycles = fillDmaCycles = 0xFFFFFFFF;
+        errors = 0;
+
+        for (r = 0; r < BENCH_REGS_REPEAT; r++)
+        {
+            start = UART_DMA_TIMESTAMP();
+            memcpy(benchCopyDst, benchCopySrc, size);
+            cycles = UART_DMA_TIMESTAMP() - start;
+            cpuCycles = (cycles < cpuCycles) ? cycles : cpuCycles;
+
+            start = UART_DMA_TIMESTAMP();
+            DMA_COPY_Copy(&benchCopyJob, benchCopyDst, benchCopySrc, size);
+            cycles = UART_DMA_TIMESTAMP() - start;
+            submitCycles = (cycles < submitCycles) ? cycles : submitCycles;
+            while (!DMA_COPY_Done(&benchCopyJob));
+            cycles = UART_DMA_TIMESTAMP() - start;
+            dmaCycles = (cycles < dmaCycles) ? cycles : dmaCycles;
+
+            start = UART_DMA_TIMESTAMP();
+            memset(benchCopyDst, 0, size);
+            cycles = UART_DMA_TIMESTAMP() - start;
+            fillCpuCycles = (cycles < fillCpuCycles) ? cycles : fillCpuCycles;
+
+            start = UART_DMA_TIMESTAMP();
+            DMA_COPY_Fill(&benchCopyJob, benchCopyDst, 0, size);
+            while (!DMA_COPY_Done(&benchCopyJob));
+            cycles = UART_DMA_TIMESTAMP() - start;
+            fillDmaCycles = (cycles < fillDmaCycles) ? cycles : fillDmaCycles;
+        }
+
+        for (so = 0; so < 4; so++)
+        {
+            for (dof = 0; dof < 4; dof++)
+            {
+                memset(benchCopyDst, BENCH_COPY_GUARD, sizeof(benchCopyDst));
+                DMA_COPY_Copy(&benchCopyJob, &benchCopyDst[dof], &benchCopySrc[so], size);
+                while (!DMA_COPY_Done(&benchCopyJob));
+                errors += BENCH_CopyCheck(dof, &benchCopySrc[so], 0, size);
+            }
+
+            memset(benchCopyDst, BENCH_COPY_GUARD, sizeof(benchCopyDst));
+            DMA_COPY_Fill(&benchCopyJob, &benchCopyDst[so], so + 1, size);
+            while (!DMA_COPY_Done(&benchCopyJob));
+            errors += BENCH_CopyCheck(so, NULL, so + 1, size);
+        }
+
+        if ((crossover == 0) && (dmaCycles < cpuCycles))
+        {
+            crossover = size;
+        }
+
+        snprintf(line, sizeof(line),
+                 "bench copy platform=%s size=%u cpu_cycles=%lu dma_cycles=%lu submit_cycles=%lu "
+                 "fill_cpu_cycles=%lu fill_dma_cycles=%lu errors=%lu\r\n",
+                 BENCH_PLATFORM, size, (unsigned long)cpuCycles, (unsigned long)dmaCycles,
+                 (unsigned long)submitCycles, (unsigned long)fillCpuCycles, (unsigned long)fillDmaCycles,
+                 (unsigned long)errors);
+        BENCH_Print(report, line);
+    }
+
+    DMA_COPY_ReadStats(&stats, 0);
+
+    if (crossover != 0)
+    {
+        DMA_COPY_ConfigMin(crossover);
+        snprintf(line, sizeof(line), "bench copy platform=%s crossover=%lu min=%lu dma_jobs=%lu cpu_jobs=%lu errors=%lu\r\n",
+                 BENCH_PLATFORM, (unsigned long)crossover, (unsigned long)crossover, (unsigned long)stats.dmaJobs,
+                 (unsigned long)stats.cpuJobs, (unsigned long)stats.errors);
+    }
+    else
+    {
+        /* No size was faster on the channel, the build default stays */
+        DMA_COPY_ConfigMin(DMA_COPY_MIN);
+        snprintf(line, sizeof(line), "bench copy platform=%s crossover=not_measured min=%lu dma_jobs=%lu cpu_jobs=%lu errors=%lu\r\n",
+                 BENCH_PLATFORM, (unsigned long)DMA_COPY_MIN, (unsigned long)stats.dmaJobs,
+                 (unsigned long)stats.cpuJobs, (unsigned long)stats.errors);
+    }
+    BENCH_Print(report, line);
+}
+
+/*!
+ * @brief       Chain end callback of the chain comparison
+ *
+ * @param       context: not used
+ *
+ * @param       error: 1 if a transfer error stopped the chain
+ *
+ * @retval      None
+ */
+static void BENCH_ChainEnd(void* context, uint8_t error)
+{
+    (void)context;
+
+    benchChainError = error;
+    benchChainEnded++;
+}
+
+/*!
+ * @brief       Run a chain and wait for its callback
+ *
+ * @param       seg: segments
+ *
+ * @param       count: number of segments
+ *
+ * @retval      Cycles from the start to the callback, 0xFFFFFFFF if the chain did not start
+ */
+static uint32_t BENCH_ChainRun(const DMA_CHAIN_Segment_T* seg, uint8_t count)
+{
+    uint32_t start;
+
+    benchChainEnded = 0;
+    benchChainError = 0;
+    CRC_ResetDATA();
+
+    start = UART_DMA_TIMESTAMP();
+    if (!DMA_CHAIN_Start(&benchChain, seg, count, BENCH_ChainEnd, NULL))
+    {
+        return 0xFFFFFFFF;
+    }
+    while (!benchChainEnded);
+
+    return UART_DMA_TIMESTAMP() - start;
+}
+
+/*!
+ * @brief       Feed a header, payload, padding and trailer lying apart to
+ *              the CRC unit as one DMA chain
+ *
+ * @param       report: port the results go to
+ *
+ * @retval      None
+ *
+ * @note        The controller restarts the peripheral side with every
+ *              segment, so the chain goes to a sink at one address: the
+ *              CRC unit takes each word as it comes and its result must
+ *              equal the CPU feeding the same words from one buffer.
+ *              chain_cycles are the fewest of BENCH_REGS_REPEAT chains,
+ *              cpu_cycles the fewest of the CPU feeding the buffer. A chain
+ *              with a segment in reserved memory must stop there with a
+ *              transfer error and no later word fed, and a chain aborted
+ *              after its header must end without its callback and leave
+ *              no channel event behind. Any other outcome
+ *              counts in errors.
+ */
+static void BENCH_Chain(UART_DMA_Port_T* report)
+{
+    char line[192];
+    DMA_Config_T dmaConfig;
+    DMA_CHAIN_Stats_T stats;
+    DMA_MGR_Stats_T mgrBefore, mgrAfter;
+    DMA_CHAIN_Segment_T seg[5];
+    DMA_CHAIN_Segment_T fault[3];
+    uint32_t chainCycles, cpuCycles;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t crc;
+    uint32_t errors = 0;
+    uint16_t n;
+    uint8_t r;
+
+    DMA_ConfigStructInit(&dmaConfig);
+    dmaConfig.peripheralBaseAddr = (uint32_t)&CRC->DATA;
+    dmaConfig.dir = DMA_DIR_PERIPHERAL_DST;
+    dmaConfig.peripheralInc = DMA_PERIPHERAL_INC_DISABLE;
+    dmaConfig.peripheralDataSize = DMA_PERIPHERAL_DATA_SIZE_WOED;
+    dmaConfig.memoryDataSize = DMA_MEMORY_DATA_SIZE_WOED;
+    dmaConfig.priority = DMA_PRIORITY_LOW;
+    dmaConfig.M2M = DMA_M2MEN_ENABLE;
+
+    /* The chain keeps its channel, the bench never gives it back */
+    if (!DMA_CHAIN_Init(&benchChain, DMA_MGR_REQ_MEM_ANY, &dmaConfig, 0))
+    {
+        return;
+    }
+
+    benchChainHeader[0] = 0x55AA0000 | BENCH_CHAIN_PAYLOAD;
+    benchChainHeader[1] = 0x12345678;
+    for (n = 0; n < BENCH_CHAIN_PAYLOAD; n++)
+    {
+        benchChainPayload[n] = n * 0x9E3779B9 + 1;
+    }
+    benchChainPad = 0xFFFFFFFF;
+    benchChainTrailer = 0xA5A55A5A;
+
+    memcpy(&benchChainFlat[0], benchChainHeader, sizeof(benchChainHeader));
+    memcpy(&benchChainFlat[2], benchChainPayload, sizeof(benchChainPayload));
+    for (n = 0; n < BENCH_CHAIN_PAD; n++)
+    {
+        benchChainFlat[2 + BENCH_CHAIN_PAYLOAD + n] = benchChainPad;
+    }
+    benchChainFlat[2 + BENCH_CHAIN_PAYLOAD + BENCH_CHAIN_PAD] = benchChainTrailer;
+
+    /* An empty segment in the list is skipped */
+    seg[0] = (DMA_CHAIN_Segment_T){.addr = (uint32_t)benchChainHeader, .count = 2, .fixed = 0};
+    seg[1] = (DMA_CHAIN_Segment_T){.addr = (uint32_t)benchChainPayload, .count = BENCH_CHAIN_PAYLOAD, .fixed = 0};
+    seg[2] = (DMA_CHAIN_Segment_T){.addr = (uint32_t)&benchChainPad, .count = 0, .fixed = 1};
+    seg[3] = (DMA_CHAIN_Segment_T){.addr = (uint32_t)&benchChainPad, .count = BENCH_CHAIN_PAD, .fixed = 1};
+    seg[4] = (DMA_CHAIN_Segment_T){.addr = (uint32_t)&benchChainTrailer, .count = 1, .fixed = 0};
+
+    fault[0] = seg[0];
+    fault[1] = (DMA_CHAIN_Segment_T){.addr = BENCH_CHAIN_RESERVED, .count = 4, .fixed = 0};
+    fault[2] = seg[4];
+
+    while (!CRC32_Claim());
+    DMA_CHAIN_ReadStats(&benchChain, &stats, 1);
+
+    /* A transfer error ends the chain, the trailer is never fed */
+    CRC_ResetDATA();
+    crc = CRC_CalculateBlockCRC(benchChainHeader, 2);
+    if ((BENCH_ChainRun(fault, 3) == 0xFFFFFFFF) || !benchChainError || (CRC_ReadCRC() != crc))
+    {
+        errors++;
+    }
+
+    /* Aborted once the header is in, its TC must not reach the next chain */
+    benchChainEnded = 0;
+    CRC_ResetDATA();
+    DMA_MGR_ReadStats(&mgrBefore, 0);
+    __disable_irq();
+    if (!DMA_CHAIN_Start(&benchChain, seg, 5, BENCH_ChainEnd, NULL))
+    {
+        errors++;
+    }
+    while (CRC_ReadCRC() != crc);
+    DMA_CHAIN_Abort(&benchChain);
+    __enable_irq();
+
+    /* Ten microseconds for the interrupt of a flag left behind */
+    BENCH_Wait(SystemCoreClock / 100000);
+    DMA_MGR_ReadStats(&mgrAfter, 0);
+    if (benchChainEnded || (mgrAfter.events != mgrBefore.events))
+    {
+        errors++;
+    }
+
+    CRC_ResetDATA();
+    crc = CRC_CalculateBlockCRC(benchChainFlat, sizeof(benchChainFlat) / sizeof(benchChainFlat[0]));
+
+    chainCycles = cpuCycles = 0xFFFFFFFF;
+    for (r = 0; r < BENCH_REGS_REPEAT; r++)
+    {
+        cycles = BENCH_ChainRun(seg, 5);
+        chainCycles = (cycles < chainCycles) ? cycles : chainCycles;
+        if ((cycles == 0xFFFFFFFF) || benchChainError || (CRC_ReadCRC() != crc))
+        {
+            errors++;
+        }
+
+        start = UART_DMA_TIMESTAMP();
+        CRC_ResetDATA();
+        CRC_CalculateBlockCRC(benchChainFlat, sizeof(benchChainFlat) / sizeof(benchChainFlat[0]));
+        cycles = UART_DMA_TIMESTAMP() - start;
+        cpuCycles = (cycles < cpuCycles) ? cycles : cpuCycles;
+    }
+
+    CRC32_Release();
+
+    /* Every chain but the aborted one ran all its segments, the faulty one two */
+    DMA_CHAIN_ReadStats(&benchChain, &stats, 0);
+    if ((stats.chains != BENCH_REGS_REPEAT + 2) || (stats.errors != 1))
+    {
+        errors++;
+    }
+
+    snprintf(line, sizeof(line),
+             "bench chain platform=%s words=%u segments=%lu chain_cycles=%lu cpu_cycles=%lu "
+             "transfer_errors=%lu errors=%lu\r\n",
+             BENCH_PLATFORM, (unsigned int)(sizeof(benchChainFlat) / sizeof(benchChainFlat[0])),
+             (unsigned long)stats.segments, (unsigned long)chainCycles, (unsigned long)cpuCycles,
+             (unsigned long)stats.errors, (unsigned long)errors);
+    BENCH_Print(report, line);
+}
+
+/*!
+ * @brief       Run the benchmark matrix, never returns
+ *
+ * @param       dut: port under test, its receive pin wired to the gen transmit pin
+ *
+ * @param       gen: generator port, its receive pin wired to the dut transmit pin
+ *
+ * @param       report: port the result lines are sent on
+ *
+ * @retval      None
+ *
+ * @note        Latencies are core cycles from the entry of the interrupt that
+ *              queued a frame to the start of its echo. The CPU load counts
+ *              the cycles spent in the port interrupts of dut.
+ */
+void BENCH_Main(UART_DMA_Port_T* dut, UART_DMA_Port_T* gen, UART_DMA_Port_T* report)
+{
+    char line[128];
+    uint8_t b, s;
+
+    snprintf(line, sizeof(line), "bench start platform=%s lib=0x%08lX hclk=%lu frames=%u\r\n",
+             BENCH_PLATFORM, (unsigned long)__APM32F10X_STDPERIPH_VERSION,
+             (unsigned long)SystemCoreClock, BENCH_FRAMES);
+    BENCH_Print(report, line);
+
+    CRC32_Init();
+    BENCH_Crc(report);
+    BENCH_Switch(dut, report);
+    BENCH_Regs(dut, report);
+    BENCH_Image(report);
+
+    DMA_COPY_Init(0);
+    BENCH_Copy(report);
+    BENCH_Chain(report);
+
+    for (b = 0; b < sizeof(benchBaud) / sizeof(benchBaud[0]); b++)
+    {
+        for (s = 0; s < sizeof(benchSize) / sizeof(benchSize[0]); s++)
+        {
+            BENCH_Run(dut, gen, report, benchBaud[b], benchSize[s]);
+        }
+    }
+
+    snprintf(line, sizeof(line), "bench end runs=%u\r\n",
+             (unsigned int)(sizeof(benchBaud) / sizeof(benchBaud[0]) * sizeof(benchSize) / sizeof(benchSize[0])));
+    BENCH_Print(report, line);
+
+    while (1)
+    {
+        __WFI();
+    }
+}
+
+/**@} end of group BENCH_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
+
+#endif /* UART_DMA_BENCH */
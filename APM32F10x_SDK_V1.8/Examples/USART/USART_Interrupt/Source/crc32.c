@@ -0,0 +1,321 @@
+/*!
+ * @file        crc32.c
+ *
+ * @brief       Standard CRC-32 over bytes, on the CRC unit or in software
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * The CRC unit shifts each 32 bit data word in most significant bit first,
+ * with the non reflected polynomial and no final XOR. The standard CRC-32
+ * (Ethernet, zlib) takes bytes least significant bit first, so a word of
+ * four bytes is bit reversed with __RBIT() before it is written and the
+ * register read back is bit reversed into the reflected state. Bytes before
+ * the first word boundary and after the last whole word are taken in
+ * software by the same table as CRC32_Soft(), so both give the same value
+ * for any length and alignment.
+ */
+
+/* Includes */
+#include "crc32.h"
+#include "apm32f10x_crc.h"
+#include "apm32f10x_rcm.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup CRC32_Macros Macros
+  @{
+*/
+
+/* Polynomial of the CRC unit, most significant bit first */
+#define CRC32_POLY              0x04C11DB7
+
+/**@} end of group CRC32_Macros */
+
+/** @defgroup CRC32_Variables Variables
+  @{
+*/
+
+/*
+ * Slicing-by-8 tables, crcTable[k][n] is the state after byte n followed by
+ * k zero bytes. Built by CRC32_Init() in SRAM, which has no flash wait states.
+ */
+static uint32_t crcTable[8][256];
+
+/* Unit claimed by CRC32_Calc() or a CRC32_Claim() caller */
+static volatile uint8_t crcOwned;
+
+/**@} end of group CRC32_Variables */
+
+/** @defgroup CRC32_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Enable the CRC unit and build the software tables
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+void CRC32_Init(void)
+{
+    uint32_t crc;
+    uint16_t n;
+    uint8_t k;
+
+#if !defined (CRC32_SOFTWARE)
+    RCM_EnableAHBPeriphClock(RCM_AHB_PERIPH_CRC);
+#endif
+
+    for (n = 0; n < 256; n++)
+    {
+        crc = n;
+        for (k = 0; k < 8; k++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ CRC32_POLY_REFLECTED) : (crc >> 1);
+        }
+        crcTable[0][n] = crc;
+    }
+
+    for (n = 0; n < 256; n++)
+    {
+        for (k = 1; k < 8; k++)
+        {
+            crcTable[k][n] = (crcTable[k - 1][n] >> 8) ^ crcTable[0][crcTable[k - 1][n] & 0xFF];
+        }
+    }
+}
+
+/*!
+ * @brief       Compute the standard CRC-32 of a byte sequence
+ *
+ * @param       crc: 0, or the value returned for the bytes before
+ *
+ * @param       data: bytes, any alignment
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      CRC-32 value
+ *
+ * @note        Runs on the CRC unit when it is free and len is at least
+ *              CRC32_HARD_MIN, in software otherwise. Both give the same value.
+ */
+uint32_t CRC32_Calc(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+#if !defined (CRC32_SOFTWARE)
+    if ((len >= CRC32_HARD_MIN) && CRC32_Claim())
+    {
+        crc = CRC32_Hard(crc, data, len);
+        CRC32_Release();
+        return crc;
+    }
+#endif
+
+    return CRC32_Soft(crc, data, len);
+}
+
+/*!
+ * @brief       Compute the standard CRC-32 of a byte sequence in software
+ *
+ * @param       crc: 0, or the value returned for the bytes before
+ *
+ * @param       data: bytes, any alignment
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      CRC-32 value
+ *
+ * @note        Eight bytes per step, the words are read little endian.
+ */
+uint32_t CRC32_Soft(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+    const uint32_t* word;
+    uint32_t one, two;
+
+    crc = ~crc;
+
+    while ((len != 0) && ((uint32_t)data & 3))
+    {
+        crc = (crc >> 8) ^ crcTable[0][(crc ^ *data++) & 0xFF];
+        len--;
+    }
+
+    word = (const uint32_t*)data;
+    while (len >= 8)
+    {
+        one = *word++ ^ crc;
+        two = *word++;
+        crc = crcTable[7][one & 0xFF] ^ crcTable[6][(one >> 8) & 0xFF] ^
+              crcTable[5][(one >> 16) & 0xFF] ^ crcTable[4][one >> 24] ^
+              crcTable[3][two & 0xFF] ^ crcTable[2][(two >> 8) & 0xFF] ^
+              crcTable[1][(two >> 16) & 0xFF] ^ crcTable[0][two >> 24];
+        len -= 8;
+    }
+    data = (const uint8_t*)word;
+
+    while (len--)
+    {
+        crc = (crc >> 8) ^ crcTable[0][(crc ^ *data++) & 0xFF];
+    }
+
+    return ~crc;
+}
+
+#if !defined (CRC32_SOFTWARE)
+/*!
+ * @brief       Undo the 32 shifts of one CRC data word
+ *
+ * @param       crc: register value
+ *
+ * @retval      Register value before the shifts
+ */
+static uint32_t CRC32_Unshift(uint32_t crc)
+{
+    uint8_t i;
+
+    for (i = 0; i < 32; i++)
+    {
+        crc = (crc & 1) ? (((crc ^ CRC32_POLY) >> 1) | 0x80000000) : (crc >> 1);
+    }
+
+    return crc;
+}
+#endif
+
+/*!
+ * @brief       Compute the standard CRC-32 of a byte sequence on the CRC unit
+ *
+ * @param       crc: 0, or the value returned for the bytes before
+ *
+ * @param       data: bytes, any alignment
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      CRC-32 value
+ *
+ * @note        The caller holds the unit, see CRC32_Claim(). A crc other
+ *              than 0 or an unaligned start costs one extra data word,
+ *              which loads the register with the state so far.
+ */
+uint32_t CRC32_Hard(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+#if defined (CRC32_SOFTWARE)
+    return CRC32_Soft(crc, data, len);
+#else
+    const uint32_t* word;
+    uint32_t n;
+
+    crc = ~crc;
+
+    while ((len != 0) && ((uint32_t)data & 3))
+    {
+        crc = (crc >> 8) ^ crcTable[0][(crc ^ *data++) & 0xFF];
+        len--;
+    }
+
+    if (len >= 4)
+    {
+        CRC_ResetDATA();
+
+        /* The one data word that brings the register from its reset value to the state */
+        if (crc != 0xFFFFFFFF)
+        {
+            CRC->DATA = ~CRC32_Unshift(__RBIT(crc));
+        }
+
+        word = (const uint32_t*)data;
+        for (n = len >> 2; n >= 4; n -= 4)
+        {
+            CRC->DATA = __RBIT(word[0]);
+            CRC->DATA = __RBIT(word[1]);
+            CRC->DATA = __RBIT(word[2]);
+            CRC->DATA = __RBIT(word[3]);
+            word += 4;
+        }
+        while (n--)
+        {
+            CRC->DATA = __RBIT(*word++);
+        }
+
+        crc = __RBIT(CRC_ReadCRC());
+        data = (const uint8_t*)word;
+        len &= 3;
+    }
+
+    while (len--)
+    {
+        crc = (crc >> 8) ^ crcTable[0][(crc ^ *data++) & 0xFF];
+    }
+
+    return ~crc;
+#endif
+}
+
+/*!
+ * @brief       Take the CRC unit for CRC32_Hard() calls
+ *
+ * @param       None
+ *
+ * @retval      1 if the unit was free and is now held, 0 otherwise
+ *
+ * @note        CRC32_Calc() runs in software while the unit is held.
+ */
+uint8_t CRC32_Claim(void)
+{
+    uint32_t primask;
+    uint8_t claimed = 0;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (!crcOwned)
+    {
+        crcOwned = 1;
+        claimed = 1;
+    }
+
+    __set_PRIMASK(primask);
+
+    return claimed;
+}
+
+/*!
+ * @brief       Give the CRC unit back
+ *
+ * @param       None
+ *
+ * @retval      None
+ */
+void CRC32_Release(void)
+{
+    crcOwned = 0;
+}
+
+/**@} end of group CRC32_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
@@ -0,0 +1,279 @@
+/*!
+ * @file        dma_chain.c
+ *
+ * @brief       DMA transfer chains: segment lists re-armed from the TC interrupt
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * A chain is a list of segments run on one claimed channel as if it were a
+ * single transfer: header, payload and trailer straight from where they
+ * lie, or a ring buffer region that wraps. The channel configuration is
+ * built once by DMA_MGR_MakeImage(), so putting the next segment on the
+ * channel in the TC interrupt is four register writes with no
+ * read-modify-write of the bit fields.
+ */
+
+/* Includes */
+#include "dma_chain.h"
+#include "reg_inline.h"
+#include <string.h>
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup DMA_CHAIN_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Put a segment on the stopped channel and start it
+ *
+ * @param       chain: chain
+ *
+ * @param       seg: segment with a count above 0
+ *
+ * @retval      None
+ *
+ * @note        CHNDATA only takes a value with the channel off, so CHCFG is
+ *              written twice. Whole register writes, no read-modify-write.
+ */
+static void DMA_CHAIN_Arm(DMA_CHAIN_T* chain, const DMA_CHAIN_Segment_T* seg)
+{
+    DMA_Channel_T* channel = chain->channel;
+
+    channel->CHCFG = chain->cfg;
+    channel->CHMADDR = seg->addr;
+    channel->CHNDATA = seg->count;
+    channel->CHCFG = chain->cfg | (seg->fixed ? 0 : REG_DMA_CHCFG_MINC) | REG_DMA_CHCFG_EN;
+
+    chain->seg = seg;
+    chain->stats.segments++;
+}
+
+/*!
+ * @brief       Channel events of a chain
+ *
+ * @param       context: chain
+ *
+ * @param       events: DMA_MGR_EVENT_TC or DMA_MGR_EVENT_TERR
+ *
+ * @retval      None
+ */
+static void DMA_CHAIN_Event(void* context, uint8_t events)
+{
+    DMA_CHAIN_T* chain = (DMA_CHAIN_T*)context;
+    const DMA_CHAIN_Segment_T* seg = chain->seg;
+    uint8_t error = (events & DMA_MGR_EVENT_TERR) ? 1 : 0;
+
+    if (!chain->busy)
+    {
+        return;
+    }
+
+    if (!error)
+    {
+        /* The next segment goes on first, the gap is what the peripheral sees */
+        while (++seg < chain->end)
+        {
+            if (seg->count != 0)
+            {
+                DMA_CHAIN_Arm(chain, seg);
+                return;
+            }
+        }
+    }
+    else
+    {
+        /* The channel stopped itself, the rest of the chain is given up */
+        chain->channel->CHCFG = chain->cfg;
+        chain->stats.errors++;
+    }
+
+    chain->busy = 0;
+    chain->callback(chain->context, error);
+}
+
+/*!
+ * @brief       Claim and set up the channel of a chain
+ *
+ * @param       chain: chain
+ *
+ * @param       request: DMA_MGR_REQ_xxx of the peripheral, or DMA_MGR_REQ_MEM(id)
+ *                       or DMA_MGR_REQ_MEM_ANY for memory to memory
+ *
+ * @param       dmaConfig: peripheral address, direction, data sizes, priority
+ *                         and M2M; the memory fields and loopMode are not used
+ *
+ * @param       priority: NVIC preemption priority of the channel IRQ
+ *
+ * @retval      1 if the channel was claimed, 0 if another driver has it
+ */
+uint8_t DMA_CHAIN_Init(DMA_CHAIN_T* chain, uint16_t request, const DMA_Config_T* dmaConfig, uint8_t priority)
+{
+    DMA_Config_T config = *dmaConfig;
+    DMA_MGR_Image_T image;
+
+    chain->busy = 0;
+    memset(&chain->stats, 0, sizeof(chain->stats));
+
+    chain->channel = DMA_MGR_Claim(request, DMA_CHAIN_Event, chain, priority);
+    if (chain->channel == NULL)
+    {
+        return 0;
+    }
+
+    config.memoryBaseAddr = 0;
+    config.bufferSize = 0;
+    config.memoryInc = DMA_MEMORY_INC_DISABLE;
+    config.loopMode = DMA_MODE_NORMAL;
+    DMA_MGR_MakeImage(&config, DMA_MGR_EVENT_TC | DMA_MGR_EVENT_TERR, &image);
+
+    /* The segments only change the memory side */
+    chain->cfg = image.chcfg;
+    chain->channel->CHPADDR = image.chpaddr;
+
+    return 1;
+}
+
+/*!
+ * @brief       Start a chain of segments
+ *
+ * @param       chain: chain set up with DMA_CHAIN_Init()
+ *
+ * @param       seg: segments, left alone by the caller until the callback
+ *
+ * @param       count: number of segments
+ *
+ * @param       callback: run from the channel IRQ when the chain ends
+ *
+ * @param       context: passed to callback
+ *
+ * @retval      1 if the chain was started, 0 if the channel is busy or was not claimed
+ *
+ * @note        A chain with no data at all ends at once, callback runs
+ *              before the function returns.
+ */
+uint8_t DMA_CHAIN_Start(DMA_CHAIN_T* chain, const DMA_CHAIN_Segment_T* seg, uint8_t count,
+                        DMA_CHAIN_Callback_T callback, void* context)
+{
+    const DMA_CHAIN_Segment_T* end = seg + count;
+    uint32_t primask;
+
+    while ((seg < end) && (seg->count == 0))
+    {
+        seg++;
+    }
+
+    /* Callers in different interrupts may share a chain */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if ((chain->channel == NULL) || chain->busy)
+    {
+        __set_PRIMASK(primask);
+        return 0;
+    }
+
+    chain->stats.chains++;
+
+    if (seg == end)
+    {
+        __set_PRIMASK(primask);
+        callback(context, 0);
+        return 1;
+    }
+
+    chain->end = end;
+    chain->callback = callback;
+    chain->context = context;
+    chain->busy = 1;
+    DMA_CHAIN_Arm(chain, seg);
+
+    __set_PRIMASK(primask);
+
+    return 1;
+}
+
+/*!
+ * @brief       Stop a running chain without its callback
+ *
+ * @param       chain: chain set up with DMA_CHAIN_Init()
+ *
+ * @retval      None
+ *
+ * @note        The flags of the channel are cleared with it, a TC left
+ *              pending would end the first segment of the next chain.
+ */
+void DMA_CHAIN_Abort(DMA_CHAIN_T* chain)
+{
+    uint32_t primask;
+
+    if (chain->channel == NULL)
+    {
+        return;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    chain->channel->CHCFG = chain->cfg;
+    DMA_MGR_ClearFlags(chain->channel);
+    chain->busy = 0;
+
+    __set_PRIMASK(primask);
+}
+
+/*!
+ * @brief       Read the counters of a chain
+ *
+ * @param       chain: chain set up with DMA_CHAIN_Init()
+ *
+ * @param       stats: copy of the counters
+ *
+ * @param       clear: 1 to reset the counters after the copy
+ *
+ * @retval      None
+ */
+void DMA_CHAIN_ReadStats(DMA_CHAIN_T* chain, DMA_CHAIN_Stats_T* stats, uint8_t clear)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    *stats = chain->stats;
+    if (clear)
+    {
+        memset(&chain->stats, 0, sizeof(chain->stats));
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**@} end of group DMA_CHAIN_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
@@ -0,0 +1,391 @@
+/*!
+ * @file        dma_copy.c
+ *
+ * @brief       Asynchronous memcpy and memset on a memory to memory DMA channel
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * Copies and fills are queued as jobs on one memory to memory channel and
+ * run one after the other, the caller goes on and learns of the end from
+ * the job callback or DMA_COPY_Done(). The channel moves words when the
+ * source and destination allow it: bytes before the first aligned address
+ * and after the last whole word are moved by the CPU at submit time, so
+ * only the aligned middle waits for the DMA. Short jobs, and all jobs when
+ * no channel could be claimed, run on the CPU at once. The channel has the
+ * lowest DMA priority, a peripheral request of another channel is served
+ * between two of its transfers.
+ */
+
+/* Includes */
+#include "dma_copy.h"
+#include <string.h>
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup DMA_COPY_Macros Macros
+  @{
+*/
+
+/* Most transfers of one channel run, CHNDATA is 16 bits */
+#define DMA_COPY_CHUNK_MAX      0xFFFF
+
+/**@} end of group DMA_COPY_Macros */
+
+/** @defgroup DMA_COPY_Variables Variables
+  @{
+*/
+
+/* Channel claimed by DMA_COPY_Init(), NULL to do everything on the CPU */
+static DMA_Channel_T* copyChannel;
+
+/* Job queue, the first one is on the channel */
+static DMA_COPY_Job_T* copyFirst;
+static DMA_COPY_Job_T* copyLast;
+
+static DMA_COPY_Stats_T copyStats;
+
+/* Shortest job given to the channel */
+static uint32_t copyMin = DMA_COPY_MIN;
+
+/**@} end of group DMA_COPY_Variables */
+
+/** @defgroup DMA_COPY_Functions Functions
+  @{
+*/
+
+static void DMA_COPY_Event(void* context, uint8_t events);
+
+/*!
+ * @brief       Claim the channel of the copy service
+ *
+ * @param       priority: NVIC preemption priority of the channel IRQ
+ *
+ * @retval      1 if the channel was claimed, 0 if another driver has it;
+ *              jobs then run on the CPU
+ */
+uint8_t DMA_COPY_Init(uint8_t priority)
+{
+    copyFirst = NULL;
+    copyLast = NULL;
+    memset(&copyStats, 0, sizeof(copyStats));
+
+    copyChannel = DMA_MGR_Claim(DMA_COPY_REQUEST, DMA_COPY_Event, NULL, priority);
+
+    return (copyChannel != NULL) ? 1 : 0;
+}
+
+/*!
+ * @brief       Set the shortest job given to the channel
+ *
+ * @param       bytes: shorter jobs run on the CPU, DMA_COPY_MIN after reset
+ *
+ * @retval      None
+ *
+ * @note        For a crossover measured at run time, see "bench copy".
+ */
+void DMA_COPY_ConfigMin(uint32_t bytes)
+{
+    copyMin = bytes;
+}
+
+/*!
+ * @brief       Put the next chunk of a job on the channel
+ *
+ * @param       job: first job of the queue
+ *
+ * @retval      None
+ */
+static void DMA_COPY_Arm(DMA_COPY_Job_T* job)
+{
+    job->chunk = (job->items > DMA_COPY_CHUNK_MAX) ? DMA_COPY_CHUNK_MAX : (uint16_t)job->items;
+    job->image.chndata = job->chunk;
+    DMA_MGR_ApplyImage(copyChannel, &job->image);
+}
+
+/*!
+ * @brief       End a job
+ *
+ * @param       job: job, no longer queued
+ *
+ * @retval      None
+ */
+static void DMA_COPY_Finish(DMA_COPY_Job_T* job)
+{
+    job->busy = 0;
+
+    if (job->callback != NULL)
+    {
+        job->callback(job);
+    }
+}
+
+/*!
+ * @brief       Channel events of the copy service
+ *
+ * @param       context: not used
+ *
+ * @param       events: DMA_MGR_EVENT_TC or DMA_MGR_EVENT_TERR
+ *
+ * @retval      None
+ *
+ * @note        The next job is put on the channel before the callback of
+ *              the one that ended, which may queue another.
+ */
+static void DMA_COPY_Event(void* context, uint8_t events)
+{
+    DMA_COPY_Job_T* job = copyFirst;
+    uint32_t bytes;
+
+    (void)context;
+
+    if (job == NULL)
+    {
+        return;
+    }
+
+    if (events & DMA_MGR_EVENT_TERR)
+    {
+        /* The channel stopped itself, the rest of the job is given up */
+        copyChannel->CHCFG = job->image.chcfg;
+        job->error = 1;
+        job->items = 0;
+        copyStats.errors++;
+    }
+    else
+    {
+        bytes = (uint32_t)job->chunk * job->size;
+        job->items -= job->chunk;
+        job->image.chmaddr += bytes;
+        if (!job->fill)
+        {
+            job->image.chpaddr += bytes;
+        }
+        copyStats.dmaBytes += bytes;
+
+        if (job->items != 0)
+        {
+            DMA_COPY_Arm(job);
+            return;
+        }
+    }
+
+    copyStats.dmaJobs++;
+
+    copyFirst = job->next;
+    if (copyFirst == NULL)
+    {
+        copyLast = NULL;
+    }
+    else
+    {
+        DMA_COPY_Arm(copyFirst);
+    }
+
+    DMA_COPY_Finish(job);
+}
+
+/*!
+ * @brief       Queue a job, or run it on the CPU
+ *
+ * @param       job: job with callback and context set
+ *
+ * @param       dst: destination
+ *
+ * @param       src: source, NULL for a fill
+ *
+ * @param       value: fill byte
+ *
+ * @param       len: bytes
+ *
+ * @retval      None
+ */
+static void DMA_COPY_Submit(DMA_COPY_Job_T* job, uint8_t* dst, const uint8_t* src, uint8_t value, uint32_t len)
+{
+    DMA_Config_T dmaConfig;
+    uint32_t primask;
+    uint32_t apart;
+    uint32_t head;
+    uint32_t tail;
+
+    job->busy = 1;
+    job->error = 0;
+    job->fill = (src == NULL);
+    job->pattern = value * 0x01010101UL;
+
+    /* The byte lanes of source and destination decide the widest transfer */
+    apart = job->fill ? 0 : (uint32_t)dst - (uint32_t)src;
+    job->size = !(apart & 3) ? 4 : (!(apart & 1) ? 2 : 1);
+
+    head = (0 - (uint32_t)dst) & (job->size - 1);
+    if ((copyChannel == NULL) || (len < copyMin) || (len < head + job->size))
+    {
+        head = len;
+    }
+    job->items = (len - head) / job->size;
+    tail = len - head - job->items * job->size;
+
+    /* The CPU takes the unaligned ends now, or the whole job */
+    if (job->fill)
+    {
+        memset(dst, value, head);
+        memset(&dst[len - tail], value, tail);
+    }
+    else
+    {
+        memcpy(dst, src, head);
+        memcpy(&dst[len - tail], &src[len - tail], tail);
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    copyStats.cpuBytes += head + tail;
+
+    if (job->items == 0)
+    {
+        copyStats.cpuJobs++;
+        __set_PRIMASK(primask);
+
+        DMA_COPY_Finish(job);
+        return;
+    }
+
+    /* Read from the peripheral side, written to the memory side */
+    dmaConfig.peripheralBaseAddr = job->fill ? (uint32_t)&job->pattern : (uint32_t)&src[head];
+    dmaConfig.memoryBaseAddr = (uint32_t)&dst[head];
+    dmaConfig.dir = DMA_DIR_PERIPHERAL_SRC;
+    dmaConfig.bufferSize = 0;
+    dmaConfig.peripheralInc = job->fill ? DMA_PERIPHERAL_INC_DISABLE : DMA_PERIPHERAL_INC_ENABLE;
+    dmaConfig.memoryInc = DMA_MEMORY_INC_ENABLE;
+    dmaConfig.peripheralDataSize = (DMA_PERIPHERAL_DATA_SIZE_T)(job->size >> 1);
+    dmaConfig.memoryDataSize = (DMA_MEMORY_DATA_SIZE_T)(job->size >> 1);
+    dmaConfig.loopMode = DMA_MODE_NORMAL;
+    dmaConfig.priority = DMA_PRIORITY_LOW;
+    dmaConfig.M2M = DMA_M2MEN_ENABLE;
+    DMA_MGR_MakeImage(&dmaConfig, DMA_MGR_EVENT_TC | DMA_MGR_EVENT_TERR, &job->image);
+
+    job->next = NULL;
+    if (copyLast == NULL)
+    {
+        copyFirst = job;
+        copyLast = job;
+        DMA_COPY_Arm(job);
+    }
+    else
+    {
+        copyLast->next = job;
+        copyLast = job;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/*!
+ * @brief       Copy memory without waiting
+ *
+ * @param       job: job with callback and context set, not busy
+ *
+ * @param       dst: destination, left alone by the caller until done
+ *
+ * @param       src: source, not changed by the caller until done
+ *
+ * @param       len: bytes
+ *
+ * @retval      None
+ *
+ * @note        The areas must not overlap. A job shorter than the
+ *              DMA_COPY_ConfigMin() value is done, and its callback has run, when this returns.
+ *              May be called from interrupts, callbacks included.
+ */
+void DMA_COPY_Copy(DMA_COPY_Job_T* job, void* dst, const void* src, uint32_t len)
+{
+    DMA_COPY_Submit(job, (uint8_t*)dst, (const uint8_t*)src, 0, len);
+}
+
+/*!
+ * @brief       Fill memory without waiting
+ *
+ * @param       job: job with callback and context set, not busy
+ *
+ * @param       dst: destination, left alone by the caller until done
+ *
+ * @param       value: fill byte
+ *
+ * @param       len: bytes
+ *
+ * @retval      None
+ *
+ * @note        The channel reads the pattern from the job, which therefore
+ *              stays in memory the DMA reaches until done. A job shorter
+ *              than the DMA_COPY_ConfigMin() value is done when this returns.
+ */
+void DMA_COPY_Fill(DMA_COPY_Job_T* job, void* dst, uint8_t value, uint32_t len)
+{
+    DMA_COPY_Submit(job, (uint8_t*)dst, NULL, value, len);
+}
+
+/*!
+ * @brief       Whether a job is done
+ *
+ * @param       job: job passed to DMA_COPY_Copy() or DMA_COPY_Fill()
+ *
+ * @retval      1 if the job is done and the destination holds its data, 0 if it is still queued
+ */
+uint8_t DMA_COPY_Done(const DMA_COPY_Job_T* job)
+{
+    return job->busy ? 0 : 1;
+}
+
+/*!
+ * @brief       Read the service counters
+ *
+ * @param       stats: copy of the counters
+ *
+ * @param       clear: 1 to reset the counters after the copy
+ *
+ * @retval      None
+ */
+void DMA_COPY_ReadStats(DMA_COPY_Stats_T* stats, uint8_t clear)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    *stats = copyStats;
+    if (clear)
+    {
+        memset(&copyStats, 0, sizeof(copyStats));
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**@} end of group DMA_COPY_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
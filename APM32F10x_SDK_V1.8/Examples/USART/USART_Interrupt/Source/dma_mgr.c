@@ -0,0 +1,482 @@
+/*!
+ * @file        dma_mgr.c
+ *
+ * @brief       DMA channel manager: channel ownership by request and one
+ *              table-driven service routine for all channel IRQs
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * Every peripheral DMA request of the device is hard wired to one channel,
+ * the DMA_MGR_REQ_xxx values carry that channel. A driver claims its request
+ * instead of picking a channel itself; the manager turns the clock on, resets
+ * the channel, records the owner and enables the channel IRQ. A second
+ * request on a channel that already has an owner is refused and counted, so
+ * drivers sharing a channel show up at init rather than as lost transfers.
+ *
+ * All DMA IRQ handlers call DMA_MGR_Isr(). It reads the flags of the channels
+ * behind the IRQ once, keeps the events the channel has enabled, clears just
+ * those and hands them to the owner's callback.
+ */
+
+/* Includes */
+#include "dma_mgr.h"
+#include "apm32f10x_rcm.h"
+#include "apm32f10x_misc.h"
+#include <string.h>
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup DMA_MGR_Macros Macros
+  @{
+*/
+
+/* Distance between two channel register blocks */
+#define DMA_MGR_CHANNEL_STRIDE  0x14
+
+/* Channel id of a claim that found no channel */
+#define DMA_MGR_NO_CHANNEL      0xFF
+
+#if defined (APM32F10X_CL)
+#define DMA_MGR_DMA2_CH4_IRQn   DMA2_Channel4_IRQn
+#define DMA_MGR_DMA2_CH5_IRQn   DMA2_Channel5_IRQn
+#elif defined (APM32F10X_HD)
+#define DMA_MGR_DMA2_CH4_IRQn   DMA2_Channel4_5_IRQn
+#define DMA_MGR_DMA2_CH5_IRQn   DMA2_Channel4_5_IRQn
+#endif
+
+/**@} end of group DMA_MGR_Macros */
+
+/** @defgroup DMA_MGR_Structures Structures
+  @{
+*/
+
+/**
+ * @brief   Owner of a channel
+ */
+typedef struct
+{
+    DMA_MGR_Callback_T callback;  /*!< NULL for a channel polled by its owner */
+    void*              context;
+    uint16_t           request;   /*!< Request claimed */
+    uint8_t            used;      /*!< 0 while the channel is free */
+} DMA_MGR_Owner_T;
+
+/**@} end of group DMA_MGR_Structures */
+
+/** @defgroup DMA_MGR_Variables Variables
+  @{
+*/
+
+/* IRQ of each channel id */
+static const IRQn_Type dmaMgrIrq[DMA_MGR_CHANNEL_NUM] =
+{
+    DMA1_Channel1_IRQn, DMA1_Channel2_IRQn, DMA1_Channel3_IRQn, DMA1_Channel4_IRQn,
+    DMA1_Channel5_IRQn, DMA1_Channel6_IRQn, DMA1_Channel7_IRQn,
+#if DMA_MGR_CHANNEL_NUM > 7
+    DMA2_Channel1_IRQn, DMA2_Channel2_IRQn, DMA2_Channel3_IRQn,
+    DMA_MGR_DMA2_CH4_IRQn, DMA_MGR_DMA2_CH5_IRQn
+#endif
+};
+
+/*
+ * Channels tried for DMA_MGR_REQ_MEM_ANY: first those whose requests come
+ * from peripherals an application is least likely to run with DMA
+ */
+static const uint8_t dmaMgrMemOrder[DMA_MGR_CHANNEL_NUM] =
+{
+#if DMA_MGR_CHANNEL_NUM > 7
+    DMA_MGR_DMA2(2), DMA_MGR_DMA2(1), DMA_MGR_DMA2(4), DMA_MGR_DMA2(3), DMA_MGR_DMA2(5),
+#endif
+    DMA_MGR_DMA1(1), DMA_MGR_DMA1(7), DMA_MGR_DMA1(6), DMA_MGR_DMA1(3),
+    DMA_MGR_DMA1(2), DMA_MGR_DMA1(5), DMA_MGR_DMA1(4)
+};
+
+/* Owner of each channel id */
+static DMA_MGR_Owner_T dmaMgrOwner[DMA_MGR_CHANNEL_NUM];
+
+static DMA_MGR_Stats_T dmaMgrStats;
+
+/**@} end of group DMA_MGR_Variables */
+
+/** @defgroup DMA_MGR_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Get the registers of a channel
+ *
+ * @param       id: channel id, DMA_MGR_DMA1(n) or DMA_MGR_DMA2(n)
+ *
+ * @retval      DMA1_Channelx or DMA2_Channely
+ */
+static DMA_Channel_T* DMA_MGR_Channel(uint8_t id)
+{
+    if (id < DMA_MGR_DMA2(1))
+    {
+        return (DMA_Channel_T*)(DMA1_Channel1_BASE + id * DMA_MGR_CHANNEL_STRIDE);
+    }
+
+    return (DMA_Channel_T*)(DMA2_Channel1_BASE + (id - DMA_MGR_DMA2(1)) * DMA_MGR_CHANNEL_STRIDE);
+}
+
+/*!
+ * @brief       Get the id of a channel
+ *
+ * @param       channel: DMA1_Channelx or DMA2_Channely
+ *
+ * @retval      Channel id
+ */
+static uint8_t DMA_MGR_ChannelId(DMA_Channel_T* channel)
+{
+    uint32_t addr = (uint32_t)channel;
+
+    if (addr >= DMA2_Channel1_BASE)
+    {
+        return DMA_MGR_DMA2(1) + (addr - DMA2_Channel1_BASE) / DMA_MGR_CHANNEL_STRIDE;
+    }
+
+    return (addr - DMA1_Channel1_BASE) / DMA_MGR_CHANNEL_STRIDE;
+}
+
+/*!
+ * @brief       Get the controller and flag position of a channel
+ *
+ * @param       id: channel id
+ *
+ * @param       shift: set to the position of the channel flags in INTSTS and INTFCLR
+ *
+ * @retval      DMA1 or DMA2
+ */
+static DMA_T* DMA_MGR_Controller(uint8_t id, uint8_t* shift)
+{
+    if (id < DMA_MGR_DMA2(1))
+    {
+        *shift = 4 * id;
+        return DMA1;
+    }
+
+    *shift = 4 * (id - DMA_MGR_DMA2(1));
+    return DMA2;
+}
+
+/*!
+ * @brief       Stop a channel and clear its registers and flags
+ *
+ * @param       id: channel id
+ *
+ * @retval      None
+ *
+ * @note        DMA_Reset() is not used, it clears the flags of the other
+ *              channels of the controller as well.
+ */
+static void DMA_MGR_Reset(uint8_t id)
+{
+    DMA_Channel_T* channel = DMA_MGR_Channel(id);
+    DMA_T* dma;
+    uint8_t shift;
+
+    channel->CHCFG = 0;
+    channel->CHNDATA = 0;
+    channel->CHMADDR = 0;
+    channel->CHPADDR = 0;
+
+    /* Separate statement, the shift is only known once the call returned */
+    dma = DMA_MGR_Controller(id, &shift);
+    dma->INTFCLR = (uint32_t)0x0F << shift;
+}
+
+/*!
+ * @brief       Claim the channel of a DMA request
+ *
+ * @param       request: DMA_MGR_REQ_xxx value, DMA_MGR_REQ_MEM(id) or DMA_MGR_REQ_MEM_ANY
+ *
+ * @param       callback: run from the channel IRQ with the events that occurred,
+ *                        NULL to leave the channel IRQ off
+ *
+ * @param       context: passed to callback
+ *
+ * @param       priority: NVIC preemption priority of the channel IRQ
+ *
+ * @retval      The channel, reset and clocked, or NULL if it has another owner
+ *
+ * @note        A claim of the same request by the same callback and context
+ *              succeeds again, so a driver can be initialized twice.
+ *
+ * @note        DMA2 channels 4 and 5 share one IRQ on high density devices,
+ *              the last claim sets its priority.
+ */
+DMA_Channel_T* DMA_MGR_Claim(uint16_t request, DMA_MGR_Callback_T callback, void* context, uint8_t priority)
+{
+    DMA_MGR_Owner_T* owner;
+    uint32_t primask;
+    uint8_t id = DMA_MGR_NO_CHANNEL;
+    uint8_t i;
+
+    if (request == DMA_MGR_REQ_NONE)
+    {
+        return NULL;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (DMA_MGR_REQ_CHANNEL(request) == DMA_MGR_REQ_CHANNEL(DMA_MGR_REQ_MEM_ANY))
+    {
+        for (i = 0; i < DMA_MGR_CHANNEL_NUM; i++)
+        {
+            if (!dmaMgrOwner[dmaMgrMemOrder[i]].used)
+            {
+                id = dmaMgrMemOrder[i];
+                break;
+            }
+        }
+    }
+    else if (DMA_MGR_REQ_CHANNEL(request) < DMA_MGR_CHANNEL_NUM)
+    {
+        id = DMA_MGR_REQ_CHANNEL(request);
+        owner = &dmaMgrOwner[id];
+        if (owner->used &&
+            ((owner->request != request) || (owner->callback != callback) || (owner->context != context)))
+        {
+            id = DMA_MGR_NO_CHANNEL;
+        }
+    }
+
+    if (id == DMA_MGR_NO_CHANNEL)
+    {
+        dmaMgrStats.conflicts++;
+        __set_PRIMASK(primask);
+        return NULL;
+    }
+
+    owner = &dmaMgrOwner[id];
+    owner->used = 1;
+    owner->request = request;
+    owner->callback = callback;
+    owner->context = context;
+    dmaMgrStats.claims++;
+
+    __set_PRIMASK(primask);
+
+    RCM_EnableAHBPeriphClock((id < DMA_MGR_DMA2(1)) ? RCM_AHB_PERIPH_DMA1 : RCM_AHB_PERIPH_DMA2);
+
+    DMA_MGR_Reset(id);
+
+    if (callback != NULL)
+    {
+        NVIC_EnableIRQRequest(dmaMgrIrq[id], priority, 0);
+    }
+
+    return DMA_MGR_Channel(id);
+}
+
+/*!
+ * @brief       Stop a claimed channel and make it free
+ *
+ * @param       channel: channel returned by DMA_MGR_Claim()
+ *
+ * @retval      None
+ */
+void DMA_MGR_Release(DMA_Channel_T* channel)
+{
+    uint32_t primask;
+    uint8_t id = DMA_MGR_ChannelId(channel);
+    uint8_t i;
+    uint8_t shared = 0;
+
+    DMA_MGR_Reset(id);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    dmaMgrOwner[id].used = 0;
+    dmaMgrOwner[id].callback = NULL;
+    dmaMgrOwner[id].context = NULL;
+
+    for (i = 0; i < DMA_MGR_CHANNEL_NUM; i++)
+    {
+        if ((dmaMgrIrq[i] == dmaMgrIrq[id]) && (dmaMgrOwner[i].callback != NULL))
+        {
+            shared = 1;
+        }
+    }
+
+    if (!shared)
+    {
+        NVIC_DisableIRQRequest(dmaMgrIrq[id]);
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/*!
+ * @brief       Clear the pending flags of a claimed channel
+ *
+ * @param       channel: channel returned by DMA_MGR_Claim()
+ *
+ * @retval      None
+ *
+ * @note        For a driver that stops its channel by hand: a TC or TE left
+ *              behind would otherwise reach the callback once the channel
+ *              IRQ runs, after the next transfer has been started.
+ */
+void DMA_MGR_ClearFlags(DMA_Channel_T* channel)
+{
+    DMA_T* dma;
+    uint8_t shift;
+
+    dma = DMA_MGR_Controller(DMA_MGR_ChannelId(channel), &shift);
+    dma->INTFCLR = (uint32_t)0x0F << shift;
+}
+
+/*!
+ * @brief       Service a DMA channel IRQ
+ *
+ * @param       irq: DMAx_Channely_IRQn being serviced
+ *
+ * @retval      None
+ *
+ * @note        Called from every DMA channel IRQ handler. Flags of events a
+ *              channel has not enabled are left alone, so a callback that
+ *              polls them still sees them.
+ */
+void DMA_MGR_Isr(IRQn_Type irq)
+{
+    DMA_MGR_Owner_T* owner;
+    DMA_T* dma;
+    uint8_t id;
+    uint8_t last;
+    uint8_t shift;
+    uint8_t events;
+
+    if (irq <= DMA1_Channel7_IRQn)
+    {
+        id = DMA_MGR_DMA1(1) + (irq - DMA1_Channel1_IRQn);
+    }
+    else
+    {
+#if DMA_MGR_CHANNEL_NUM > 7
+        id = DMA_MGR_DMA2(1) + (irq - DMA2_Channel1_IRQn);
+#else
+        return;
+#endif
+    }
+
+    last = id;
+#if defined (APM32F10X_HD)
+    if (irq == DMA2_Channel4_5_IRQn)
+    {
+        last = DMA_MGR_DMA2(5);
+    }
+#endif
+
+    for (; id <= last; id++)
+    {
+        owner = &dmaMgrOwner[id];
+        dma = DMA_MGR_Controller(id, &shift);
+        events = (dma->INTSTS >> shift) & DMA_MGR_Channel(id)->CHCFG & DMA_MGR_EVENT_ALL;
+
+        if (events == 0)
+        {
+            continue;
+        }
+
+        dma->INTFCLR = (uint32_t)events << shift;
+
+        if (owner->callback == NULL)
+        {
+            dmaMgrStats.unowned++;
+        }
+        else
+        {
+            dmaMgrStats.events++;
+            owner->callback(owner->context, events);
+        }
+    }
+}
+
+/*!
+ * @brief       Read the manager counters
+ *
+ * @param       stats: copy of the counters
+ *
+ * @param       clear: 1 to reset the counters after the copy
+ *
+ * @retval      None
+ */
+void DMA_MGR_ReadStats(DMA_MGR_Stats_T* stats, uint8_t clear)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    *stats = dmaMgrStats;
+    if (clear)
+    {
+        memset(&dmaMgrStats, 0, sizeof(dmaMgrStats));
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/*!
+ * @brief       Build the register image of a channel setup
+ *
+ * @param       dmaConfig: setup as passed to DMA_Config()
+ *
+ * @param       events: DMA_MGR_EVENT_xxx interrupts to enable, 0 for none
+ *
+ * @param       image: image to fill
+ *
+ * @retval      None
+ *
+ * @note        No channel is touched. CHCFG is put together here the way
+ *              DMA_Config() does it field by field on the register, so
+ *              DMA_MGR_ApplyImage() leaves the channel as DMA_Config(),
+ *              DMA_EnableInterrupt() and DMA_Enable() would.
+ */
+void DMA_MGR_MakeImage(const DMA_Config_T* dmaConfig, uint8_t events, DMA_MGR_Image_T* image)
+{
+    image->chcfg = ((uint32_t)dmaConfig->dir << 4) |
+                   ((uint32_t)dmaConfig->loopMode << 5) |
+                   ((uint32_t)dmaConfig->peripheralInc << 6) |
+                   ((uint32_t)dmaConfig->memoryInc << 7) |
+                   ((uint32_t)dmaConfig->peripheralDataSize << 8) |
+                   ((uint32_t)dmaConfig->memoryDataSize << 10) |
+                   ((uint32_t)dmaConfig->priority << 12) |
+                   ((uint32_t)dmaConfig->M2M << 14) |
+                   (events & DMA_MGR_EVENT_ALL);
+    image->chndata = dmaConfig->bufferSize & 0xFFFF;
+    image->chpaddr = dmaConfig->peripheralBaseAddr;
+    image->chmaddr = dmaConfig->memoryBaseAddr;
+}
+
+/**@} end of group DMA_MGR_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
@@ -0,0 +1,270 @@
+/*!
+ * @file        frame_crc.c
+ *
+ * @brief       Frame check of received frames, the standard CRC-32 of each
+ *              frame in the receive ring
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * A frame ends in FRAME_CRC_LEN check bytes, the standard CRC-32 of the bytes
+ * before them. The CRC unit shifts data words in most significant bit first
+ * and has no input or output reversal, so the reflected CRC-32 takes every
+ * word bit reversed on the way in. A memory to memory DMA channel cannot do
+ * that, it would only give a check of its own. Each frame is therefore run
+ * through CRC32_Calc(), which feeds the whole words of the ring to the unit
+ * with __RBIT() and takes the bytes around them in software, in two pieces
+ * when the frame wraps over the end of the ring. The port ISR that queues a
+ * frame only pends PendSV, which runs at the lowest priority and checks the
+ * frames once no other interrupt is waiting, so the port interrupts stay
+ * short whatever the frame length.
+ */
+
+/* Includes */
+#include "frame_crc.h"
+#include "crc32.h"
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup FRAME_CRC_Variables Variables
+  @{
+*/
+
+/* Ports with frameCrc set, filled by FRAME_CRC_Attach() */
+static UART_DMA_Port_T* crcPort[FRAME_CRC_PORT_NUM];
+static uint8_t crcPortNum;
+
+/* Port looked at first for the next frame, so a busy port cannot starve the others */
+static uint8_t crcNext;
+
+/**@} end of group FRAME_CRC_Variables */
+
+/** @defgroup FRAME_CRC_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Initialize the frame check
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Call before UART_DMA_Init() of the ports with frameCrc set.
+ *              PendSV_Handler() must call FRAME_CRC_Isr().
+ */
+void FRAME_CRC_Init(void)
+{
+    CRC32_Init();
+
+    crcPortNum = 0;
+    crcNext = 0;
+
+    /* Below every port and DMA interrupt */
+    NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+}
+
+/*!
+ * @brief       Have the frames of a port checked
+ *
+ * @param       port: deferred mode port, called by UART_DMA_Init()
+ *
+ * @retval      None
+ *
+ * @note        frameCrc is cleared when FRAME_CRC_PORT_NUM ports have it already.
+ */
+void FRAME_CRC_Attach(UART_DMA_Port_T* port)
+{
+    uint8_t i;
+
+    for (i = 0; i < crcPortNum; i++)
+    {
+        if (crcPort[i] == port)
+        {
+            return;
+        }
+    }
+
+    if (crcPortNum < FRAME_CRC_PORT_NUM)
+    {
+        crcPort[crcPortNum++] = port;
+    }
+    else
+    {
+        port->frameCrc = 0;
+    }
+}
+
+/*!
+ * @brief       Check the oldest unchecked frame of a port and hand it to the consumer
+ *
+ * @param       port: port with crcHead behind frameHead
+ *
+ * @retval      None
+ *
+ * @note        The last FRAME_CRC_LEN bytes are left out. A piece of a long
+ *              frame hands them on to the piece after it, which goes on from
+ *              the check so far.
+ */
+static void FRAME_CRC_Check(UART_DMA_Port_T* port)
+{
+    UART_DMA_Frame_T* frame = &port->frameQueue[port->crcHead];
+    uint16_t size = port->rxRingSize;
+    uint16_t carry = 0;
+    uint16_t start;
+    uint16_t count;
+    uint16_t first;
+    uint16_t at = size;
+    uint32_t crc = 0;
+    uint32_t check = 0;
+    uint8_t next;
+    uint8_t i;
+
+    if (frame->flags & UART_DMA_FRAME_CONT)
+    {
+        carry = FRAME_CRC_LEN;
+        crc = port->crcRun;
+    }
+
+    if (carry + frame->len >= FRAME_CRC_LEN)
+    {
+        count = carry + frame->len - FRAME_CRC_LEN;
+        start = (frame->offset >= carry) ? (frame->offset - carry) : (frame->offset + size - carry);
+        at = (start + count) % size;
+
+        /* Up to the end of the ring and from its start */
+        first = (count > size - start) ? (size - start) : count;
+        crc = CRC32_Calc(crc, &port->rxRing[start], first);
+        crc = CRC32_Calc(crc, port->rxRing, count - first);
+    }
+
+    frame->crc = crc;
+
+    if (!(frame->flags & UART_DMA_FRAME_END))
+    {
+        port->crcRun = crc;
+    }
+    else
+    {
+        /* A frame too short to carry a check has no trailer */
+        if (at != size)
+        {
+            for (i = 0; i < FRAME_CRC_LEN; i++)
+            {
+                check |= (uint32_t)port->rxRing[at] << (8 * i);
+                at = (at + 1 == size) ? 0 : at + 1;
+            }
+
+            if (check == crc)
+            {
+                frame->flags |= UART_DMA_FRAME_CRC_OK;
+            }
+        }
+
+        if (!(frame->flags & UART_DMA_FRAME_CRC_OK))
+        {
+            port->stats.crcErrors++;
+        }
+    }
+
+    next = port->crcHead + 1;
+    if (next == port->frameQueueLen)
+    {
+        next = 0;
+    }
+
+    /* The consumer reads the slot only after the index it was published with */
+    __DMB();
+    port->crcHead = next;
+}
+
+/*!
+ * @brief       Find a port with a frame waiting for its check
+ *
+ * @param       None
+ *
+ * @retval      Port, NULL if every frame is checked
+ */
+static UART_DMA_Port_T* FRAME_CRC_Pending(void)
+{
+    UART_DMA_Port_T* port;
+    uint8_t n;
+
+    for (n = 0; n < crcPortNum; n++)
+    {
+        port = crcPort[crcNext];
+        crcNext = (crcNext + 1 == crcPortNum) ? 0 : crcNext + 1;
+
+        if (port->crcHead != port->frameHead)
+        {
+            return port;
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief       Check newly queued frames
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Called by the port ISRs after a frame is queued, it only
+ *              pends PendSV.
+ */
+void FRAME_CRC_Kick(void)
+{
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/*!
+ * @brief       Check the frames of every port
+ *
+ * @param       None
+ *
+ * @retval      None
+ *
+ * @note        Called by PendSV_Handler(). A frame queued meanwhile pends
+ *              PendSV again, so none is left waiting.
+ */
+void FRAME_CRC_Isr(void)
+{
+    UART_DMA_Port_T* port;
+
+    while ((port = FRAME_CRC_Pending()) != NULL)
+    {
+        /* Read the slot only after the head index it was published with */
+        __DMB();
+        FRAME_CRC_Check(port);
+    }
+}
+
+/**@} end of group FRAME_CRC_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
@@ -0,0 +1,455 @@
+/*!
+ * @file        lin.c
+ *
+ * @brief       LIN 2.x master and slave nodes on the UART DMA engine
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * A frame is a break, LIN_SYNC, the protected identifier and a response of
+ * 1 to 8 data bytes and a checksum. The USART flags the break with LBD and
+ * the engine hands the bytes received before it on first, so LIN_Break()
+ * always starts from a clean frame boundary. The rest arrives by DMA and
+ * reaches LIN_Receive() on line idle, usually twice a frame: after the
+ * header, once the publisher is slower than one character, and after the
+ * response. No byte costs an interrupt of its own.
+ */
+
+/* Includes */
+#include "lin.h"
+#include <string.h>
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup LIN_Macros Macros
+  @{
+*/
+
+/* Parser states */
+#define LIN_STATE_IDLE          0
+#define LIN_STATE_SYNC          1
+#define LIN_STATE_PID           2
+#define LIN_STATE_RESPONSE      3
+
+/* No frame for the identifier in idMap */
+#define LIN_NO_FRAME            0xFF
+
+/**@} end of group LIN_Macros */
+
+/** @defgroup LIN_Variables Variables
+  @{
+*/
+
+/* Clusters by port, for the engine callbacks */
+static LIN_Cluster_T* linCluster[LIN_CLUSTER_NUM];
+
+/**@} end of group LIN_Variables */
+
+/** @defgroup LIN_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Transmit callback, tx may be written again
+ *
+ * @param       req: transmit request of a node
+ *
+ * @retval      None
+ */
+static void LIN_Sent(UART_DMA_Request_T* req)
+{
+    ((LIN_Cluster_T*)req->context)->busy = 0;
+}
+
+/*!
+ * @brief       Set up a node, its port initialized with the LIN callbacks
+ *
+ * @param       cluster: node with port, role and tables filled in
+ *
+ * @retval      None
+ *
+ * @note        The master sends its first header one slot time later.
+ */
+void LIN_Init(LIN_Cluster_T* cluster)
+{
+    uint8_t i;
+
+    memset(&cluster->stats, 0, sizeof(cluster->stats));
+    memset(cluster->idMap, LIN_NO_FRAME, sizeof(cluster->idMap));
+    for (i = 0; i < cluster->frameNum; i++)
+    {
+        cluster->idMap[cluster->frames[i].id & 0x3F] = i;
+    }
+
+    cluster->state = LIN_STATE_IDLE;
+    cluster->slot = cluster->slotNum - 1;
+    cluster->slotStart = UART_DMA_TIMESTAMP();
+
+    cluster->request.segments = &cluster->segment;
+    cluster->request.count = 1;
+    cluster->busy = 0;
+    cluster->request.callback = LIN_Sent;
+    cluster->request.context = cluster;
+
+    for (i = 0; i < LIN_CLUSTER_NUM; i++)
+    {
+        if ((linCluster[i] == NULL) || (linCluster[i]->port == cluster->port))
+        {
+            linCluster[i] = cluster;
+            break;
+        }
+    }
+}
+
+/*!
+ * @brief       Compute a LIN checksum
+ *
+ * @param       pid: protected identifier for the enhanced checksum, 0 for the classic one
+ *
+ * @param       data: response data
+ *
+ * @param       len: number of data bytes
+ *
+ * @retval      Inverted sum with carry
+ */
+uint8_t LIN_Checksum(uint8_t pid, const uint8_t* data, uint8_t len)
+{
+    uint16_t sum = pid;
+
+    while (len--)
+    {
+        sum += *data++;
+        if (sum > 0xFF)
+        {
+            sum -= 0xFF;
+        }
+    }
+
+    return (uint8_t)~sum;
+}
+
+/*!
+ * @brief       Cluster of a port
+ *
+ * @param       port: UART port
+ *
+ * @retval      Cluster, NULL if the port has none
+ */
+static LIN_Cluster_T* LIN_Find(UART_DMA_Port_T* port)
+{
+    uint8_t i;
+
+    for (i = 0; (i < LIN_CLUSTER_NUM) && (linCluster[i] != NULL); i++)
+    {
+        if (linCluster[i]->port == port)
+        {
+            return linCluster[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief       Checksum of a frame of the table over a response
+ *
+ * @param       frame: frame table entry
+ *
+ * @param       data: response data
+ *
+ * @retval      Checksum
+ */
+static uint8_t LIN_FrameChecksum(const LIN_Frame_T* frame, const uint8_t* data)
+{
+    uint8_t classic = frame->classic || (frame->id >= LIN_ID_MASTER_REQUEST);
+
+    return LIN_Checksum(classic ? 0 : LIN_PID(frame->id), data, frame->len);
+}
+
+/*!
+ * @brief       End the frame in progress
+ *
+ * @param       cluster: node
+ *
+ * @param       status: LIN_STATUS_xxx
+ *
+ * @retval      None
+ */
+static void LIN_Done(LIN_Cluster_T* cluster, uint8_t status)
+{
+    LIN_Stats_T* stats = &cluster->stats;
+
+    cluster->state = LIN_STATE_IDLE;
+
+    switch (status)
+    {
+        case LIN_STATUS_OK:
+            stats->frames++;
+            break;
+        case LIN_STATUS_NO_RESPONSE:
+            stats->noResponse++;
+            break;
+        case LIN_STATUS_INCOMPLETE:
+            stats->incomplete++;
+            break;
+        case LIN_STATUS_CHECKSUM:
+            stats->checksumErrors++;
+            break;
+        default:
+            stats->readbackErrors++;
+            break;
+    }
+
+    if (cluster->callback != NULL)
+    {
+        cluster->callback(cluster, cluster->frame, status);
+    }
+}
+
+/*!
+ * @brief       Check a complete response
+ *
+ * @param       cluster: node
+ *
+ * @retval      None
+ */
+static void LIN_Response(LIN_Cluster_T* cluster)
+{
+    const LIN_Frame_T* frame = &cluster->frames[cluster->frame];
+    const uint8_t* sent = cluster->master ? &cluster->tx[2] : cluster->tx;
+
+    if (frame->direction == LIN_PUBLISH)
+    {
+        /* The bus is wired-AND, a collision or a fault changes what is read back */
+        LIN_Done(cluster, memcmp(cluster->rx, sent, frame->len + 1) ? LIN_STATUS_READBACK : LIN_STATUS_OK);
+    }
+    else if (cluster->rx[frame->len] != LIN_FrameChecksum(frame, cluster->rx))
+    {
+        LIN_Done(cluster, LIN_STATUS_CHECKSUM);
+    }
+    else
+    {
+        memcpy(&cluster->signals[frame->offset], cluster->rx, frame->len);
+        LIN_Done(cluster, LIN_STATUS_OK);
+    }
+}
+
+/*!
+ * @brief       Take a protected identifier
+ *
+ * @param       cluster: node
+ *
+ * @param       pid: byte after the sync
+ *
+ * @retval      None
+ */
+static void LIN_Header(LIN_Cluster_T* cluster, uint8_t pid)
+{
+    const LIN_Frame_T* frame;
+    uint8_t index = cluster->idMap[pid & 0x3F];
+
+    cluster->state = LIN_STATE_IDLE;
+
+    if (pid != LIN_PID(pid & 0x3F))
+    {
+        cluster->stats.parityErrors++;
+        return;
+    }
+
+    if (index == LIN_NO_FRAME)
+    {
+        return;
+    }
+
+    frame = &cluster->frames[index];
+    cluster->stats.headers++;
+    cluster->frame = index;
+    cluster->pid = pid;
+    cluster->rxLen = 0;
+    cluster->state = LIN_STATE_RESPONSE;
+
+    /* TResponse_Maximum is 1.4 times the nominal response, plus the idle character that hands it on */
+    cluster->deadline = UART_DMA_TIMESTAMP() + (14 * (frame->len + 1) + 10) * cluster->port->bitTime;
+
+    /* A slave answers at once, the master queued its response with the header */
+    if ((frame->direction == LIN_PUBLISH) && !cluster->master && !cluster->busy)
+    {
+        memcpy(cluster->tx, &cluster->signals[frame->offset], frame->len);
+        cluster->tx[frame->len] = LIN_FrameChecksum(frame, cluster->tx);
+        cluster->segment.data = cluster->tx;
+        cluster->segment.len = frame->len + 1;
+        cluster->busy = 1;
+        UART_DMA_Send(cluster->port, &cluster->request);
+    }
+}
+
+/*!
+ * @brief       Receive callback of a LIN port
+ *
+ * @param       port: UART port
+ *
+ * @param       data: bytes received since the last call
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      None
+ *
+ * @note        Runs in the port interrupt.
+ */
+void LIN_Receive(UART_DMA_Port_T* port, const uint8_t* data, uint16_t len)
+{
+    LIN_Cluster_T* cluster = LIN_Find(port);
+
+    if (cluster == NULL)
+    {
+        return;
+    }
+
+    while (len--)
+    {
+        switch (cluster->state)
+        {
+            case LIN_STATE_SYNC:
+                if (*data == LIN_SYNC)
+                {
+                    cluster->state = LIN_STATE_PID;
+                }
+                else
+                {
+                    cluster->stats.syncErrors++;
+                    cluster->state = LIN_STATE_IDLE;
+                }
+                break;
+
+            case LIN_STATE_PID:
+                LIN_Header(cluster, *data);
+                break;
+
+            case LIN_STATE_RESPONSE:
+                cluster->rx[cluster->rxLen++] = *data;
+                if (cluster->rxLen == cluster->frames[cluster->frame].len + 1)
+                {
+                    LIN_Response(cluster);
+                }
+                break;
+
+            default:
+                /* Not part of a frame for this node */
+                break;
+        }
+
+        data++;
+    }
+}
+
+/*!
+ * @brief       Break callback of a LIN port
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ *
+ * @note        Runs in the port interrupt. A response still in progress
+ *              was cut short.
+ */
+void LIN_Break(UART_DMA_Port_T* port)
+{
+    LIN_Cluster_T* cluster = LIN_Find(port);
+
+    if (cluster == NULL)
+    {
+        return;
+    }
+
+    if (cluster->state == LIN_STATE_RESPONSE)
+    {
+        LIN_Done(cluster, cluster->rxLen ? LIN_STATUS_INCOMPLETE : LIN_STATUS_NO_RESPONSE);
+    }
+
+    cluster->state = LIN_STATE_SYNC;
+}
+
+/*!
+ * @brief       Response timeout, and the master schedule
+ *
+ * @param       cluster: node
+ *
+ * @retval      None
+ *
+ * @note        Call from the main loop. The master sends the header of the
+ *              next schedule entry once the slot time of the last one is
+ *              over, with its response when it publishes the frame.
+ */
+void LIN_Poll(LIN_Cluster_T* cluster)
+{
+    const LIN_Frame_T* frame;
+    uint32_t now = UART_DMA_TIMESTAMP();
+    uint32_t primask;
+    uint8_t next;
+    uint8_t len;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if ((cluster->state == LIN_STATE_RESPONSE) && ((int32_t)(now - cluster->deadline) >= 0))
+    {
+        LIN_Done(cluster, cluster->rxLen ? LIN_STATUS_INCOMPLETE : LIN_STATUS_NO_RESPONSE);
+    }
+    __set_PRIMASK(primask);
+
+    if (!cluster->master || (cluster->slotNum == 0) || cluster->busy ||
+        (now - cluster->slotStart < cluster->schedule[cluster->slot].slotMs * (UART_DMA_TIMESTAMP_HZ / 1000)))
+    {
+        return;
+    }
+
+    next = (cluster->slot + 1 == cluster->slotNum) ? 0 : cluster->slot + 1;
+    frame = &cluster->frames[cluster->schedule[next].frame];
+
+    cluster->tx[0] = LIN_SYNC;
+    cluster->tx[1] = LIN_PID(frame->id);
+    len = 2;
+    if (frame->direction == LIN_PUBLISH)
+    {
+        memcpy(&cluster->tx[2], &cluster->signals[frame->offset], frame->len);
+        cluster->tx[2 + frame->len] = LIN_FrameChecksum(frame, &cluster->tx[2]);
+        len += frame->len + 1;
+    }
+
+    cluster->segment.data = cluster->tx;
+    cluster->segment.len = len;
+    cluster->slot = next;
+    cluster->slotStart = now;
+    cluster->busy = 1;
+
+    /* The break leaves first, the DMA transfer follows its delimiter */
+    USART_TxBreak(cluster->port->usart);
+    UART_DMA_Send(cluster->port, &cluster->request);
+}
+
+/**@} end of group LIN_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
@@ -27,6 +27,11 @@
 #include "main.h"
 #include "stdio.h"
 #include <string.h>
+
+#if defined (UART_DMA_BENCH)
+#include "bench.h"
+#endif
+
 /** @addtogroup Examples
   @{
 */
@@ -39,6 +44,120 @@
   @{
 */
 
+/* Receive ring size of each port */
+#define RX_RING_SIZE  512
+/* Number of UART_DMA_Write() buffers of each port */
+#define TX_POOL_LEN   4
+/* Number of received frame descriptors of each port */
+#define FRAME_QUEUE_LEN  16
+
+/* 1 to run every port with RTS/CTS flow control */
+#ifndef UART_FLOW_CONTROL
+#define UART_FLOW_CONTROL  0
+#endif
+/* Ring fill that stops the sender, leaving room for what it sends before it sees RTS */
+#define RTS_HIGH      (RX_RING_SIZE / 2 - 64)
+/* Ring fill that lets the sender go on */
+#define RTS_LOW       (RX_RING_SIZE / 4)
+/* Flow control of a port table entry */
+#define PORT_FLOW(flow)  (UART_FLOW_CONTROL ? &(flow) : NULL)
+
+/* 1 to check the FRAME_CRC bytes closing every received frame */
+#ifndef UART_FRAME_CRC
+#define UART_FRAME_CRC  0
+#endif
+
+/* 1 to run every port through an RS-485 transceiver, DE on the RTS pin */
+#ifndef UART_RS485
+#define UART_RS485  0
+#endif
+/* Bit times DE is driven before the first start bit and after the last stop bit */
+#define RS485_LEAD_BITS  1
+#define RS485_TAIL_BITS  1
+/* RS-485 driver enable of a port table entry */
+#define PORT_RS485(rs485)  (UART_RS485 ? &(rs485) : NULL)
+
+/* 1 to receive only the frames addressed to each port, 9 data bits with the address mark */
+#ifndef UART_MULTI_DROP
+#define UART_MULTI_DROP  0
+#endif
+/* Multi-drop address of port n is NODE_ADDRESS + n */
+#define NODE_ADDRESS  0x01
+
+/* 1 to run a Modbus RTU slave on every port in place of the echo, at address NODE_ADDRESS + n */
+#ifndef UART_MODBUS
+#define UART_MODBUS  0
+#endif
+/* Coils and discrete inputs, holding and input registers of each slave */
+#define MODBUS_BIT_NUM  256
+#define MODBUS_REG_NUM  128
+
+#if UART_MODBUS && (UART_FRAME_CRC || UART_MULTI_DROP || UART_FLOW_CONTROL)
+#error "UART_MODBUS frames carry their own address and CRC-16, and a paused request breaks t3.5 framing"
+#endif
+
+/* 1 to run LIN on every port at 19200 baud: USART1 to USART3 masters, UART4/5 slaves */
+#ifndef UART_LIN
+#define UART_LIN  0
+#endif
+#define LIN_BAUD_RATE  19200
+/* Signal bytes of each node */
+#define LIN_SIGNAL_SIZE  16
+
+/* Ports take bytes with LIN_Receive() in LIN mode, frames from the idle-line queue otherwise */
+#define PORT_RX(frames)  .rxCallback = (UART_LIN ? LIN_Receive : NULL), \
+                         .frameQueue = (UART_LIN ? NULL : (frames)), .frameQueueLen = FRAME_QUEUE_LEN
+#define PORT_BREAK       (UART_LIN ? LIN_Break : NULL)
+
+#if UART_LIN && (UART_MODBUS || UART_FRAME_CRC || UART_MULTI_DROP || UART_FLOW_CONTROL || UART_RS485)
+#error "UART_LIN runs 8N1 with its own framing and checksum on a single wire bus"
+#endif
+
+/* 1 to run an ISO 7816 card reader on USART3 in place of its echo: I/O on PB10, CK on PB12, RST on PB0 */
+#ifndef UART_SMARTCARD
+#define UART_SMARTCARD  0
+#endif
+#define SMARTCARD_PORT  2
+/* Card clock PCLK1 / (2 * 5), 3.6 MHz */
+#define SMARTCARD_PRESCALER  5
+/* Size of the file the demo writes and reads back */
+#define SMARTCARD_FILE_SIZE  256
+
+/* USART3 takes the card bytes with SC_Receive() when it runs the card reader */
+#define PORT_CARD_RX(frames)  .rxCallback = (UART_SMARTCARD ? SC_Receive : (UART_LIN ? LIN_Receive : NULL)), \
+                              .frameQueue = ((UART_SMARTCARD || UART_LIN) ? NULL : (frames)), .frameQueueLen = FRAME_QUEUE_LEN
+#define PORT_SMARTCARD(card)  (UART_SMARTCARD ? &(card) : NULL)
+
+#if UART_SMARTCARD && (UART_LIN || UART_MODBUS || UART_FRAME_CRC || UART_MULTI_DROP || UART_FLOW_CONTROL || UART_RS485 || \
+                       defined (UART_DMA_BENCH))
+#error "UART_SMARTCARD runs USART3 half duplex with 9 bits and parity, the other port options do not apply"
+#endif
+
+/* 1 to measure the line rate of USART1 from a 0x55 and of USART2 from a start bit, both unknown at reset */
+#ifndef UART_AUTOBAUD
+#define UART_AUTOBAUD  0
+#endif
+/* Slowest rate either port measures */
+#define AUTOBAUD_MIN_RATE  9600
+/* Auto-baud timer of a port table entry */
+#define PORT_AUTOBAUD(autoBaud)  (UART_AUTOBAUD ? &(autoBaud) : NULL)
+
+#if UART_AUTOBAUD && (UART_LIN || UART_MODBUS || UART_SMARTCARD || defined (UART_DMA_BENCH))
+#error "UART_AUTOBAUD is for the echo ports, LIN times its own sync field and the others run at a fixed rate"
+#endif
+
+/* 1 to sleep in WFI between frames, USART and DMA go on filling the rings in Sleep mode */
+#ifndef UART_LOW_POWER
+#define UART_LOW_POWER  0
+#endif
+
+#if UART_LOW_POWER && (UART_LIN || UART_MODBUS || UART_SMARTCARD || defined (UART_DMA_BENCH))
+#error "UART_LOW_POWER sleeps in the echo loop, the LIN, Modbus and card polls keep time in the main loop"
+#endif
+
+#if UART_RS485 && UART_FLOW_CONTROL
+#error "UART_RS485 drives DE on the RTS pins, it cannot be combined with UART_FLOW_CONTROL"
+#endif
 
 /**@} end of group USART_Interrupt_MACROS */
 
@@ -46,12 +165,165 @@
   @{
 */
 
-#define MAX_LEN  256
+uint8_t usart1RxRing[RX_RING_SIZE];
+uint8_t usart2RxRing[RX_RING_SIZE];
+uint8_t usart3RxRing[RX_RING_SIZE];
+uint8_t uart4RxRing[RX_RING_SIZE];
+uint8_t uart5RxRing[RX_RING_SIZE];
+
+UART_DMA_TxBuffer_T usart1TxPool[TX_POOL_LEN];
+UART_DMA_TxBuffer_T usart2TxPool[TX_POOL_LEN];
+UART_DMA_TxBuffer_T usart3TxPool[TX_POOL_LEN];
+UART_DMA_TxBuffer_T uart4TxPool[TX_POOL_LEN];
+UART_DMA_TxBuffer_T uart5TxPool[TX_POOL_LEN];
+
+UART_DMA_Frame_T usart1Frames[FRAME_QUEUE_LEN];
+UART_DMA_Frame_T usart2Frames[FRAME_QUEUE_LEN];
+UART_DMA_Frame_T usart3Frames[FRAME_QUEUE_LEN];
+UART_DMA_Frame_T uart4Frames[FRAME_QUEUE_LEN];
+UART_DMA_Frame_T uart5Frames[FRAME_QUEUE_LEN];
+
+/* RTS then CTS pins, UART4/5 use GPIOs and the EINT lines of their CTS pins */
+const UART_DMA_Flow_T usart1Flow = {UART_DMA_USART1_RTS, UART_DMA_USART1_CTS, RTS_HIGH, RTS_LOW};
+const UART_DMA_Flow_T usart2Flow = {UART_DMA_USART2_RTS, UART_DMA_USART2_CTS, RTS_HIGH, RTS_LOW};
+const UART_DMA_Flow_T usart3Flow = {UART_DMA_USART3_RTS, UART_DMA_USART3_CTS, RTS_HIGH, RTS_LOW};
+const UART_DMA_Flow_T uart4Flow  = {GPIOC, GPIO_PIN_9, GPIOC, GPIO_PIN_8, RTS_HIGH, RTS_LOW};
+const UART_DMA_Flow_T uart5Flow  = {GPIOD, GPIO_PIN_4, GPIOD, GPIO_PIN_3, RTS_HIGH, RTS_LOW};
+
+/* DE pins and guard times */
+const UART_DMA_Rs485_T usart1Rs485 = {UART_DMA_USART1_RTS, RS485_LEAD_BITS, RS485_TAIL_BITS};
+const UART_DMA_Rs485_T usart2Rs485 = {UART_DMA_USART2_RTS, RS485_LEAD_BITS, RS485_TAIL_BITS};
+const UART_DMA_Rs485_T usart3Rs485 = {UART_DMA_USART3_RTS, RS485_LEAD_BITS, RS485_TAIL_BITS};
+const UART_DMA_Rs485_T uart4Rs485  = {GPIOC, GPIO_PIN_9, RS485_LEAD_BITS, RS485_TAIL_BITS};
+const UART_DMA_Rs485_T uart5Rs485  = {GPIOD, GPIO_PIN_4, RS485_LEAD_BITS, RS485_TAIL_BITS};
+
+/* Card clock output, prescaler and guard time until the answer to reset sets it */
+const UART_DMA_SmartCard_T usart3SmartCard = {UART_DMA_USART3_CK, SMARTCARD_PRESCALER, 0};
+
+/* RX pin capture channels, USART1 waits for 0x55, USART2 times the start bit of its first character */
+const UART_DMA_AutoBaud_T usart1AutoBaud = {UART_DMA_USART1_RX_TMR, AUTOBAUD_MIN_RATE, 1};
+const UART_DMA_AutoBaud_T usart2AutoBaud = {UART_DMA_USART2_RX_TMR, AUTOBAUD_MIN_RATE, 0};
+
+/* Serial links of the board, adding a port only takes a line here */
+UART_DMA_Port_T uartPorts[] =
+{
+    {UART_DMA_USART1_HW,
+     .rxRing = usart1RxRing, .rxRingSize = RX_RING_SIZE, .txPool = usart1TxPool, .txPoolLen = TX_POOL_LEN,
+     PORT_RX(usart1Frames), .flow = PORT_FLOW(usart1Flow), .frameCrc = UART_FRAME_CRC,
+     .rs485 = PORT_RS485(usart1Rs485), .multiDrop = UART_MULTI_DROP, .address = NODE_ADDRESS + 0,
+     .breakCallback = PORT_BREAK, .smartCard = NULL, .autoBaud = PORT_AUTOBAUD(usart1AutoBaud)},
+    {UART_DMA_USART2_HW,
+     .rxRing = usart2RxRing, .rxRingSize = RX_RING_SIZE, .txPool = usart2TxPool, .txPoolLen = TX_POOL_LEN,
+     PORT_RX(usart2Frames), .flow = PORT_FLOW(usart2Flow), .frameCrc = UART_FRAME_CRC,
+     .rs485 = PORT_RS485(usart2Rs485), .multiDrop = UART_MULTI_DROP, .address = NODE_ADDRESS + 1,
+     .breakCallback = PORT_BREAK, .smartCard = NULL, .autoBaud = PORT_AUTOBAUD(usart2AutoBaud)},
+    {UART_DMA_USART3_HW,
+     .rxRing = usart3RxRing, .rxRingSize = RX_RING_SIZE, .txPool = usart3TxPool, .txPoolLen = TX_POOL_LEN,
+     PORT_CARD_RX(usart3Frames), .flow = PORT_FLOW(usart3Flow), .frameCrc = UART_FRAME_CRC,
+     .rs485 = PORT_RS485(usart3Rs485), .multiDrop = UART_MULTI_DROP, .address = NODE_ADDRESS + 2,
+     .breakCallback = PORT_BREAK, .smartCard = PORT_SMARTCARD(usart3SmartCard), .autoBaud = NULL},
+    {UART_DMA_UART4_HW,
+     .rxRing = uart4RxRing, .rxRingSize = RX_RING_SIZE, .txPool = uart4TxPool, .txPoolLen = TX_POOL_LEN,
+     PORT_RX(uart4Frames), .flow = PORT_FLOW(uart4Flow), .frameCrc = UART_FRAME_CRC,
+     .rs485 = PORT_RS485(uart4Rs485), .multiDrop = UART_MULTI_DROP, .address = NODE_ADDRESS + 3,
+     .breakCallback = PORT_BREAK, .smartCard = NULL, .autoBaud = NULL},
+    {UART_DMA_UART5_HW,
+     .rxRing = uart5RxRing, .rxRingSize = RX_RING_SIZE, .txPool = uart5TxPool, .txPoolLen = TX_POOL_LEN,
+     PORT_RX(uart5Frames), .flow = PORT_FLOW(uart5Flow), .frameCrc = UART_FRAME_CRC,
+     .rs485 = PORT_RS485(uart5Rs485), .multiDrop = UART_MULTI_DROP, .address = NODE_ADDRESS + 4,
+     .breakCallback = PORT_BREAK, .smartCard = NULL, .autoBaud = NULL},
+};
+
+#define UART_PORT_NUM  (sizeof(uartPorts) / sizeof(uartPorts[0]))
+
+/* Read/write tables of each Modbus slave, registers in wire order */
+uint8_t modbusCoils[UART_PORT_NUM][MODBUS_BIT_NUM / 8];
+uint16_t modbusHolding[UART_PORT_NUM][MODBUS_REG_NUM];
+
+/* Read only tables shared by the slaves, set up in main() */
+uint8_t modbusDiscrete[MODBUS_BIT_NUM / 8];
+uint16_t modbusInput[MODBUS_REG_NUM];
+
+MODBUS_Slave_T modbusSlaves[] =
+{
+    {.port = &uartPorts[0], .address = NODE_ADDRESS + 0,
+     .coils = modbusCoils[0], .coilNum = MODBUS_BIT_NUM, .discreteInputs = modbusDiscrete, .discreteNum = MODBUS_BIT_NUM,
+     .holdingRegs = modbusHolding[0], .holdingNum = MODBUS_REG_NUM, .inputRegs = modbusInput, .inputNum = MODBUS_REG_NUM},
+    {.port = &uartPorts[1], .address = NODE_ADDRESS + 1,
+     .coils = modbusCoils[1], .coilNum = MODBUS_BIT_NUM, .discreteInputs = modbusDiscrete, .discreteNum = MODBUS_BIT_NUM,
+     .holdingRegs = modbusHolding[1], .holdingNum = MODBUS_REG_NUM, .inputRegs = modbusInput, .inputNum = MODBUS_REG_NUM},
+    {.port = &uartPorts[2], .address = NODE_ADDRESS + 2,
+     .coils = modbusCoils[2], .coilNum = MODBUS_BIT_NUM, .discreteInputs = modbusDiscrete, .discreteNum = MODBUS_BIT_NUM,
+     .holdingRegs = modbusHolding[2], .holdingNum = MODBUS_REG_NUM, .inputRegs = modbusInput, .inputNum = MODBUS_REG_NUM},
+    {.port = &uartPorts[3], .address = NODE_ADDRESS + 3,
+     .coils = modbusCoils[3], .coilNum = MODBUS_BIT_NUM, .discreteInputs = modbusDiscrete, .discreteNum = MODBUS_BIT_NUM,
+     .holdingRegs = modbusHolding[3], .holdingNum = MODBUS_REG_NUM, .inputRegs = modbusInput, .inputNum = MODBUS_REG_NUM},
+    {.port = &uartPorts[4], .address = NODE_ADDRESS + 4,
+     .coils = modbusCoils[4], .coilNum = MODBUS_BIT_NUM, .discreteInputs = modbusDiscrete, .discreteNum = MODBUS_BIT_NUM,
+     .holdingRegs = modbusHolding[4], .holdingNum = MODBUS_REG_NUM, .inputRegs = modbusInput, .inputNum = MODBUS_REG_NUM},
+};
+
+/*
+ * LIN frames of the example cluster. The masters send back on 0x21 the
+ * data a slave published on 0x20 and write what came on the diagnostic
+ * slave response frame back with a master request; the slaves mirror
+ * that. Nobody answers 0x10, that slot shows a response timeout.
+ */
+const LIN_Frame_T linMasterFrames[] =
+{
+    {0x20, LIN_SUBSCRIBE, 4, 0, 0},
+    {0x21, LIN_PUBLISH, 4, 0, 0},
+    {LIN_ID_SLAVE_RESPONSE, LIN_SUBSCRIBE, 8, 1, 4},
+    {LIN_ID_MASTER_REQUEST, LIN_PUBLISH, 8, 1, 4},
+    {0x10, LIN_SUBSCRIBE, 2, 0, 12},
+};
+
+const LIN_Frame_T linSlaveFrames[] =
+{
+    {0x20, LIN_PUBLISH, 4, 0, 0},
+    {0x21, LIN_SUBSCRIBE, 4, 0, 0},
+    {LIN_ID_SLAVE_RESPONSE, LIN_PUBLISH, 8, 1, 4},
+    {LIN_ID_MASTER_REQUEST, LIN_SUBSCRIBE, 8, 1, 4},
+};
+
+/* One frame every 10 ms, long enough for 8 data bytes at 19200 baud */
+const LIN_Slot_T linSchedule[] =
+{
+    {0, 10}, {1, 10}, {2, 10}, {3, 10}, {4, 10},
+};
+
+#define LIN_TABLE_LEN(table)  (sizeof(table) / sizeof(table[0]))
+
+uint8_t linSignals[UART_PORT_NUM][LIN_SIGNAL_SIZE];
+
+LIN_Cluster_T linNodes[] =
+{
+    {.port = &uartPorts[0], .master = 1, .frames = linMasterFrames, .frameNum = LIN_TABLE_LEN(linMasterFrames),
+     .schedule = linSchedule, .slotNum = LIN_TABLE_LEN(linSchedule), .signals = linSignals[0]},
+    {.port = &uartPorts[1], .master = 1, .frames = linMasterFrames, .frameNum = LIN_TABLE_LEN(linMasterFrames),
+     .schedule = linSchedule, .slotNum = LIN_TABLE_LEN(linSchedule), .signals = linSignals[1]},
+    {.port = &uartPorts[2], .master = 1, .frames = linMasterFrames, .frameNum = LIN_TABLE_LEN(linMasterFrames),
+     .schedule = linSchedule, .slotNum = LIN_TABLE_LEN(linSchedule), .signals = linSignals[2]},
+    {.port = &uartPorts[3], .master = 0, .frames = linSlaveFrames, .frameNum = LIN_TABLE_LEN(linSlaveFrames),
+     .signals = linSignals[3]},
+    {.port = &uartPorts[4], .master = 0, .frames = linSlaveFrames, .frameNum = LIN_TABLE_LEN(linSlaveFrames),
+     .signals = linSignals[4]},
+};
+
+/* Card reader on USART3 */
+SC_Card_T scReader = {.port = &uartPorts[SMARTCARD_PORT], .rstPort = GPIOB, .rstPin = GPIO_PIN_0};
+
+/* Card demo: READ BINARY responses that differ from what was written */
+uint32_t cardMismatches;
 
-u8 uart_tx_buf[MAX_LEN] = {0};
-u8 uart_rx_buf[MAX_LEN] = {0};
+/* Frame being echoed on each port, len is 0 when idle */
+UART_DMA_Frame_T echoFrames[UART_PORT_NUM];
 
-void send_data(u8 *buf, u16 len);
+/* Last byte received to echo queued, per port */
+UART_DMA_Latency_T echoLatency[UART_PORT_NUM];
+
+/* Sleeps and awake time of the main loop with UART_LOW_POWER */
+LowPower_Stats_T lowPower;
 
 /**@} end of group USART_Interrupt_Variables */
 
@@ -59,37 +331,6 @@ void send_data(u8 *buf, u16 len);
   @{
 */
 
-
-void config_dma(void)
-{
-  DMA_Config_T dmaConfig;
-  
-  RCM_EnableAHBPeriphClock(RCM_AHB_PERIPH_DMA1);  
-  
-  /* USART1 TX DMA1 Channel (triggered by USART1 Tx event) Config */
-  DMA_Reset(DMA1_Channel4);  
-  dmaConfig.peripheralBaseAddr = (u32)(USART1_BASE+0x04);
-  dmaConfig.memoryBaseAddr = (uint32_t)uart_tx_buf;
-  dmaConfig.dir = DMA_DIR_PERIPHERAL_DST;
-  dmaConfig.bufferSize = 0;
-  dmaConfig.peripheralInc = DMA_PERIPHERAL_INC_DISABLE;
-  dmaConfig.memoryInc = DMA_MEMORY_INC_ENABLE;
-  dmaConfig.peripheralDataSize = DMA_PERIPHERAL_DATA_SIZE_BYTE;
-  dmaConfig.memoryDataSize = DMA_MEMORY_DATA_SIZE_BYTE;
-  dmaConfig.loopMode = DMA_MODE_NORMAL;
-  dmaConfig.priority = DMA_PRIORITY_HIGH;
-  dmaConfig.M2M = DMA_M2MEN_DISABLE;
-  DMA_Config(DMA1_Channel4, &dmaConfig);
-
-  /* USART1 RX DMA1 Channel (triggered by USART1 Rx event) Config */
-  DMA_Reset(DMA1_Channel5);  
-  dmaConfig.peripheralBaseAddr = (u32)(USART1_BASE+0x04);
-  dmaConfig.memoryBaseAddr = (uint32_t)uart_rx_buf;
-  dmaConfig.dir = DMA_DIR_PERIPHERAL_SRC;
-  dmaConfig.bufferSize = MAX_LEN;
-  DMA_Config(DMA1_Channel5, &dmaConfig);
-}
-
 /*!
  * @brief       Main program
  *
@@ -100,38 +341,127 @@ void config_dma(void)
  */
 int main(void)
 {
-
-	char sbuf[] = "start test..\r\n";
-	
+    char sbuf[] = "start test..\r\n";
     USART_Config_T USART_ConfigStruct;
+    USART_Config_T cardConfig;
+    uint16_t n;
+    uint8_t i;
 
     APM_MINI_LEDInit(LED2);
 
-    RCM_EnableAPB2PeriphClock((RCM_APB2_PERIPH_T)(RCM_APB2_PERIPH_GPIOA | RCM_APB2_PERIPH_USART1));
-
-
-    USART_ConfigStruct.baudRate = 115200;
+    USART_ConfigStruct.baudRate = UART_LIN ? LIN_BAUD_RATE : 115200;
     USART_ConfigStruct.hardwareFlow = USART_HARDWARE_FLOW_NONE;
     USART_ConfigStruct.mode = USART_MODE_TX_RX;
     USART_ConfigStruct.parity = USART_PARITY_NONE;
     USART_ConfigStruct.stopBits = USART_STOP_BIT_1;
-    USART_ConfigStruct.wordLength = USART_WORD_LEN_8B;
-    APM_MINI_COMInit(COM1, &USART_ConfigStruct);
+    USART_ConfigStruct.wordLength = UART_MULTI_DROP ? USART_WORD_LEN_9B : USART_WORD_LEN_8B;
 
-	USART_EnableDMA(USART1,USART_DMA_TX_RX);
-	
-	
+    /* ISO 7816-3 character frame, 372 card clocks per bit until PPS */
+    cardConfig = USART_ConfigStruct;
+    cardConfig.baudRate = 3600000 / 372;
+    cardConfig.parity = USART_PARITY_EVEN;
+    cardConfig.stopBits = USART_STOP_BIT_1_5;
+    cardConfig.wordLength = USART_WORD_LEN_9B;
 
-    USART_EnableInterrupt(USART1, USART_INT_IDLE);
-    NVIC_EnableIRQRequest(USART1_IRQn, 0, 0);
-	
-	config_dma();
-	
-	send_data((u8*)sbuf, strlen(sbuf));
+    /* Frames reach the main loop once their check is done, with UART_DMA_FRAME_CRC_OK if it matched */
+    if (UART_FRAME_CRC)
+    {
+        FRAME_CRC_Init();
+    }
+
+    for (i = 0; i < UART_PORT_NUM; i++)
+    {
+        UART_DMA_Init(&uartPorts[i], (UART_SMARTCARD && (i == SMARTCARD_PORT)) ? &cardConfig : &USART_ConfigStruct);
+        UART_DMA_LatencyReset(&echoLatency[i]);
+    }
+
+    if (UART_MODBUS)
+    {
+        /* Input register n reads n, discrete input byte n reads n */
+        for (n = 0; n < MODBUS_REG_NUM; n++)
+        {
+            modbusInput[n] = MODBUS_REG(n);
+        }
+        for (n = 0; n < MODBUS_BIT_NUM / 8; n++)
+        {
+            modbusDiscrete[n] = n;
+        }
+        for (i = 0; i < UART_PORT_NUM; i++)
+        {
+            MODBUS_Init(&modbusSlaves[i]);
+        }
+    }
+
+    if (UART_SMARTCARD)
+    {
+        SC_Init(&scReader);
+    }
 
+    if (UART_LIN)
+    {
+        for (i = 0; i < UART_PORT_NUM; i++)
+        {
+            LIN_Init(&linNodes[i]);
+        }
+    }
+    else if (!UART_AUTOBAUD)
+    {
+        /* No text on a LIN bus, nor before USART1 knows its rate */
+        UART_DMA_Write(&uartPorts[0], (uint8_t*)sbuf, strlen(sbuf));
+    }
+
+#if defined (UART_DMA_BENCH)
+    /* USART2 drives USART1 over a loopback, results are sent on USART3 */
+    BENCH_Main(&uartPorts[0], &uartPorts[1], &uartPorts[2]);
+#endif
+
+    if (UART_LOW_POWER)
+    {
+        /* WFI enters Sleep mode: SRAM stays clocked for the DMA, the flash interface stops */
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+        RCM_EnableAHBPeriphClock(RCM_AHB_PERIPH_SRAM);
+        RCM_DisableAHBPeriphClock(RCM_AHB_PERIPH_FMC);
+        lowPower.wakeStamp = UART_DMA_TIMESTAMP();
+    }
+
+    /* Frames are queued by the port ISRs and echoed or answered here, outside interrupt context */
     while (1)
     {
-		
+        for (i = 0; i < UART_PORT_NUM; i++)
+        {
+            if (UART_MODBUS)
+            {
+                MODBUS_Poll(&modbusSlaves[i]);
+                continue;
+            }
+
+            if (UART_LIN)
+            {
+                LIN_Poll(&linNodes[i]);
+                continue;
+            }
+
+            if (UART_SMARTCARD && (i == SMARTCARD_PORT))
+            {
+                card_demo(&scReader);
+                continue;
+            }
+
+            while ((echoFrames[i].len != 0) || UART_DMA_GetFrame(&uartPorts[i], &echoFrames[i]))
+            {
+                if (!echo_frame(&uartPorts[i], &echoFrames[i]))
+                {
+                    break;
+                }
+
+                UART_DMA_LatencyAdd(&echoLatency[i], UART_DMA_FrameAge(&echoFrames[i]));
+            }
+        }
+
+        if (UART_LOW_POWER)
+        {
+            low_power_wait();
+        }
     }
 }
 
@@ -151,41 +481,207 @@ void Delay(void)
 }
 
 /*!
- * @brief       USART1_Interrupt
+ * @brief       Echo a received frame back on the port it came from
+ *
+ * @param       port: receiving port
+ *
+ * @param       frame: frame descriptor taken from the port queue, advanced
+ *                     over the bytes queued for sending
+ *
+ * @retval      1 if the whole frame was queued, 0 if the send pool is full
+ *
+ */
+uint8_t echo_frame(UART_DMA_Port_T* port, UART_DMA_Frame_T* frame)
+{
+    UART_DMA_Segment_T seg[2];
+    uint16_t queued;
+    uint8_t i;
+    uint8_t count = UART_DMA_FrameSegments(port, frame, seg);
+
+    for (i = 0; i < count; i++)
+    {
+        queued = UART_DMA_Write(port, seg[i].data, seg[i].len);
+        frame->offset = (frame->offset + queued) % port->rxRingSize;
+        frame->len -= queued;
+
+        /* Retry the rest once a send buffer is free */
+        if (queued < seg[i].len)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*!
+ * @brief       Sleep until the next port interrupt once every frame is handled
  *
  * @param       None
  *
  * @retval      None
  *
+ * @note        Interrupts stay masked from the check to WFI, which still
+ *              wakes on a pending one, so a frame queued in between is not
+ *              slept over. The ports wake the core on line idle and on the
+ *              DMA half and full ring events, UART5 without RX DMA on every
+ *              byte. A frame waiting for a send buffer keeps the core asleep
+ *              only while a send is in flight to free one.
  */
-void send_data(u8 *buf, u16 len)
+void low_power_wait(void)
 {
-  memcpy(uart_tx_buf, buf, len);
-  while(USART_ReadStatusFlag(USART1, USART_FLAG_TXBE) == RESET);
-  DMA_Disable(DMA1_Channel4);
-  DMA_ConfigDataNumber(DMA1_Channel4, len);
-  DMA_Enable(DMA1_Channel4);
-	
-}
+    uint32_t now;
+    uint8_t i;
+
+    __disable_irq();
+
+    for (i = 0; i < UART_PORT_NUM; i++)
+    {
+        if (UART_DMA_FramePending(&uartPorts[i]) || ((echoFrames[i].len != 0) && (uartPorts[i].txFirst == NULL)))
+        {
+            __enable_irq();
+            return;
+        }
+    }
+
+    now = UART_DMA_TIMESTAMP();
+    lowPower.awakeCycles += now - lowPower.wakeStamp;
+    lowPower.sleeps++;
 
+    __WFI();
 
-void USART1_Isr(void)
+    lowPower.wakeStamp = UART_DMA_TIMESTAMP();
+    __enable_irq();
+}
+
+/*!
+ * @brief       Awake core cycles per kilobyte received, the energy proxy of UART_LOW_POWER
+ *
+ * @param       None
+ *
+ * @retval      Awake cycles up to the last WFI per 1024 bytes handed to the
+ *              consumers, 0 before the first byte
+ */
+uint32_t low_power_cycles_per_kb(void)
 {
-	u16 tmp_len;
-    if(USART_ReadIntFlag(USART1, USART_INT_IDLE))
+    UART_DMA_Stats_T stats;
+    uint32_t bytes = 0;
+    uint8_t i;
+
+    for (i = 0; i < UART_PORT_NUM; i++)
     {
-	   USART_RxData(USART1); 
-       DMA_Disable(DMA1_Channel5);
-  	   tmp_len = MAX_LEN - DMA_ReadDataNumber(DMA1_Channel5);
-	   DMA_ConfigDataNumber(DMA1_Channel5, MAX_LEN);
-	   send_data(uart_rx_buf, tmp_len);  //send received data;
-	   DMA_Enable(DMA1_Channel5);
+        UART_DMA_ReadStats(&uartPorts[i], &stats, 0);
+        bytes += stats.rxBytes;
     }
+
+    return bytes ? (uint32_t)(lowPower.awakeCycles * 1024 / bytes) : 0;
 }
 
+/*!
+ * @brief       Run one command of the card reader demo
+ *
+ * @param       card: card reader
+ *
+ * @retval      None
+ *
+ * @note        Activates the card first. Then writes a block of the current
+ *              file with UPDATE BINARY, reads it back with READ BINARY and
+ *              compares it, and asks for INTERNAL AUTHENTICATE and GET
+ *              CHALLENGE, long blocks chained in T=1. A failed command
+ *              activates the card again.
+ */
+void card_demo(SC_Card_T* card)
+{
+    static uint8_t active;
+    static uint32_t seq;
+    /* Command data goes out by DMA, kept off the stack */
+    static uint8_t cmd[SC_APDU_MAX];
+    static uint8_t resp[SC_RESPONSE_MAX];
+    uint16_t respLen;
+    uint16_t cmdLen;
+    uint8_t offset;
+    uint8_t len;
+    uint8_t ok;
+    uint8_t k;
+
+    if (!active)
+    {
+        active = SC_Activate(card);
+        return;
+    }
+
+    /* Write and read back pairs share offset, length and data */
+    offset = (uint8_t)((seq / 4) * 13 % (SMARTCARD_FILE_SIZE - 200));
+    len = (uint8_t)(1 + (seq / 4) * 37 % 200);
 
+    cmd[0] = 0x00;
+    cmd[2] = 0x00;
+    cmd[3] = offset;
+    switch (seq % 4)
+    {
+        case 0:
+            /* UPDATE BINARY */
+            cmd[1] = 0xD6;
+            cmd[4] = len;
+            for (k = 0; k < len; k++)
+            {
+                cmd[5 + k] = (uint8_t)(seq + 7 * k);
+            }
+            cmdLen = 5 + len;
+            break;
+        case 1:
+            /* READ BINARY */
+            cmd[1] = 0xB0;
+            cmd[4] = len;
+            cmdLen = 5;
+            break;
+        case 2:
+            /* INTERNAL AUTHENTICATE, 8 byte challenge in and out */
+            cmd[1] = 0x88;
+            cmd[3] = 0x00;
+            cmd[4] = 8;
+            memset(&cmd[5], (uint8_t)seq, 8);
+            cmd[13] = 8;
+            cmdLen = 14;
+            break;
+        default:
+            /* GET CHALLENGE */
+            cmd[1] = 0x84;
+            cmd[3] = 0x00;
+            cmd[4] = 8;
+            cmdLen = 5;
+            break;
+    }
 
+    if (!SC_Transceive(card, cmd, cmdLen, resp, &respLen))
+    {
+        /* Start over with a new write */
+        seq = (seq | 3) + 1;
+        active = 0;
+        return;
+    }
 
+    ok = (SC_SW(resp, respLen) == SC_SW_OK);
+    switch (seq % 4)
+    {
+        case 0:
+            ok = ok && (respLen == 2);
+            break;
+        case 1:
+            ok = ok && (respLen == len + 2);
+            for (k = 0; ok && (k < len); k++)
+            {
+                ok = (resp[k] == (uint8_t)(seq - 1 + 7 * k));
+            }
+            break;
+        default:
+            ok = ok && (respLen == 8 + 2);
+            break;
+    }
+
+    cardMismatches += !ok;
+    seq++;
+}
 
 /**@} end of group USART_Interrupt_Functions */
 /**@} end of group USART_Interrupt */
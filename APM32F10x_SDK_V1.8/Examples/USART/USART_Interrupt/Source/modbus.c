@@ -0,0 +1,469 @@
+/*!
+ * @file        modbus.c
+ *
+ * @brief       Modbus RTU slave on the UART DMA frame queue
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * The port DMA fills the receive ring and its idle interrupt queues each
+ * request as one frame descriptor, so the interrupt work does not depend on
+ * the frame length. Everything else runs in MODBUS_Poll(): the CRC-16 check,
+ * the request and the response, which the port sends by DMA. A register
+ * read is sent as three segments, the header from the response buffer, the
+ * values straight from the register table and the check.
+ */
+
+/* Includes */
+#include "modbus.h"
+#include <string.h>
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup MODBUS_Macros Macros
+  @{
+*/
+
+/* Reflected CRC-16 polynomial, 0x8005 bit reversed */
+#define MODBUS_CRC_POLY         0xA001
+
+/* Largest counts of one request */
+#define MODBUS_READ_BITS_MAX    2000
+#define MODBUS_READ_REGS_MAX    125
+#define MODBUS_WRITE_BITS_MAX   1968
+#define MODBUS_WRITE_REGS_MAX   123
+
+/**@} end of group MODBUS_Macros */
+
+/** @defgroup MODBUS_Variables Variables
+  @{
+*/
+
+/* CRC-16 of each byte value, built by MODBUS_Init() in SRAM, which has no flash wait states */
+static uint16_t modbusCrcTable[256];
+
+/**@} end of group MODBUS_Variables */
+
+/** @defgroup MODBUS_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Reset a slave, its public fields set
+ *
+ * @param       slave: slave with port, address and tables filled in
+ *
+ * @retval      None
+ */
+void MODBUS_Init(MODBUS_Slave_T* slave)
+{
+    uint16_t crc;
+    uint16_t n;
+    uint8_t k;
+
+    for (n = 0; n < 256; n++)
+    {
+        crc = n;
+        for (k = 0; k < 8; k++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ MODBUS_CRC_POLY) : (crc >> 1);
+        }
+        modbusCrcTable[n] = crc;
+    }
+
+    memset(&slave->stats, 0, sizeof(slave->stats));
+    slave->busy = 0;
+    slave->skip = 0;
+}
+
+/*!
+ * @brief       Compute the Modbus CRC-16 of a byte sequence
+ *
+ * @param       crc: MODBUS_CRC_INIT, or the value returned for the bytes before
+ *
+ * @param       data: bytes
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      CRC-16 value, 0 over a frame that ends in its check
+ */
+uint16_t MODBUS_Crc16(uint16_t crc, const uint8_t* data, uint32_t len)
+{
+    while (len--)
+    {
+        crc = (crc >> 8) ^ modbusCrcTable[(crc ^ *data++) & 0xFF];
+    }
+
+    return crc;
+}
+
+/*!
+ * @brief       Response sent, the buffers may be used again
+ *
+ * @param       req: response request of the slave
+ *
+ * @retval      None
+ */
+static void MODBUS_Sent(UART_DMA_Request_T* req)
+{
+    ((MODBUS_Slave_T*)req->context)->busy = 0;
+}
+
+/*!
+ * @brief       Pack bits of a table into response bytes
+ *
+ * @param       out: response bytes, least significant bit first
+ *
+ * @param       bits: table
+ *
+ * @param       start: first bit
+ *
+ * @param       count: number of bits
+ *
+ * @retval      None
+ */
+static void MODBUS_ReadBits(uint8_t* out, const uint8_t* bits, uint16_t start, uint16_t count)
+{
+    uint16_t i;
+
+    memset(out, 0, (count + 7) / 8);
+
+    for (i = 0; i < count; i++)
+    {
+        if (bits[(start + i) >> 3] & (1 << ((start + i) & 7)))
+        {
+            out[i >> 3] |= 1 << (i & 7);
+        }
+    }
+}
+
+/*!
+ * @brief       Unpack request bytes into bits of a table
+ *
+ * @param       bits: table
+ *
+ * @param       in: request bytes, least significant bit first
+ *
+ * @param       start: first bit
+ *
+ * @param       count: number of bits
+ *
+ * @retval      None
+ */
+static void MODBUS_WriteBits(uint8_t* bits, const uint8_t* in, uint16_t start, uint16_t count)
+{
+    uint16_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (in[i >> 3] & (1 << (i & 7)))
+        {
+            bits[(start + i) >> 3] |= 1 << ((start + i) & 7);
+        }
+        else
+        {
+            bits[(start + i) >> 3] &= ~(1 << ((start + i) & 7));
+        }
+    }
+}
+
+/*!
+ * @brief       Carry out one request and queue its response
+ *
+ * @param       slave: idle slave
+ *
+ * @param       req: request frame, may be the slave response buffer
+ *
+ * @param       len: frame length with the check
+ *
+ * @retval      None
+ *
+ * @note        The response is built over the request once its fields are read.
+ */
+static void MODBUS_Request(MODBUS_Slave_T* slave, const uint8_t* req, uint16_t len)
+{
+    MODBUS_Stats_T* stats = &slave->stats;
+    uint8_t* rsp = slave->adu;
+    const uint16_t* regs = NULL;
+    const uint8_t* bits;
+    uint32_t num;
+    uint16_t crc;
+    uint16_t start = 0;
+    uint16_t count = 0;
+    uint16_t rspLen = 0;
+    uint8_t function;
+    uint8_t exception = 0;
+    uint8_t written = 0;
+    uint8_t n;
+
+    if ((len < 4) || (MODBUS_Crc16(MODBUS_CRC_INIT, req, len) != 0))
+    {
+        stats->crcErrors++;
+        return;
+    }
+
+    if ((req[0] != slave->address) && (req[0] != MODBUS_BROADCAST))
+    {
+        stats->others++;
+        return;
+    }
+
+    stats->requests++;
+    function = req[1];
+    len -= 2;
+    if (len >= 6)
+    {
+        start = ((uint16_t)req[2] << 8) | req[3];
+        count = ((uint16_t)req[4] << 8) | req[5];
+    }
+
+    switch (function)
+    {
+        case MODBUS_FC_READ_COILS:
+        case MODBUS_FC_READ_DISCRETE_INPUTS:
+            bits = (function == MODBUS_FC_READ_COILS) ? slave->coils : slave->discreteInputs;
+            num = (function == MODBUS_FC_READ_COILS) ? slave->coilNum : slave->discreteNum;
+            if ((len != 6) || (count == 0) || (count > MODBUS_READ_BITS_MAX))
+            {
+                exception = MODBUS_EX_ILLEGAL_VALUE;
+            }
+            else if ((bits == NULL) || ((uint32_t)start + count > num))
+            {
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+            }
+            else
+            {
+                MODBUS_ReadBits(&rsp[3], bits, start, count);
+                rsp[2] = (count + 7) / 8;
+                rspLen = 3 + rsp[2];
+            }
+            break;
+
+        case MODBUS_FC_READ_HOLDING_REGS:
+        case MODBUS_FC_READ_INPUT_REGS:
+            regs = (function == MODBUS_FC_READ_HOLDING_REGS) ? slave->holdingRegs : slave->inputRegs;
+            num = (function == MODBUS_FC_READ_HOLDING_REGS) ? slave->holdingNum : slave->inputNum;
+            if ((len != 6) || (count == 0) || (count > MODBUS_READ_REGS_MAX))
+            {
+                exception = MODBUS_EX_ILLEGAL_VALUE;
+            }
+            else if ((regs == NULL) || ((uint32_t)start + count > num))
+            {
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+            }
+            else
+            {
+                /* The values follow the header straight from the table */
+                regs += start;
+                rsp[2] = 2 * count;
+                rspLen = 3;
+            }
+            break;
+
+        case MODBUS_FC_WRITE_COIL:
+            if ((len != 6) || ((count != 0xFF00) && (count != 0x0000)))
+            {
+                exception = MODBUS_EX_ILLEGAL_VALUE;
+            }
+            else if ((slave->coils == NULL) || (start >= slave->coilNum))
+            {
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+            }
+            else
+            {
+                n = (count != 0);
+                MODBUS_WriteBits(slave->coils, &n, start, 1);
+                count = 1;
+                written = 1;
+            }
+            break;
+
+        case MODBUS_FC_WRITE_REG:
+            if (len != 6)
+            {
+                exception = MODBUS_EX_ILLEGAL_VALUE;
+            }
+            else if ((slave->holdingRegs == NULL) || (start >= slave->holdingNum))
+            {
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+            }
+            else
+            {
+                memcpy(&slave->holdingRegs[start], &req[4], 2);
+                count = 1;
+                written = 1;
+            }
+            break;
+
+        case MODBUS_FC_WRITE_COILS:
+            if ((len < 7) || (count == 0) || (count > MODBUS_WRITE_BITS_MAX) ||
+                (req[6] != (count + 7) / 8) || (len != 7 + req[6]))
+            {
+                exception = MODBUS_EX_ILLEGAL_VALUE;
+            }
+            else if ((slave->coils == NULL) || ((uint32_t)start + count > slave->coilNum))
+            {
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+            }
+            else
+            {
+                MODBUS_WriteBits(slave->coils, &req[7], start, count);
+                written = 1;
+            }
+            break;
+
+        case MODBUS_FC_WRITE_REGS:
+            if ((len < 7) || (count == 0) || (count > MODBUS_WRITE_REGS_MAX) ||
+                (req[6] != 2 * count) || (len != 7 + req[6]))
+            {
+                exception = MODBUS_EX_ILLEGAL_VALUE;
+            }
+            else if ((slave->holdingRegs == NULL) || ((uint32_t)start + count > slave->holdingNum))
+            {
+                exception = MODBUS_EX_ILLEGAL_ADDRESS;
+            }
+            else
+            {
+                memcpy(&slave->holdingRegs[start], &req[7], 2 * count);
+                written = 1;
+            }
+            break;
+
+        default:
+            exception = MODBUS_EX_ILLEGAL_FUNCTION;
+            break;
+    }
+
+    if (written)
+    {
+        /* Writes are answered with the address and count or value of the request */
+        memmove(rsp, req, 6);
+        rspLen = 6;
+
+        if (slave->writeCallback != NULL)
+        {
+            slave->writeCallback(slave, function, start, count);
+        }
+    }
+
+    if (req[0] == MODBUS_BROADCAST)
+    {
+        stats->broadcasts++;
+        return;
+    }
+
+    rsp[0] = slave->address;
+    rsp[1] = function;
+    if (exception)
+    {
+        rsp[1] |= 0x80;
+        rsp[2] = exception;
+        rspLen = 3;
+        regs = NULL;
+        stats->exceptions++;
+    }
+
+    crc = MODBUS_Crc16(MODBUS_CRC_INIT, rsp, rspLen);
+    slave->segments[0].data = rsp;
+    slave->segments[0].len = rspLen;
+    n = 1;
+
+    if (regs != NULL)
+    {
+        crc = MODBUS_Crc16(crc, (const uint8_t*)regs, 2 * count);
+        slave->segments[n].data = (const uint8_t*)regs;
+        slave->segments[n].len = 2 * count;
+        n++;
+    }
+
+    slave->crc[0] = (uint8_t)crc;
+    slave->crc[1] = (uint8_t)(crc >> 8);
+    slave->segments[n].data = slave->crc;
+    slave->segments[n].len = 2;
+    n++;
+
+    slave->response.segments = slave->segments;
+    slave->response.count = n;
+    slave->response.callback = MODBUS_Sent;
+    slave->response.context = slave;
+
+    slave->busy = 1;
+    UART_DMA_Send(slave->port, &slave->response);
+    stats->responses++;
+}
+
+/*!
+ * @brief       Carry out the requests the port has received
+ *
+ * @param       slave: slave
+ *
+ * @retval      None
+ *
+ * @note        Call from the main loop. A request waits in the port frame
+ *              queue while the response to the one before is sent.
+ */
+void MODBUS_Poll(MODBUS_Slave_T* slave)
+{
+    UART_DMA_Frame_T frame;
+    UART_DMA_Segment_T seg[2];
+    const uint8_t* req;
+
+    while (!slave->busy && UART_DMA_GetFrame(slave->port, &frame))
+    {
+        /* Pieces of a frame longer than half the ring, never a request */
+        if (!(frame.flags & UART_DMA_FRAME_END))
+        {
+            slave->skip = 1;
+            continue;
+        }
+
+        if (slave->skip || (frame.len > MODBUS_ADU_MAX))
+        {
+            slave->skip = 0;
+            slave->stats.overlong++;
+            continue;
+        }
+
+        /* A frame that wraps over the end of the ring is taken in one piece */
+        if (UART_DMA_FrameSegments(slave->port, &frame, seg) == 2)
+        {
+            memcpy(slave->adu, seg[0].data, seg[0].len);
+            memcpy(&slave->adu[seg[0].len], seg[1].data, seg[1].len);
+            req = slave->adu;
+        }
+        else
+        {
+            req = seg[0].data;
+        }
+
+        MODBUS_Request(slave, req, frame.len);
+    }
+}
+
+/**@} end of group MODBUS_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
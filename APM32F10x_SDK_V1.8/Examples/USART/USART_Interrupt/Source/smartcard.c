@@ -0,0 +1,1159 @@
+/*!
+ * @file        smartcard.c
+ *
+ * @brief       ISO 7816-3 smart card reader on a UART_DMA port
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/*
+ * The card answers reset at Fi/Di 372/1, one etu being 372 card clocks. TA1
+ * of the answer gives the rate it can go to, PPS asks for it: the highest
+ * Di the card offers whose USART divider 2 * PSC * Fi / Di is 16 or more
+ * and within 2 % of an integer. A card that answers PPS without PPS1 stays
+ * at 372/1, one that answers it wrongly is reset again and used at 372/1.
+ *
+ * T=0 sends the 5 byte command header and follows the procedure bytes:
+ * NULL waits on, INS moves all remaining data, ~INS one byte, 61xx fetches
+ * the response with GET RESPONSE, 6Cxx sends the header again with the
+ * right length. T=1 sends blocks of NAD, PCB, LEN, up to IFSC information
+ * bytes and an LRC, chains longer commands and responses, asks for a
+ * block again with an R-block when its LRC or length is wrong and extends
+ * the block waiting time on S(WTX).
+ *
+ * The USART drives the open drain I/O line and turns its receiver off until
+ * TC, so nothing sent is read back. Received bytes reach SC_Receive() on
+ * line idle or at a ring half, the waiting times allow for that delay.
+ */
+
+/* Includes */
+#include "smartcard.h"
+#include "apm32f10x_rcm.h"
+#include <string.h>
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup SC_Macros Macros
+  @{
+*/
+
+/* Initial character, inverse convention 0x3F reads as 0x03 */
+#define SC_TS_DIRECT            0x3B
+
+/* Fi/Di of the answer to reset */
+#define SC_TA1_DEFAULT          0x11
+
+/* Cold and warm reset: RST low for at least 400 clocks, TS within 40000 clocks of RST high */
+#define SC_RESET_CLOCKS         500
+#define SC_TS_CLOCKS            40000
+
+/* Initial waiting time between answer to reset and PPS characters */
+#define SC_INITIAL_WAIT_ETU     9600
+
+/* PPS start byte and PPS0 bit announcing PPS1 */
+#define SC_PPSS                 0xFF
+#define SC_PPS0_PPS1            0x10
+
+/* T=0 procedure byte to wait on */
+#define SC_NULL                 0x60
+
+/* T=1 protocol control byte */
+#define SC_PCB_R                0x80
+#define SC_PCB_S                0xC0
+#define SC_PCB_TYPE             0xC0
+#define SC_PCB_I_NS             0x40
+#define SC_PCB_I_MORE           0x20
+#define SC_PCB_R_NR             0x10
+#define SC_PCB_R_EDC            0x01
+#define SC_PCB_S_RESPONSE       0x20
+#define SC_S_IFS                0x01
+#define SC_S_WTX                0x03
+
+/* T=1 block received */
+#define SC_BLOCK_OK             0
+#define SC_BLOCK_BAD            1
+#define SC_BLOCK_NONE           2
+
+/* T=1 repeats of a block before giving up */
+#define SC_T1_TRIES             3
+
+/**@} end of group SC_Macros */
+
+/** @defgroup SC_Variables Variables
+  @{
+*/
+
+/* Clock rate conversion Fi and baud rate adjustment Di by TA1 nibble, 0 where RFU */
+static const uint16_t scFi[16] = {372, 372, 558, 744, 1116, 1488, 1860, 0, 0, 512, 768, 1024, 1536, 2048, 0, 0};
+static const uint8_t scDi[16] = {0, 1, 2, 4, 8, 16, 32, 64, 12, 20, 0, 0, 0, 0, 0, 0};
+
+/* Cards by port, for the engine callback */
+static SC_Card_T* scCard[SC_CARD_NUM];
+
+/**@} end of group SC_Variables */
+
+/** @defgroup SC_Functions Functions
+  @{
+*/
+
+/*!
+ * @brief       Transmit callback, tx may be written again
+ *
+ * @param       req: transmit request of a card
+ *
+ * @retval      None
+ */
+static void SC_Sent(UART_DMA_Request_T* req)
+{
+    ((SC_Card_T*)req->context)->busy = 0;
+}
+
+/*!
+ * @brief       Set up a card, its port initialized in smart card mode with
+ *              rxCallback = SC_Receive
+ *
+ * @param       card: card with port and RST pin filled in
+ *
+ * @retval      None
+ *
+ * @note        RST is driven low, the card is activated by SC_Activate().
+ */
+void SC_Init(SC_Card_T* card)
+{
+    GPIO_Config_T gpioConfig;
+    uint32_t pclk1, pclk2;
+    uint8_t i;
+
+    memset(&card->stats, 0, sizeof(card->stats));
+    card->rxHead = 0;
+    card->rxTail = 0;
+    card->atrLen = 0;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+    card->clockHz = ((card->port->usart == USART1) ? pclk2 : pclk1) / (2 * card->port->smartCard->prescaler);
+
+    RCM_EnableAPB2PeriphClock(RCM_APB2_PERIPH_GPIOA << (((uint32_t)card->rstPort - GPIOA_BASE) / (GPIOB_BASE - GPIOA_BASE)));
+    GPIO_ResetBit(card->rstPort, card->rstPin);
+    gpioConfig.mode = GPIO_MODE_OUT_PP;
+    gpioConfig.pin = card->rstPin;
+    gpioConfig.speed = GPIO_SPEED_50MHz;
+    GPIO_Config(card->rstPort, &gpioConfig);
+
+    card->request.segments = &card->segment;
+    card->request.count = 1;
+    card->busy = 0;
+    card->request.callback = SC_Sent;
+    card->request.context = card;
+
+    for (i = 0; i < SC_CARD_NUM; i++)
+    {
+        if ((scCard[i] == NULL) || (scCard[i]->port == card->port))
+        {
+            scCard[i] = card;
+            break;
+        }
+    }
+}
+
+/*!
+ * @brief       Find the card of a port
+ *
+ * @param       port: UART port
+ *
+ * @retval      Card set up with SC_Init(), NULL if none
+ */
+static SC_Card_T* SC_Find(UART_DMA_Port_T* port)
+{
+    uint8_t i;
+
+    for (i = 0; i < SC_CARD_NUM; i++)
+    {
+        if ((scCard[i] != NULL) && (scCard[i]->port == port))
+        {
+            return scCard[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+ * @brief       Receive callback of a card port, buffers the bytes
+ *
+ * @param       port: card port
+ *
+ * @param       data: bytes received
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      None
+ *
+ * @note        Runs in the port interrupt. Bytes that do not fit are lost,
+ *              the command then fails on its length or check.
+ */
+void SC_Receive(UART_DMA_Port_T* port, const uint8_t* data, uint16_t len)
+{
+    SC_Card_T* card = SC_Find(port);
+    uint16_t head;
+    uint16_t next;
+
+    if (card == NULL)
+    {
+        return;
+    }
+
+    head = card->rxHead;
+    while (len--)
+    {
+        next = (head + 1) % SC_RX_SIZE;
+        if (next == card->rxTail)
+        {
+            break;
+        }
+        card->rx[head] = *data++;
+        head = next;
+    }
+    card->rxHead = head;
+}
+
+/*!
+ * @brief       Convert a waiting time to UART_DMA_TIMESTAMP() units
+ *
+ * @param       card: card
+ *
+ * @param       etu: waiting time in elementary time units at the current rate
+ *
+ * @retval      Timeout, with the delivery delay of the port added
+ */
+static uint32_t SC_Timeout(SC_Card_T* card, uint32_t etu)
+{
+    uint64_t timeout;
+
+    /* Bytes may wait for line idle or a ring half before they are handed on */
+    timeout = ((uint64_t)etu + 12 * (card->port->rxRingSize / 2 + 2)) * card->port->bitTime;
+
+    return (timeout > 0x7FFFFFFF) ? 0x7FFFFFFF : (uint32_t)timeout;
+}
+
+/*!
+ * @brief       Wait a number of card clocks
+ *
+ * @param       card: card
+ *
+ * @param       clocks: card clock cycles
+ *
+ * @retval      None
+ */
+static void SC_Delay(SC_Card_T* card, uint32_t clocks)
+{
+    uint32_t start = UART_DMA_TIMESTAMP();
+    uint32_t wait = (uint32_t)((uint64_t)clocks * UART_DMA_TIMESTAMP_HZ / card->clockHz);
+
+    while (UART_DMA_TIMESTAMP() - start < wait)
+    {
+    }
+}
+
+/*!
+ * @brief       Take the next byte the card sent
+ *
+ * @param       card: card
+ *
+ * @param       byte: byte read
+ *
+ * @param       timeout: UART_DMA_TIMESTAMP() units to wait, from SC_Timeout()
+ *
+ * @retval      1 if a byte was read, 0 on timeout
+ */
+static uint8_t SC_ReadByte(SC_Card_T* card, uint8_t* byte, uint32_t timeout)
+{
+    uint32_t start = UART_DMA_TIMESTAMP();
+
+    while (card->rxTail == card->rxHead)
+    {
+        if (UART_DMA_TIMESTAMP() - start > timeout)
+        {
+            card->stats.timeouts++;
+            return 0;
+        }
+    }
+
+    *byte = card->rx[card->rxTail];
+    card->rxTail = (card->rxTail + 1) % SC_RX_SIZE;
+
+    return 1;
+}
+
+/*!
+ * @brief       Send bytes to the card and wait until they are handed to the USART
+ *
+ * @param       card: card
+ *
+ * @param       data: bytes, sent straight from memory
+ *
+ * @param       len: number of bytes
+ *
+ * @retval      None
+ *
+ * @note        Whatever the card sent before is dropped, its answer can
+ *              only start after the last character.
+ */
+static void SC_Send(SC_Card_T* card, const uint8_t* data, uint16_t len)
+{
+    card->rxTail = card->rxHead;
+
+    card->segment.data = data;
+    card->segment.len = len;
+    card->busy = 1;
+    UART_DMA_Send(card->port, &card->request);
+
+    while (card->busy)
+    {
+    }
+}
+
+/*!
+ * @brief       Turn the card clock on or off
+ *
+ * @param       card: card
+ *
+ * @param       on: 1 to run the clock
+ *
+ * @retval      None
+ */
+static void SC_Clock(SC_Card_T* card, uint8_t on)
+{
+    USART_ClockConfig_T clockConfig;
+
+    USART_ConfigClockStructInit(&clockConfig);
+    clockConfig.clock = on ? USART_CLKEN_ENABLE : USART_CLKEN_DISABLE;
+    USART_ConfigClock(card->port->usart, &clockConfig);
+}
+
+/*!
+ * @brief       Set the line rate for a Fi and Di index
+ *
+ * @param       card: card
+ *
+ * @param       fi: Fi index, TA1 high nibble
+ *
+ * @param       di: Di index, TA1 low nibble
+ *
+ * @retval      None
+ */
+static void SC_ConfigRate(SC_Card_T* card, uint8_t fi, uint8_t di)
+{
+    card->fi = fi;
+    card->di = di;
+    UART_DMA_ConfigBaudRate(card->port, (card->clockHz * scDi[di] + scFi[fi] / 2) / scFi[fi]);
+}
+
+/*!
+ * @brief       Read one answer to reset byte
+ *
+ * @param       card: card
+ *
+ * @param       byte: byte read, also appended to card->atr
+ *
+ * @param       timeout: UART_DMA_TIMESTAMP() units to wait
+ *
+ * @retval      1 if a byte was read, 0 on timeout or an overlong answer
+ */
+static uint8_t SC_AtrByte(SC_Card_T* card, uint8_t* byte, uint32_t timeout)
+{
+    if ((card->atrLen >= SC_ATR_MAX) || !SC_ReadByte(card, byte, timeout))
+    {
+        return 0;
+    }
+
+    card->atr[card->atrLen++] = *byte;
+
+    return 1;
+}
+
+/*!
+ * @brief       Read and parse the answer to reset, RST just released
+ *
+ * @param       card: card
+ *
+ * @retval      1 for a direct convention answer offering T=0 or T=1 with a
+ *              good TCK, 0 otherwise
+ */
+static uint8_t SC_ReadAtr(SC_Card_T* card)
+{
+    uint32_t timeout = SC_Timeout(card, SC_INITIAL_WAIT_ETU);
+    uint8_t y;
+    uint8_t hist;
+    uint8_t t = 0;
+    uint8_t t1Group = 0;
+    uint8_t tck = 0;
+    uint8_t check = 0;
+    uint8_t group;
+    uint8_t byte;
+    uint8_t i;
+
+    card->atrLen = 0;
+    card->ta1 = SC_TA1_DEFAULT;
+    card->specific = 0;
+    card->guard = 0;
+    card->wi = 10;
+    card->cwi = 13;
+    card->bwi = 4;
+    card->ifsc = 32;
+    card->protocol = 0xFF;
+
+    if (!SC_AtrByte(card, &byte, SC_Timeout(card, 0) + (uint32_t)((uint64_t)SC_TS_CLOCKS * UART_DMA_TIMESTAMP_HZ / card->clockHz)) ||
+        (byte != SC_TS_DIRECT))
+    {
+        return 0;
+    }
+
+    if (!SC_AtrByte(card, &byte, timeout))
+    {
+        return 0;
+    }
+    y = byte & 0xF0;
+    hist = byte & 0x0F;
+
+    /* Interface byte groups: TAi, TBi, TCi, TDi as TDi-1 or T0 announces them */
+    for (group = 1; y != 0; group++)
+    {
+        if (y & 0x10)
+        {
+            if (!SC_AtrByte(card, &byte, timeout))
+            {
+                return 0;
+            }
+            if (group == 1)
+            {
+                card->ta1 = byte;
+            }
+            else if (group == 2)
+            {
+                /* Specific mode, bit 5 set for implicit parameters in place of TA1 */
+                card->specific = (byte & 0x10) ? 2 : 1;
+            }
+            else if (group == t1Group)
+            {
+                card->ifsc = byte;
+            }
+        }
+
+        if (y & 0x20)
+        {
+            if (!SC_AtrByte(card, &byte, timeout))
+            {
+                return 0;
+            }
+            if (group == t1Group)
+            {
+                card->bwi = byte >> 4;
+                card->cwi = byte & 0x0F;
+            }
+        }
+
+        if (y & 0x40)
+        {
+            if (!SC_AtrByte(card, &byte, timeout))
+            {
+                return 0;
+            }
+            if (group == 1)
+            {
+                card->guard = byte;
+            }
+            else if (group == 2)
+            {
+                card->wi = byte;
+            }
+            else if ((group == t1Group) && (byte & 0x01))
+            {
+                /* CRC error detection is not supported */
+                return 0;
+            }
+        }
+
+
+        if (y & 0x80)
+        {
+            if (!SC_AtrByte(card, &byte, timeout))
+            {
+                return 0;
+            }
+            y = byte & 0xF0;
+            t = byte & 0x0F;
+
+            /* TCK follows unless only T=0 is listed, T=15 holds global bytes */
+            tck |= (t != 0);
+            if ((card->protocol == 0xFF) && (t != 15))
+            {
+                card->protocol = t;
+            }
+            if ((t == 1) && (t1Group == 0) && (group >= 2))
+            {
+                t1Group = group + 1;
+            }
+        }
+        else
+        {
+            y = 0;
+        }
+    }
+
+    for (i = 0; i < hist + tck; i++)
+    {
+        if (!SC_AtrByte(card, &byte, timeout))
+        {
+            return 0;
+        }
+    }
+
+    /* T0 up to TCK XOR to 0 */
+    for (i = 1; i < card->atrLen; i++)
+    {
+        check ^= card->atr[i];
+    }
+
+    if (card->protocol == 0xFF)
+    {
+        card->protocol = SC_PROTOCOL_T0;
+    }
+
+    return ((check == 0) || !tck) && (card->protocol <= SC_PROTOCOL_T1);
+}
+
+/*!
+ * @brief       Pick the Di index to ask for, the card at Fi of TA1
+ *
+ * @param       card: card after the answer to reset
+ *
+ * @retval      Highest Di index the USART divider allows up to the one of
+ *              TA1, 0 if the Fi of TA1 is RFU
+ */
+static uint8_t SC_PickDi(SC_Card_T* card)
+{
+    uint32_t clocks = 2 * card->port->smartCard->prescaler * scFi[card->ta1 >> 4];
+    uint32_t error;
+    uint8_t best = 0;
+    uint8_t di;
+
+    for (di = 1; (clocks != 0) && (di < 16); di++)
+    {
+        if ((scDi[di] == 0) || (scDi[di] > scDi[card->ta1 & 0x0F]) || (clocks < 16 * scDi[di]))
+        {
+            continue;
+        }
+
+        /* Divider rounding within 2 % */
+        error = clocks % scDi[di];
+        error = (error > scDi[di] / 2) ? (scDi[di] - error) : error;
+        if ((error * 50 <= clocks) && ((best == 0) || (scDi[di] > scDi[best])))
+        {
+            best = di;
+        }
+    }
+
+    return best;
+}
+
+/*!
+ * @brief       Move to the rate of TA1
+ *
+ * @param       card: card after the answer to reset, at 372/1
+ *
+ * @retval      1 if the card runs at a rate both sides agreed on, 0 if
+ *              the PPS exchange failed
+ */
+static uint8_t SC_Negotiate(SC_Card_T* card)
+{
+    uint32_t timeout = SC_Timeout(card, SC_INITIAL_WAIT_ETU);
+    uint8_t answer[6];
+    uint8_t check = 0;
+    uint8_t fi = card->ta1 >> 4;
+    uint8_t di = SC_PickDi(card);
+    uint8_t len;
+    uint8_t i;
+
+    /* Specific mode runs at TA1 straight away, or at 372/1 with implicit parameters */
+    if (card->specific)
+    {
+        if ((card->specific == 1) && (di != 0) && (scDi[di] == scDi[card->ta1 & 0x0F]))
+        {
+            SC_ConfigRate(card, fi, di);
+        }
+        return 1;
+    }
+
+    if ((di == 0) || (card->ta1 == SC_TA1_DEFAULT))
+    {
+        return 1;
+    }
+
+    card->tx[0] = SC_PPSS;
+    card->tx[1] = SC_PPS0_PPS1 | card->protocol;
+    card->tx[2] = (fi << 4) | di;
+    card->tx[3] = card->tx[0] ^ card->tx[1] ^ card->tx[2];
+    SC_Send(card, card->tx, 4);
+
+    /* PPSS, PPS0, then PPS1 to PPS3 as PPS0 lists them, PCK */
+    for (len = 0; len < 2; len++)
+    {
+        if (!SC_ReadByte(card, &answer[len], timeout))
+        {
+            return 0;
+        }
+    }
+    for (i = 0x10; i <= 0x40; i <<= 1)
+    {
+        if ((answer[1] & i) && !SC_ReadByte(card, &answer[len++], timeout))
+        {
+            return 0;
+        }
+    }
+    if (!SC_ReadByte(card, &answer[len++], timeout))
+    {
+        return 0;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        check ^= answer[i];
+    }
+
+    if ((answer[0] != SC_PPSS) || (check != 0) || ((answer[1] & 0x0F) != card->protocol))
+    {
+        return 0;
+    }
+
+    if (!(answer[1] & SC_PPS0_PPS1))
+    {
+        card->stats.ppsDeclined++;
+        return 1;
+    }
+
+    if (answer[2] != card->tx[2])
+    {
+        return 0;
+    }
+
+    card->stats.ppsDone++;
+    SC_ConfigRate(card, fi, di);
+
+    return 1;
+}
+
+/*!
+ * @brief       Send a T=1 block
+ *
+ * @param       card: card
+ *
+ * @param       pcb: protocol control byte
+ *
+ * @param       inf: information field, may be NULL when len is 0
+ *
+ * @param       len: information field length, up to SC_IFSD
+ *
+ * @retval      None
+ */
+static void SC_T1Send(SC_Card_T* card, uint8_t pcb, const uint8_t* inf, uint8_t len)
+{
+    uint8_t lrc;
+    uint8_t i;
+
+    card->tx[0] = 0;
+    card->tx[1] = pcb;
+    card->tx[2] = len;
+    if (len != 0)
+    {
+        memcpy(&card->tx[3], inf, len);
+    }
+
+    lrc = 0;
+    for (i = 0; i < len + 3; i++)
+    {
+        lrc ^= card->tx[i];
+    }
+    card->tx[len + 3] = lrc;
+
+    SC_Send(card, card->tx, len + 4);
+}
+
+/*!
+ * @brief       Receive a T=1 block into card->block
+ *
+ * @param       card: card
+ *
+ * @param       wtx: block waiting time multiplier granted by S(WTX), 1 for none
+ *
+ * @retval      SC_BLOCK_OK, SC_BLOCK_BAD for a wrong LRC or length,
+ *              SC_BLOCK_NONE if nothing came in time
+ */
+static uint8_t SC_T1Read(SC_Card_T* card, uint8_t wtx)
+{
+    uint32_t bwt;
+    uint32_t cwt;
+    uint8_t lrc = 0;
+    uint16_t len;
+    uint16_t i;
+
+    /* BWT is 11 etu and 2^BWI * 960 * 372 clocks, CWT 11 + 2^CWI etu */
+    bwt = 11 + (uint32_t)(((uint64_t)960 * 372 * scDi[card->di] << card->bwi) / scFi[card->fi]);
+    cwt = 11 + (1UL << card->cwi);
+
+    if (!SC_ReadByte(card, &card->block[0], SC_Timeout(card, bwt * wtx)))
+    {
+        return SC_BLOCK_NONE;
+    }
+
+    for (i = 1, len = 3; i < len + 1; i++)
+    {
+        if (!SC_ReadByte(card, &card->block[i], SC_Timeout(card, cwt)))
+        {
+            return SC_BLOCK_BAD;
+        }
+
+        if (i == 2)
+        {
+            if (card->block[2] > SC_IFSD)
+            {
+                return SC_BLOCK_BAD;
+            }
+            len = card->block[2] + 3;
+        }
+    }
+
+    for (i = 0; i < len + 1; i++)
+    {
+        lrc ^= card->block[i];
+    }
+
+    return (lrc == 0) ? SC_BLOCK_OK : SC_BLOCK_BAD;
+}
+
+/*!
+ * @brief       Send a T=1 block and take the answer that is not S(WTX)
+ *
+ * @param       card: card
+ *
+ * @param       pcb: protocol control byte
+ *
+ * @param       inf: information field
+ *
+ * @param       len: information field length
+ *
+ * @retval      1 with a good block in card->block, 0 after SC_T1_TRIES
+ *              repeats
+ *
+ * @note        A block that comes in damaged is asked for again with an
+ *              R-block, a missing one by sending the last block again.
+ */
+static uint8_t SC_T1Exchange(SC_Card_T* card, uint8_t pcb, const uint8_t* inf, uint8_t len)
+{
+    uint8_t wtx = 1;
+    uint8_t tries = 0;
+    uint8_t status;
+
+    SC_T1Send(card, pcb, inf, len);
+
+    for (;;)
+    {
+        status = SC_T1Read(card, wtx);
+        wtx = 1;
+
+        if (status == SC_BLOCK_OK)
+        {
+            if (card->block[1] != (SC_PCB_S | SC_S_WTX))
+            {
+                return 1;
+            }
+
+            /* Answered with the same multiplier, which applies to the next wait only */
+            card->stats.waitExtensions++;
+            wtx = (card->block[2] != 0) && (card->block[3] != 0) ? card->block[3] : 1;
+            SC_T1Send(card, SC_PCB_S | SC_PCB_S_RESPONSE | SC_S_WTX, &card->block[3], card->block[2] ? 1 : 0);
+            continue;
+        }
+
+        if (++tries > SC_T1_TRIES)
+        {
+            return 0;
+        }
+
+        if (status == SC_BLOCK_BAD)
+        {
+            card->stats.blockErrors++;
+            SC_T1Send(card, SC_PCB_R | (card->nr ? SC_PCB_R_NR : 0) | SC_PCB_R_EDC, NULL, 0);
+        }
+        else
+        {
+            SC_Send(card, card->tx, card->tx[2] + 4);
+        }
+    }
+}
+
+/*!
+ * @brief       Exchange an APDU with T=1
+ *
+ * @param       card: card
+ *
+ * @param       cmd: command APDU
+ *
+ * @param       cmdLen: command length
+ *
+ * @param       resp: response APDU, SC_RESPONSE_MAX bytes
+ *
+ * @param       respLen: response length
+ *
+ * @retval      1 if a response came, 0 otherwise
+ */
+static uint8_t SC_T1Transceive(SC_Card_T* card, const uint8_t* cmd, uint16_t cmdLen, uint8_t* resp, uint16_t* respLen)
+{
+    uint16_t offset = 0;
+    uint16_t got = 0;
+    uint8_t chunk;
+    uint8_t more;
+    uint8_t pcb;
+    uint8_t tries;
+
+    /* Command in I-blocks of up to IFSC bytes, each but the last acknowledged by R(N(S) + 1) */
+    do
+    {
+        chunk = (cmdLen - offset > card->ifsc) ? card->ifsc : (uint8_t)(cmdLen - offset);
+        more = (offset + chunk < cmdLen);
+        pcb = (card->ns ? SC_PCB_I_NS : 0) | (more ? SC_PCB_I_MORE : 0);
+
+        for (tries = 0; ; tries++)
+        {
+            if ((tries > SC_T1_TRIES) || !SC_T1Exchange(card, pcb, cmd + offset, chunk))
+            {
+                return 0;
+            }
+
+            pcb = card->block[1];
+            if (more ? (((pcb & SC_PCB_TYPE) == SC_PCB_R) && (((pcb & SC_PCB_R_NR) != 0) != card->ns))
+                     : ((pcb & SC_PCB_R) == 0))
+            {
+                break;
+            }
+
+            /* R(N(S)) asks for the block again, anything else is a protocol error */
+            if ((pcb & SC_PCB_TYPE) != SC_PCB_R)
+            {
+                return 0;
+            }
+            pcb = (card->ns ? SC_PCB_I_NS : 0) | (more ? SC_PCB_I_MORE : 0);
+        }
+
+        card->ns ^= 1;
+        offset += chunk;
+    }
+    while (more);
+
+    /* Response in I-blocks, chained ones acknowledged by R(N(S) + 1) */
+    for (;;)
+    {
+        pcb = card->block[1];
+        if (((pcb & SC_PCB_R) != 0) || (((pcb & SC_PCB_I_NS) != 0) != card->nr) ||
+            (got + card->block[2] > SC_RESPONSE_MAX))
+        {
+            return 0;
+        }
+
+        memcpy(&resp[got], &card->block[3], card->block[2]);
+        got += card->block[2];
+        card->nr ^= 1;
+
+        if (!(pcb & SC_PCB_I_MORE))
+        {
+            break;
+        }
+
+        if (!SC_T1Exchange(card, SC_PCB_R | (card->nr ? SC_PCB_R_NR : 0), NULL, 0))
+        {
+            return 0;
+        }
+    }
+
+    if (got < 2)
+    {
+        return 0;
+    }
+
+    *respLen = got;
+
+    return 1;
+}
+
+/*!
+ * @brief       Exchange an APDU with T=0
+ *
+ * @param       card: card
+ *
+ * @param       cmd: command APDU, case 1 to 4 short
+ *
+ * @param       cmdLen: command length
+ *
+ * @param       resp: response APDU, SC_RESPONSE_MAX bytes
+ *
+ * @param       respLen: response length
+ *
+ * @retval      1 if a status word came, 0 otherwise
+ */
+static uint8_t SC_T0Transceive(SC_Card_T* card, const uint8_t* cmd, uint16_t cmdLen, uint8_t* resp, uint16_t* respLen)
+{
+    uint32_t timeout = SC_Timeout(card, 960 * card->wi * scDi[card->di]);
+    const uint8_t* data = NULL;
+    uint16_t dataLen = 0;
+    uint16_t recvLen;
+    uint16_t got = 0;
+    uint8_t procedure;
+    uint8_t sw2;
+
+    /* Header with P3: 0, Le, or Lc for case 3 and 4 */
+    memcpy(card->tx, cmd, 4);
+    card->tx[4] = 0;
+    if (cmdLen == 5)
+    {
+        card->tx[4] = cmd[4];
+    }
+    else if ((cmdLen > 5) && ((cmdLen == 5 + cmd[4]) || (cmdLen == 6 + cmd[4])))
+    {
+        card->tx[4] = cmd[4];
+        data = &cmd[5];
+        dataLen = cmd[4];
+    }
+    else if (cmdLen != 4)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        /* Bytes that go with this header, either way */
+        recvLen = (data == NULL) && (cmdLen != 4) ? (card->tx[4] ? card->tx[4] : 256) : 0;
+        if (got + recvLen > SC_RESPONSE_MAX - 2)
+        {
+            return 0;
+        }
+
+        SC_Send(card, card->tx, 5);
+
+        for (;;)
+        {
+            if (!SC_ReadByte(card, &procedure, timeout))
+            {
+                return 0;
+            }
+
+            if (procedure == SC_NULL)
+            {
+                card->stats.nulls++;
+            }
+            else if ((procedure == card->tx[1]) || ((procedure ^ card->tx[1]) == 0xFF))
+            {
+                /* INS: all the rest, ~INS: the next byte only */
+                if (dataLen != 0)
+                {
+                    SC_Send(card, data, (procedure == card->tx[1]) ? dataLen : 1);
+                    dataLen -= card->segment.len;
+                    data += card->segment.len;
+                }
+                else
+                {
+                    do
+                    {
+                        if ((recvLen == 0) || !SC_ReadByte(card, &resp[got], timeout))
+                        {
+                            return 0;
+                        }
+                        got++;
+                        recvLen--;
+                    }
+                    while ((procedure == card->tx[1]) && (recvLen != 0));
+                }
+            }
+            else if (((procedure & 0xF0) == 0x60) || ((procedure & 0xF0) == 0x90))
+            {
+                break;
+            }
+            else
+            {
+                return 0;
+            }
+        }
+
+        if (!SC_ReadByte(card, &sw2, timeout))
+        {
+            return 0;
+        }
+
+        if (procedure == 0x61)
+        {
+            /* Response waiting, fetch it */
+            card->stats.getResponses++;
+            card->tx[0] = cmd[0];
+            card->tx[1] = 0xC0;
+            card->tx[2] = 0;
+            card->tx[3] = 0;
+            card->tx[4] = sw2;
+            data = NULL;
+            dataLen = 0;
+            cmdLen = 5;
+        }
+        else if ((procedure == 0x6C) && (data == NULL))
+        {
+            /* Wrong Le, send the same header with the length the card gave */
+            card->stats.resends++;
+            card->tx[4] = sw2;
+        }
+        else
+        {
+            resp[got++] = procedure;
+            resp[got++] = sw2;
+            *respLen = got;
+            return 1;
+        }
+    }
+}
+
+/*!
+ * @brief       Activate a card and set up its protocol
+ *
+ * @param       card: card set up with SC_Init()
+ *
+ * @retval      1 if the card is ready for SC_Transceive(), 0 if it gave no
+ *              usable answer to reset, it is then deactivated
+ *
+ * @note        Blocks for the answer to reset and the PPS exchange.
+ */
+uint8_t SC_Activate(SC_Card_T* card)
+{
+    uint8_t ifsd = SC_IFSD;
+    uint8_t warm;
+
+    /* Cold reset at 372/1 */
+    GPIO_ResetBit(card->rstPort, card->rstPin);
+    SC_ConfigRate(card, 1, 1);
+    SC_Clock(card, 1);
+    card->rxTail = card->rxHead;
+
+    for (warm = 0; warm < 2; warm++)
+    {
+        SC_Delay(card, SC_RESET_CLOCKS);
+        GPIO_SetBit(card->rstPort, card->rstPin);
+
+        if (!SC_ReadAtr(card))
+        {
+            break;
+        }
+        card->stats.resets++;
+
+        /* After a failed PPS the card is reset again and stays at 372/1 */
+        if (warm || SC_Negotiate(card))
+        {
+            USART_ConfigGuardTime(card->port->usart, (card->guard == 0xFF) ? 0 : card->guard);
+
+            if (card->protocol == SC_PROTOCOL_T0)
+            {
+                /* Parity errors are signalled for the character to be repeated */
+                USART_EnableSmartCardNACK(card->port->usart);
+                return 1;
+            }
+
+            USART_DisableSmartCardNACK(card->port->usart);
+            card->ns = 0;
+            card->nr = 0;
+            if (SC_T1Exchange(card, SC_PCB_S | SC_S_IFS, &ifsd, 1) &&
+                (card->block[1] == (SC_PCB_S | SC_PCB_S_RESPONSE | SC_S_IFS)))
+            {
+                return 1;
+            }
+            break;
+        }
+
+        card->stats.ppsFailed++;
+        GPIO_ResetBit(card->rstPort, card->rstPin);
+        SC_ConfigRate(card, 1, 1);
+    }
+
+    SC_Deactivate(card);
+
+    return 0;
+}
+
+/*!
+ * @brief       Exchange a command and a response APDU
+ *
+ * @param       card: activated card
+ *
+ * @param       cmd: command APDU, 4 to SC_APDU_MAX bytes
+ *
+ * @param       cmdLen: command length
+ *
+ * @param       resp: response APDU, SC_RESPONSE_MAX bytes, data then the status word
+ *
+ * @param       respLen: response length, 2 or more
+ *
+ * @retval      1 if a response came, 0 if the card did not answer or broke
+ *              the protocol
+ *
+ * @note        Blocks until the response is in.
+ */
+uint8_t SC_Transceive(SC_Card_T* card, const uint8_t* cmd, uint16_t cmdLen, uint8_t* resp, uint16_t* respLen)
+{
+    uint8_t ok;
+
+    ok = (card->protocol == SC_PROTOCOL_T0) ? SC_T0Transceive(card, cmd, cmdLen, resp, respLen)
+                                            : SC_T1Transceive(card, cmd, cmdLen, resp, respLen);
+
+    if (ok)
+    {
+        card->stats.apdus++;
+    }
+    else
+    {
+        card->stats.errors++;
+    }
+
+    return ok;
+}
+
+/*!
+ * @brief       Deactivate a card: RST low, then the clock off
+ *
+ * @param       card: card
+ *
+ * @retval      None
+ */
+void SC_Deactivate(SC_Card_T* card)
+{
+    GPIO_ResetBit(card->rstPort, card->rstPin);
+    SC_Clock(card, 0);
+}
+
+/**@} end of group SC_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */
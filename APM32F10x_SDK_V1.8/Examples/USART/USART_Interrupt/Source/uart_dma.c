@@ -0,0 +1,1755 @@
+/*!
+ * @file        uart_dma.c
+ *
+ * @brief       Table-driven UART engine, idle-line DMA receive into a ring and
+ *              queued scatter-gather DMA transmit on any number of ports
+ *
+ * @version     V1.0.0
+ *
+ * @date        2022-12-01
+ *
+ * @attention
+ *
+ *  Copyright (C) 2020-2022 Geehy Semiconductor
+ *
+ *  You may not use this file except in compliance with the
+ *  GEEHY COPYRIGHT NOTICE (GEEHY SOFTWARE PACKAGE LICENSE).
+ *
+ *  The program is only for reference, which is distributed in the hope
+ *  that it will be useful and instructional for customers to develop
+ *  their software. Unless required by applicable law or agreed to in
+ *  writing, the program is distributed on an "AS IS" BASIS, WITHOUT
+ *  ANY WARRANTY OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the GEEHY SOFTWARE PACKAGE LICENSE for the governing permissions
+ *  and limitations under the License.
+ */
+
+/* Includes */
+#include "uart_dma.h"
+#include "frame_crc.h"
+#include "reg_inline.h"
+#include "apm32f10x_rcm.h"
+#include "apm32f10x_misc.h"
+#include <string.h>
+
+#if defined (UART_DMA_BENCH)
+#include "bench.h"
+#endif
+
+/** @addtogroup Examples
+  @{
+*/
+
+/** @addtogroup USART_Interrupt
+  @{
+*/
+
+/** @defgroup UART_DMA_Macros Macros
+  @{
+*/
+
+/* Receive error flags of USART STS */
+#define UART_DMA_STS_ERRORS         (USART_FLAG_PE | USART_FLAG_FE | USART_FLAG_NE | USART_FLAG_OVRE)
+
+/* Character format bits of CTRL1 and CTRL2 a profile sets */
+#define UART_DMA_PROFILE_CTRL1      ((uint16_t)(USART_WORD_LEN_9B | USART_PARITY_ODD))
+#define UART_DMA_PROFILE_CTRL2      ((uint16_t)USART_STOP_BIT_1_5)
+
+/* Auto-baud: abEdges once BR is set, capture interrupt and repetition flag of a channel */
+#define UART_DMA_AB_LOCKED          0xFF
+#define UART_DMA_AB_INT(ab)         ((uint16_t)(TMR_INT_CC1 << ((ab)->channel / 4)))
+#define UART_DMA_AB_FLAG_RC(ab)     ((uint16_t)(TMR_FLAG_CC1RC << ((ab)->channel / 4)))
+
+/* Auto-baud counter bits, 12 bit times at minBaud must stay below half of them */
+#define UART_DMA_AB_SPAN_BITS       12
+
+/* Measurement hooks, empty unless bench.h provides them */
+#ifndef UART_DMA_ISR_ENTER
+#define UART_DMA_ISR_ENTER(port)
+#define UART_DMA_ISR_EXIT(port)
+#define UART_DMA_RX_FRAME(port)
+#define UART_DMA_TX_START(port)
+#endif
+
+/**@} end of group UART_DMA_Macros */
+
+/** @defgroup UART_DMA_Variables Variables
+  @{
+*/
+
+/* Port owning each device IRQ, filled by UART_DMA_Init() */
+static UART_DMA_Port_T* irqPort[UART_DMA_IRQ_NUM];
+
+/**@} end of group UART_DMA_Variables */
+
+/** @defgroup UART_DMA_Functions Functions
+  @{
+*/
+
+static void UART_DMA_TxDmaEvent(void* context, uint8_t events);
+static void UART_DMA_RxDmaEvent(void* context, uint8_t events);
+
+/*!
+ * @brief       Get the APB2 clock of a GPIO port
+ *
+ * @param       port: GPIOA to GPIOG
+ *
+ * @retval      RCM_APB2_PERIPH_GPIOx value of the port
+ */
+static uint32_t UART_DMA_GPIOClock(GPIO_T* port)
+{
+    return RCM_APB2_PERIPH_GPIOA << (((uint32_t)port - GPIOA_BASE) / (GPIOB_BASE - GPIOA_BASE));
+}
+
+/*!
+ * @brief       Enable the clock of an auto-baud timer
+ *
+ * @param       tmr: TMR1 to TMR5
+ *
+ * @retval      Counter clock ahead of the prescaler
+ */
+static uint32_t UART_DMA_TmrClock(TMR_T* tmr)
+{
+    uint32_t pclk1, pclk2;
+    uint32_t pclk;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+
+    if (tmr == TMR1)
+    {
+        RCM_EnableAPB2PeriphClock(RCM_APB2_PERIPH_TMR1);
+        pclk = pclk2;
+    }
+    else
+    {
+        /* TMR2 to TMR5 sit on APB1 in register order */
+        RCM_EnableAPB1PeriphClock(RCM_APB1_PERIPH_TMR2 <<
+                                  (((uint32_t)tmr - TMR2_BASE) / (TMR3_BASE - TMR2_BASE)));
+        pclk = pclk1;
+    }
+
+    /* Timers run at twice PCLK behind a divided APB */
+    return (pclk == RCM_ReadHCLKFreq()) ? pclk : 2 * pclk;
+}
+
+/*!
+ * @brief       Check for a USART with a hardware CTS input
+ *
+ * @param       port: UART port
+ *
+ * @retval      1 for USART1 to USART3, 0 for UART4/5
+ */
+static uint8_t UART_DMA_HardwareFlow(UART_DMA_Port_T* port)
+{
+    return (port->usart == USART1) || (port->usart == USART2) || (port->usart == USART3);
+}
+
+/*!
+ * @brief       Configure the RTS and CTS pins of a port
+ *
+ * @param       port: UART port with flow control
+ *
+ * @param       lineConfig: line settings, hardware CTS is added when the USART has it
+ *
+ * @retval      None
+ */
+static void UART_DMA_ConfigFlow(UART_DMA_Port_T* port, USART_Config_T* lineConfig)
+{
+    const UART_DMA_Flow_T* flow = port->flow;
+    GPIO_Config_T gpioConfig;
+    EINT_Config_T eintConfig;
+    uint8_t line;
+
+    gpioConfig.speed = GPIO_SPEED_50MHz;
+
+    if (flow->rtsPort != NULL)
+    {
+        /* Ready to receive from the start */
+        RCM_EnableAPB2PeriphClock(UART_DMA_GPIOClock(flow->rtsPort));
+        GPIO_ResetBit(flow->rtsPort, flow->rtsPin);
+        gpioConfig.mode = GPIO_MODE_OUT_PP;
+        gpioConfig.pin = flow->rtsPin;
+        GPIO_Config(flow->rtsPort, &gpioConfig);
+    }
+
+    if (flow->ctsPort == NULL)
+    {
+        return;
+    }
+
+    RCM_EnableAPB2PeriphClock(UART_DMA_GPIOClock(flow->ctsPort));
+    gpioConfig.mode = GPIO_MODE_IN_FLOATING;
+    gpioConfig.pin = flow->ctsPin;
+    GPIO_Config(flow->ctsPort, &gpioConfig);
+
+    if (UART_DMA_HardwareFlow(port))
+    {
+        /* The transmitter waits for CTS before each character, DMA requests wait with it */
+        lineConfig->hardwareFlow = USART_HARDWARE_FLOW_CTS;
+        return;
+    }
+
+    /* Both edges of CTS enter UART_DMA_Isr() through the EINT line of the pin */
+    line = 31 - __CLZ(flow->ctsPin);
+    RCM_EnableAPB2PeriphClock(RCM_APB2_PERIPH_AFIO);
+    GPIO_ConfigEINTLine((GPIO_PORT_SOURCE_T)(((uint32_t)flow->ctsPort - GPIOA_BASE) / (GPIOB_BASE - GPIOA_BASE)),
+                        (GPIO_PIN_SOURCE_T)line);
+
+    eintConfig.line = flow->ctsPin;
+    eintConfig.mode = EINT_MODE_INTERRUPT;
+    eintConfig.trigger = EINT_TRIGGER_RISING_FALLING;
+    eintConfig.lineCmd = ENABLE;
+    EINT_Config(&eintConfig);
+
+    if (line < 5)
+    {
+        port->ctsIRQn = (IRQn_Type)(EINT0_IRQn + line);
+    }
+    else if (line < 10)
+    {
+        port->ctsIRQn = EINT9_5_IRQn;
+    }
+    else
+    {
+        port->ctsIRQn = EINT15_10_IRQn;
+    }
+    port->ctsSoft = 1;
+}
+
+/*!
+ * @brief       Follow the CTS input of a port without hardware CTS
+ *
+ * @param       port: UART port with ctsSoft set
+ *
+ * @retval      None
+ *
+ * @note        Called from the port IRQs or before they are enabled. A paused
+ *              DMA transfer keeps its place, the channel only loses its
+ *              requests until CTS is asserted again.
+ */
+static void UART_DMA_CtsUpdate(UART_DMA_Port_T* port)
+{
+    port->txHeld = REG_GPIO_ReadInputBit(port->flow->ctsPort, port->flow->ctsPin);
+
+    if (port->txChannel != NULL)
+    {
+        if (port->txHeld)
+        {
+            REG_USART_DisableDMA(port->usart, REG_USART_CTRL3_DMATXEN);
+        }
+        else
+        {
+            REG_USART_EnableDMA(port->usart, REG_USART_CTRL3_DMATXEN);
+        }
+    }
+    else if (port->txHeld)
+    {
+        REG_USART_DisableInterrupt(port->usart, REG_USART_TXBE);
+    }
+    else if (port->txFirst != NULL)
+    {
+        REG_USART_EnableInterrupt(port->usart, REG_USART_TXBE);
+    }
+}
+
+/*!
+ * @brief       Drive RTS from the receive ring fill of a deferred mode port
+ *
+ * @param       port: UART port with an RTS pin
+ *
+ * @param       fill: ring bytes still in use by the consumer
+ *
+ * @retval      None
+ *
+ * @note        Called from the port ISR, or by the consumer with interrupts masked.
+ */
+static void UART_DMA_RtsUpdate(UART_DMA_Port_T* port, uint16_t fill)
+{
+    const UART_DMA_Flow_T* flow = port->flow;
+    uint8_t used;
+    uint8_t queueFull;
+
+    used = port->frameHead - port->frameTail;
+    if (port->frameHead < port->frameTail)
+    {
+        used += port->frameQueueLen;
+    }
+
+    /* Keep room for the frame on the wire and one more after RTS goes up */
+    queueFull = (used + 3 > port->frameQueueLen);
+
+    if (!port->rtsHeld && ((fill >= flow->rtsHigh) || queueFull))
+    {
+        REG_GPIO_SetBit(flow->rtsPort, flow->rtsPin);
+        port->rtsHeld = 1;
+        port->stats.rtsHolds++;
+    }
+    else if (port->rtsHeld && (fill <= flow->rtsLow) && !queueFull)
+    {
+        REG_GPIO_ResetBit(flow->rtsPort, flow->rtsPin);
+        port->rtsHeld = 0;
+    }
+}
+
+/*!
+ * @brief       Receive ring bytes still in use by the consumer of a deferred mode port
+ *
+ * @param       port: UART port with a frame queue
+ *
+ * @param       head: ring write position
+ *
+ * @retval      Bytes from the frame last taken up to head
+ */
+static uint16_t UART_DMA_RxFill(UART_DMA_Port_T* port, uint16_t head)
+{
+    uint16_t start = port->rxTaken;
+
+    return (head >= start) ? (head - start) : (port->rxRingSize - start + head);
+}
+
+/*!
+ * @brief       Receive ring write position
+ *
+ * @param       port: UART port
+ *
+ * @retval      Ring offset of the next byte to be received
+ */
+static uint16_t UART_DMA_RxHead(UART_DMA_Port_T* port)
+{
+    uint16_t head;
+
+    if (port->rxChannel != NULL)
+    {
+        head = port->rxRingSize - REG_DMA_ReadDataNumber(port->rxChannel);
+    }
+    else
+    {
+        head = port->rxWrite;
+    }
+
+    return (head == port->rxRingSize) ? 0 : head;
+}
+
+/*!
+ * @brief       Let the sender go on if the consumer has freed enough of the ring
+ *
+ * @param       port: UART port with a frame queue
+ *
+ * @retval      None
+ *
+ * @note        Called by the consumer with interrupts masked.
+ */
+static void UART_DMA_RtsRelease(UART_DMA_Port_T* port)
+{
+    if (port->rtsHeld)
+    {
+        UART_DMA_RtsUpdate(port, UART_DMA_RxFill(port, UART_DMA_RxHead(port)));
+    }
+}
+
+/*!
+ * @brief       Busy wait a number of bit times of the port line
+ *
+ * @param       port: UART port
+ *
+ * @param       bits: bit times
+ *
+ * @retval      None
+ */
+static void UART_DMA_Guard(UART_DMA_Port_T* port, uint16_t bits)
+{
+    uint32_t start = UART_DMA_TIMESTAMP();
+    uint32_t wait = bits * port->bitTime;
+
+    while (UART_DMA_TIMESTAMP() - start < wait);
+}
+
+/*!
+ * @brief       Half bit times of a character
+ *
+ * @param       ctrl1: CTRL1 value, its word length bit
+ *
+ * @param       ctrl2: CTRL2 value, its stop bits
+ *
+ * @retval      Start bit, data bits including parity and stop bits, in half bits
+ */
+static uint32_t UART_DMA_HalfBits(uint32_t ctrl1, uint32_t ctrl2)
+{
+    static const uint8_t stopHalfBits[4] = {2, 1, 4, 3};
+
+    return 2 * ((ctrl1 & USART_WORD_LEN_9B) ? 10 : 9) + stopHalfBits[(ctrl2 & USART_STOP_BIT_1_5) >> 12];
+}
+
+/*!
+ * @brief       Character and bit times of a port in timestamp units
+ *
+ * @param       port: UART port with its USART configured
+ *
+ * @param       baudRate: line rate
+ *
+ * @retval      None
+ */
+static void UART_DMA_LineTimes(UART_DMA_Port_T* port, uint32_t baudRate)
+{
+    uint32_t halfBits = UART_DMA_HalfBits(port->usart->CTRL1, port->usart->CTRL2);
+
+    port->charTime = (uint32_t)((uint64_t)UART_DMA_TIMESTAMP_HZ * halfBits / (2 * baudRate));
+    port->bitTime = UART_DMA_TIMESTAMP_HZ / baudRate;
+    port->baudRate = baudRate;
+}
+
+/*!
+ * @brief       Enable the RS-485 driver before the first character of an idle port
+ *
+ * @param       port: UART port with rs485 or smartCard set
+ *
+ * @retval      None
+ *
+ * @note        Called with interrupts masked or from the port TX interrupt.
+ *              A smart card port turns its receiver off instead.
+ */
+static void UART_DMA_DriverOn(UART_DMA_Port_T* port)
+{
+    port->deOn = 1;
+
+    if (port->smartCard != NULL)
+    {
+        REG_USART_DisableRx(port->usart);
+        return;
+    }
+
+    REG_GPIO_SetBit(port->rs485->dePort, port->rs485->dePin);
+    UART_DMA_Guard(port, port->rs485->leadBits);
+}
+
+/*!
+ * @brief       Release the RS-485 driver once the last stop bit is out
+ *
+ * @param       port: UART port with deOn set and nothing left to send
+ *
+ * @retval      None
+ *
+ * @note        Called from the USART transmission complete interrupt.
+ */
+static void UART_DMA_DriverOff(UART_DMA_Port_T* port)
+{
+    if (port->smartCard != NULL)
+    {
+        REG_USART_EnableRx(port->usart);
+    }
+    else
+    {
+        UART_DMA_Guard(port, port->rs485->tailBits);
+        REG_GPIO_ResetBit(port->rs485->dePort, port->rs485->dePin);
+    }
+
+    REG_USART_DisableInterrupt(port->usart, REG_USART_TXC);
+    port->deOn = 0;
+}
+
+/*!
+ * @brief       Configure a DMA channel for the port USART data register
+ *
+ * @param       channel: DMA channel
+ *
+ * @param       dir: DMA_DIR_PERIPHERAL_SRC for receive, DMA_DIR_PERIPHERAL_DST for transmit
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ */
+static void UART_DMA_ConfigChannel(DMA_Channel_T* channel, DMA_DIR_T dir, UART_DMA_Port_T* port)
+{
+    DMA_Config_T dmaConfig;
+
+    dmaConfig.peripheralBaseAddr = (uint32_t)&port->usart->DATA;
+    dmaConfig.dir = dir;
+    dmaConfig.peripheralInc = DMA_PERIPHERAL_INC_DISABLE;
+    dmaConfig.memoryInc = DMA_MEMORY_INC_ENABLE;
+    dmaConfig.peripheralDataSize = DMA_PERIPHERAL_DATA_SIZE_BYTE;
+    dmaConfig.memoryDataSize = DMA_MEMORY_DATA_SIZE_BYTE;
+    dmaConfig.priority = DMA_PRIORITY_HIGH;
+    dmaConfig.M2M = DMA_M2MEN_DISABLE;
+
+    if (dir == DMA_DIR_PERIPHERAL_SRC)
+    {
+        /* The channel is never stopped, half and full ring events drain long frames */
+        dmaConfig.memoryBaseAddr = (uint32_t)port->rxRing;
+        dmaConfig.bufferSize = port->rxRingSize;
+        dmaConfig.loopMode = DMA_MODE_CIRCULAR;
+    }
+    else
+    {
+        dmaConfig.memoryBaseAddr = (uint32_t)port->txPool[0].data;
+        dmaConfig.bufferSize = 0;
+        dmaConfig.loopMode = DMA_MODE_NORMAL;
+    }
+
+    DMA_Config(channel, &dmaConfig);
+}
+
+/*!
+ * @brief       Set up the auto-baud timer of a port
+ *
+ * @param       port: UART port with autoBaud set
+ *
+ * @retval      None
+ *
+ * @note        The counter runs free over 16 bits, the measurement and the
+ *              compare that follows it are kept within half of that.
+ */
+static void UART_DMA_ConfigAutoBaud(UART_DMA_Port_T* port)
+{
+    const UART_DMA_AutoBaud_T* ab = port->autoBaud;
+    TMR_BaseConfig_T baseConfig;
+    uint32_t pclk1, pclk2;
+    uint32_t clock;
+    uint32_t division;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+    port->abPclk = (port->usart == USART1) ? pclk2 : pclk1;
+
+    clock = UART_DMA_TmrClock(ab->tmr);
+    division = (uint32_t)(((uint64_t)clock * UART_DMA_AB_SPAN_BITS + 0x7FFFULL * ab->minBaud - 1) /
+                          (0x7FFFULL * ab->minBaud));
+    if (division == 0)
+    {
+        division = 1;
+    }
+    port->abClock = clock / division;
+
+    TMR_ConfigTimeBaseStructInit(&baseConfig);
+    baseConfig.countMode = TMR_COUNTER_MODE_UP;
+    baseConfig.clockDivision = TMR_CLOCK_DIV_1;
+    baseConfig.period = 0xFFFF;
+    baseConfig.division = division - 1;
+    TMR_ConfigTimeBase(ab->tmr, &baseConfig);
+
+    irqPort[ab->tmrIRQn] = port;
+    NVIC_EnableIRQRequest(ab->tmrIRQn, port->priority, 0);
+    TMR_Enable(ab->tmr);
+}
+
+/*!
+ * @brief       Initialize a port: clocks, pins, USART, DMA channels and IRQs
+ *
+ * @param       port: port descriptor, kept by the engine until reset
+ *
+ * @param       usartConfig: line settings of the port
+ *
+ * @retval      None
+ */
+void UART_DMA_Init(UART_DMA_Port_T* port, USART_Config_T* usartConfig)
+{
+    GPIO_Config_T gpioConfig;
+    USART_ClockConfig_T clockConfig;
+    USART_Config_T lineConfig = *usartConfig;
+
+    port->rxRead = 0;
+    port->rxWrite = 0;
+    port->txPoolHead = 0;
+    port->txPoolTail = 0;
+    port->txFirst = NULL;
+    port->txLast = NULL;
+    port->frameHead = 0;
+    port->frameTail = 0;
+    port->crcHead = 0;
+    port->rxFrameLen = 0;
+    port->rxForeign = 0;
+    port->rxTaken = 0;
+    port->ctsSoft = 0;
+    port->rtsHeld = 0;
+    port->txHeld = 0;
+    port->deOn = 0;
+    port->abEdges = 0;
+    memset(&port->stats, 0, sizeof(port->stats));
+
+    if (port->frameCrc && (port->frameQueue != NULL))
+    {
+        FRAME_CRC_Attach(port);
+    }
+
+    /* Free-running cycle counter for frame timestamps */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    RCM_EnableAPB2PeriphClock(UART_DMA_GPIOClock(port->txPort) | UART_DMA_GPIOClock(port->rxPort));
+
+    if (port->usart == USART1)
+    {
+        RCM_EnableAPB2PeriphClock(RCM_APB2_PERIPH_USART1);
+    }
+    else
+    {
+        /* USART2 to UART5 sit on APB1 in register order */
+        RCM_EnableAPB1PeriphClock(RCM_APB1_PERIPH_USART2 <<
+                                  (((uint32_t)port->usart - USART2_BASE) / (USART3_BASE - USART2_BASE)));
+    }
+
+    /* Configure USART Tx as alternate function push-pull, open drain for a card I/O line */
+    gpioConfig.mode = (port->smartCard != NULL) ? GPIO_MODE_AF_OD : GPIO_MODE_AF_PP;
+    gpioConfig.pin = port->txPin;
+    gpioConfig.speed = GPIO_SPEED_50MHz;
+    GPIO_Config(port->txPort, &gpioConfig);
+
+    /* Configure USART Rx as input floating */
+    gpioConfig.mode = GPIO_MODE_IN_FLOATING;
+    gpioConfig.pin = port->rxPin;
+    GPIO_Config(port->rxPort, &gpioConfig);
+
+    if (port->smartCard != NULL)
+    {
+        RCM_EnableAPB2PeriphClock(UART_DMA_GPIOClock(port->smartCard->clkPort));
+        gpioConfig.mode = GPIO_MODE_AF_PP;
+        gpioConfig.pin = port->smartCard->clkPin;
+        GPIO_Config(port->smartCard->clkPort, &gpioConfig);
+    }
+
+    lineConfig.hardwareFlow = USART_HARDWARE_FLOW_NONE;
+    if (port->flow != NULL)
+    {
+        UART_DMA_ConfigFlow(port, &lineConfig);
+    }
+
+    if (port->rs485 != NULL)
+    {
+        /* Receive until the first send */
+        RCM_EnableAPB2PeriphClock(UART_DMA_GPIOClock(port->rs485->dePort));
+        GPIO_ResetBit(port->rs485->dePort, port->rs485->dePin);
+        gpioConfig.mode = GPIO_MODE_OUT_PP;
+        gpioConfig.pin = port->rs485->dePin;
+        GPIO_Config(port->rs485->dePort, &gpioConfig);
+    }
+
+    USART_Config(port->usart, &lineConfig);
+    UART_DMA_LineTimes(port, lineConfig.baudRate);
+
+    if (port->smartCard != NULL)
+    {
+        /* The card clock runs as soon as the USART is enabled */
+        USART_ConfigClockStructInit(&clockConfig);
+        clockConfig.clock = USART_CLKEN_ENABLE;
+        USART_ConfigClock(port->usart, &clockConfig);
+        USART_ConfigPrescaler(port->usart, port->smartCard->prescaler);
+        USART_ConfigGuardTime(port->usart, port->smartCard->guardTime);
+        USART_EnableSmartCard(port->usart);
+    }
+
+    if (port->multiDrop)
+    {
+        /* Frames for other addresses never reach the DMA or the idle interrupt */
+        USART_Address(port->usart, port->address & 0x0F);
+        USART_ConfigWakeUp(port->usart, USART_WAKEUP_ADDRESS_MARK);
+    }
+
+    if (port->breakCallback != NULL)
+    {
+        USART_ConfigLINBreakDetectLength(port->usart, USART_LBDL_11B);
+        USART_EnableLIN(port->usart);
+        USART_EnableInterrupt(port->usart, USART_INT_LBD);
+    }
+
+    irqPort[port->usartIRQn] = port;
+
+    /* A request whose channel another driver holds falls back to interrupts as well */
+    port->txChannel = DMA_MGR_Claim(port->txRequest, UART_DMA_TxDmaEvent, port, port->priority);
+    if (port->txChannel != NULL)
+    {
+        UART_DMA_ConfigChannel(port->txChannel, DMA_DIR_PERIPHERAL_DST, port);
+        DMA_EnableInterrupt(port->txChannel, DMA_INT_TC | DMA_INT_TERR);
+        USART_EnableDMA(port->usart, USART_DMA_TX);
+    }
+
+    port->rxChannel = DMA_MGR_Claim(port->rxRequest, UART_DMA_RxDmaEvent, port, port->priority);
+    if (port->rxChannel != NULL)
+    {
+        UART_DMA_ConfigChannel(port->rxChannel, DMA_DIR_PERIPHERAL_SRC, port);
+        DMA_EnableInterrupt(port->rxChannel, DMA_INT_HT | DMA_INT_TC | DMA_INT_TERR);
+        USART_EnableDMA(port->usart, USART_DMA_RX);
+        DMA_Enable(port->rxChannel);
+
+        /* With RX DMA, framing, noise and overrun errors need their own interrupt */
+        USART_EnableInterrupt(port->usart, USART_INT_ERR);
+    }
+    else
+    {
+        USART_EnableInterrupt(port->usart, USART_INT_RXBNE);
+    }
+
+    /* All IRQs of a port share one priority so it is never serviced re-entrantly */
+    USART_EnableInterrupt(port->usart, USART_INT_IDLE);
+    USART_EnableInterrupt(port->usart, USART_INT_PE);
+    NVIC_EnableIRQRequest(port->usartIRQn, port->priority, 0);
+
+    if (port->ctsSoft)
+    {
+        UART_DMA_CtsUpdate(port);
+        EINT_ClearIntFlag(port->flow->ctsPin);
+        irqPort[port->ctsIRQn] = port;
+        NVIC_EnableIRQRequest(port->ctsIRQn, port->priority, 0);
+    }
+
+    if (port->autoBaud != NULL)
+    {
+        UART_DMA_ConfigAutoBaud(port);
+    }
+
+    USART_Enable(port->usart);
+
+    if (port->multiDrop)
+    {
+        /* Wait for the first address */
+        USART_EnableMuteMode(port->usart);
+    }
+
+    if (port->autoBaud != NULL)
+    {
+        UART_DMA_AutoBaud(port);
+    }
+}
+
+/*!
+ * @brief       Change the line rate of a running port
+ *
+ * @param       port: initialized UART port
+ *
+ * @param       baudRate: new rate
+ *
+ * @retval      None
+ *
+ * @note        Call while the line is idle both ways, e.g. after a smart
+ *              card PPS exchange.
+ */
+void UART_DMA_ConfigBaudRate(UART_DMA_Port_T* port, uint32_t baudRate)
+{
+    uint32_t pclk1, pclk2;
+    uint32_t pclk;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+    pclk = (port->usart == USART1) ? pclk2 : pclk1;
+
+    /* BR holds the divider in 1/16 steps, i.e. PCLK cycles per bit */
+    port->usart->BR = (pclk + baudRate / 2) / baudRate;
+    UART_DMA_LineTimes(port, baudRate);
+}
+
+/*!
+ * @brief       Work out the registers and line times of a port for a rate and format
+ *
+ * @param       port: UART port the profile is for, its PCLK sets BR
+ *
+ * @param       usartConfig: rate, word length, parity and stop bits; mode and
+ *                           hardware flow are left as the port has them
+ *
+ * @param       profile: profile to fill
+ *
+ * @retval      None
+ *
+ * @note        Call at init time, after the clocks are set up. A profile
+ *              only fits ports on the same APB as the one it was made for.
+ */
+void UART_DMA_MakeProfile(UART_DMA_Port_T* port, const USART_Config_T* usartConfig, UART_DMA_Profile_T* profile)
+{
+    uint32_t pclk1, pclk2;
+    uint32_t pclk;
+    uint32_t baudRate = usartConfig->baudRate;
+
+    RCM_ReadPCLKFreq(&pclk1, &pclk2);
+    pclk = (port->usart == USART1) ? pclk2 : pclk1;
+
+    profile->baudRate = baudRate;
+    profile->br = (uint16_t)((pclk + baudRate / 2) / baudRate);
+    profile->ctrl1 = (uint16_t)(usartConfig->wordLength | usartConfig->parity);
+    profile->ctrl2 = (uint16_t)usartConfig->stopBits;
+    profile->charTime = (uint32_t)((uint64_t)UART_DMA_TIMESTAMP_HZ *
+                                   UART_DMA_HalfBits(profile->ctrl1, profile->ctrl2) / (2 * baudRate));
+    profile->bitTime = UART_DMA_TIMESTAMP_HZ / baudRate;
+}
+
+/*!
+ * @brief       Switch a running port to a profile
+ *
+ * @param       port: initialized UART port
+ *
+ * @param       profile: profile from UART_DMA_MakeProfile()
+ *
+ * @retval      1 if the port runs the profile, 0 if a character is still
+ *              being sent and nothing was changed
+ *
+ * @note        Writes BR and, only when the format changes, CTRL1 and CTRL2;
+ *              the receiver, DMA and interrupts stay as they are. The
+ *              receive line must be idle, e.g. between the response of a
+ *              transaction and the next request.
+ */
+uint8_t UART_DMA_ApplyProfile(UART_DMA_Port_T* port, const UART_DMA_Profile_T* profile)
+{
+    USART_T* usart = port->usart;
+    uint32_t ctrl;
+
+    if ((port->txFirst != NULL) || !(usart->STS & USART_FLAG_TXC))
+    {
+        return 0;
+    }
+
+    ctrl = usart->CTRL1;
+    if ((ctrl & UART_DMA_PROFILE_CTRL1) != profile->ctrl1)
+    {
+        usart->CTRL1 = (ctrl & ~UART_DMA_PROFILE_CTRL1) | profile->ctrl1;
+    }
+
+    ctrl = usart->CTRL2;
+    if ((ctrl & UART_DMA_PROFILE_CTRL2) != profile->ctrl2)
+    {
+        usart->CTRL2 = (ctrl & ~UART_DMA_PROFILE_CTRL2) | profile->ctrl2;
+    }
+
+    usart->BR = profile->br;
+    port->charTime = profile->charTime;
+    port->bitTime = profile->bitTime;
+    port->baudRate = profile->baudRate;
+
+    return 1;
+}
+
+/*!
+ * @brief       Measure the line rate of a port again from its next character
+ *
+ * @param       port: initialized UART port with autoBaud set
+ *
+ * @retval      None
+ *
+ * @note        Call while the line is idle, the receiver stays off until
+ *              the rate is set. UART_DMA_Init() starts the first measurement.
+ */
+void UART_DMA_AutoBaud(UART_DMA_Port_T* port)
+{
+    const UART_DMA_AutoBaud_T* ab = port->autoBaud;
+    TMR_ICConfig_T icConfig;
+
+    TMR_DisableInterrupt(ab->tmr, UART_DMA_AB_INT(ab));
+    USART_DisableRx(port->usart);
+    port->baudRate = 0;
+    port->abEdges = 0;
+
+    /* 0x55 is timed between falling edges, a start bit between both */
+    icConfig.channel = (TMR_CHANNEL_T)ab->channel;
+    icConfig.polarity = ab->sync ? TMR_IC_POLARITY_FALLING : TMR_IC_POLARITY_BOTHEDGE;
+    icConfig.selection = TMR_IC_SELECTION_DIRECT_TI;
+    icConfig.prescaler = TMR_IC_PSC_1;
+    icConfig.filter = 0;
+    TMR_ConfigIC(ab->tmr, &icConfig);
+
+    TMR_ClearStatusFlag(ab->tmr, UART_DMA_AB_INT(ab) | UART_DMA_AB_FLAG_RC(ab));
+    TMR_EnableInterrupt(ab->tmr, UART_DMA_AB_INT(ab));
+}
+
+/*!
+ * @brief       Read the line rate of a port
+ *
+ * @param       port: initialized UART port
+ *
+ * @retval      Rate set by the configuration or measured, 0 while auto-baud measures
+ */
+uint32_t UART_DMA_ReadBaudRate(UART_DMA_Port_T* port)
+{
+    return port->baudRate;
+}
+
+/*!
+ * @brief       Queue a frame descriptor for the consumer
+ *
+ * @param       port: UART port
+ *
+ * @param       offset: ring offset of the first byte
+ *
+ * @param       len: frame length
+ *
+ * @param       flags: UART_DMA_FRAME_xxx
+ *
+ * @param       lastStamp: stop bit end of the last byte
+ *
+ * @retval      None
+ *
+ * @note        Single producer side of the frame queue, called from the port
+ *              ISR only. The slot is written before the head index is
+ *              published, so no critical section is needed. A full queue
+ *              drops the frame.
+ */
+static void UART_DMA_PushFrame(UART_DMA_Port_T* port, uint16_t offset, uint16_t len, uint8_t flags,
+                               uint32_t lastStamp)
+{
+    UART_DMA_Frame_T* frame;
+    uint8_t head = port->frameHead;
+    uint8_t next = head + 1;
+
+    if (next == port->frameQueueLen)
+    {
+        next = 0;
+    }
+
+    if (next == port->frameTail)
+    {
+        port->stats.frameDrops++;
+        return;
+    }
+
+    frame = &port->frameQueue[head];
+    frame->offset = offset;
+    frame->len = len;
+    frame->firstStamp = lastStamp - len * port->charTime;
+    frame->lastStamp = lastStamp;
+    frame->flags = flags;
+
+    __DMB();
+    port->frameHead = next;
+
+    if (port->frameCrc)
+    {
+        FRAME_CRC_Kick();
+    }
+
+    UART_DMA_RX_FRAME(port);
+}
+
+/*!
+ * @brief       Hand the bytes received since the last call to the consumer
+ *
+ * @param       port: UART port
+ *
+ * @param       head: ring offset after the last byte to hand on
+ *
+ * @param       idle: 1 when called on line idle, 0 on a ring half/full event
+ *
+ * @retval      None
+ */
+static void UART_DMA_RxProcess(UART_DMA_Port_T* port, uint16_t head, uint8_t idle)
+{
+    UART_DMA_Stats_T* stats = &port->stats;
+    uint32_t now = UART_DMA_TIMESTAMP();
+    uint16_t tail = port->rxRead;
+    uint16_t len;
+    uint16_t fill;
+    uint8_t flags;
+
+    /* A 0x00 filling a ring half may be a break with LBD still to come, it waits for the next event */
+    if ((port->breakCallback != NULL) && !idle && (head != tail) &&
+        (port->rxRing[(head == 0) ? (port->rxRingSize - 1) : (head - 1)] == 0x00))
+    {
+        head = (head == 0) ? (port->rxRingSize - 1) : (head - 1);
+    }
+
+    len = (head >= tail) ? (head - tail) : (port->rxRingSize - tail + head);
+
+    fill = (port->frameQueue != NULL) ? UART_DMA_RxFill(port, head) : len;
+    if ((port->flow != NULL) && (port->flow->rtsPort != NULL) && (port->frameQueue != NULL))
+    {
+        UART_DMA_RtsUpdate(port, fill);
+    }
+
+    /* Frames up to half the ring are only queued whole, on idle */
+    if ((port->frameQueue != NULL) && !idle && (len < port->rxRingSize / 2))
+    {
+        return;
+    }
+
+    /* The USART woke on the low 4 bits of the address byte starting the frame */
+    if (port->multiDrop && (port->rxFrameLen == 0) && (len != 0))
+    {
+        port->rxForeign = (port->rxRing[tail] != port->address);
+        stats->addressDrops += port->rxForeign;
+    }
+
+    if (port->rxForeign)
+    {
+        port->rxFrameLen += len;
+        if (idle)
+        {
+            port->rxFrameLen = 0;
+            port->rxForeign = 0;
+        }
+        port->rxRead = head;
+        return;
+    }
+
+    stats->rxBytes += len;
+    flags = (port->rxFrameLen != 0) ? UART_DMA_FRAME_CONT : 0;
+    port->rxFrameLen += len;
+    if (idle)
+    {
+        if (port->rxFrameLen > stats->maxFrameLen)
+        {
+            stats->maxFrameLen = port->rxFrameLen;
+        }
+        port->rxFrameLen = 0;
+    }
+
+    if (fill > stats->ringHighWater)
+    {
+        stats->ringHighWater = fill;
+    }
+
+    if (port->frameQueue != NULL)
+    {
+        /* An empty frame still closes a long frame that ended with its last piece */
+        if ((len == 0) && !(flags & UART_DMA_FRAME_CONT))
+        {
+            return;
+        }
+
+        if (idle)
+        {
+            flags |= UART_DMA_FRAME_END;
+        }
+
+        /* Idle is flagged one character after the last stop bit */
+        UART_DMA_PushFrame(port, tail, len, flags, idle ? now - port->charTime : now);
+    }
+    else if (port->rxCallback != NULL)
+    {
+        if (head > tail)
+        {
+            port->rxCallback(port, &port->rxRing[tail], head - tail);
+        }
+        else if (head < tail)
+        {
+            /* Data wraps over the end of the ring */
+            port->rxCallback(port, &port->rxRing[tail], port->rxRingSize - tail);
+            if (head > 0)
+            {
+                port->rxCallback(port, port->rxRing, head);
+            }
+        }
+    }
+
+    port->rxRead = head;
+}
+
+/*!
+ * @brief       End the frame in progress at a LIN break
+ *
+ * @param       port: UART port with breakCallback
+ *
+ * @retval      None
+ */
+static void UART_DMA_RxBreak(UART_DMA_Port_T* port)
+{
+    uint16_t head = UART_DMA_RxHead(port);
+    uint16_t last = (head == 0) ? (port->rxRingSize - 1) : (head - 1);
+
+    /* The break is also received as 0x00 with a framing error, one bit time before LBD */
+    if ((head != port->rxRead) && (port->rxRing[last] == 0x00))
+    {
+        UART_DMA_RxProcess(port, last, 1);
+        port->rxRead = head;
+    }
+    else
+    {
+        UART_DMA_RxProcess(port, head, 1);
+    }
+
+    port->breakCallback(port);
+}
+
+/*!
+ * @brief       Take the oldest received frame of a deferred mode port
+ *
+ * @param       port: UART port with a frame queue
+ *
+ * @param       frame: filled with the frame descriptor
+ *
+ * @retval      1 if a frame was taken, 0 if the queue is empty
+ *
+ * @note        Single consumer side of the frame queue, call from one context
+ *              only, usually the main loop. The frame data must be used
+ *              before the DMA wraps around the ring onto it. With RTS flow
+ *              control the frame stays reserved until the next call. With
+ *              frameCrc frames are handed out once their check is done.
+ */
+uint8_t UART_DMA_GetFrame(UART_DMA_Port_T* port, UART_DMA_Frame_T* frame)
+{
+    uint8_t tail = port->frameTail;
+    uint8_t head = port->frameCrc ? port->crcHead : port->frameHead;
+    uint8_t next;
+    uint32_t primask;
+
+    if (tail == head)
+    {
+        /* The frame last taken is done with, the ring is in use from the read cursor on */
+        if (port->rxTaken != port->rxRead)
+        {
+            primask = __get_PRIMASK();
+            __disable_irq();
+            if (port->frameTail == port->frameHead)
+            {
+                port->rxTaken = port->rxRead;
+                UART_DMA_RtsRelease(port);
+            }
+            __set_PRIMASK(primask);
+        }
+        return 0;
+    }
+
+    /* Read the slot only after the head index it was published with */
+    __DMB();
+    *frame = port->frameQueue[tail];
+    port->rxTaken = frame->offset;
+
+    next = tail + 1;
+    if (next == port->frameQueueLen)
+    {
+        next = 0;
+    }
+
+    __DMB();
+    port->frameTail = next;
+
+    if (port->rtsHeld)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        UART_DMA_RtsRelease(port);
+        __set_PRIMASK(primask);
+    }
+
+    return 1;
+}
+
+/*!
+ * @brief       Check for a received frame without taking it
+ *
+ * @param       port: UART port with a frame queue
+ *
+ * @retval      1 if UART_DMA_GetFrame() has a frame to hand out, 0 if not
+ *
+ * @note        With interrupts masked the answer holds until they are
+ *              unmasked, e.g. to decide on WFI.
+ */
+uint8_t UART_DMA_FramePending(UART_DMA_Port_T* port)
+{
+    return port->frameTail != (port->frameCrc ? port->crcHead : port->frameHead);
+}
+
+/*!
+ * @brief       Locate the data of a frame in the receive ring
+ *
+ * @param       port: UART port
+ *
+ * @param       frame: frame descriptor
+ *
+ * @param       seg: array of two segments, filled with the frame data
+ *
+ * @retval      Number of segments used, 2 when the frame wraps over the ring end
+ */
+uint8_t UART_DMA_FrameSegments(UART_DMA_Port_T* port, const UART_DMA_Frame_T* frame, UART_DMA_Segment_T* seg)
+{
+    uint16_t first = port->rxRingSize - frame->offset;
+
+    seg[0].data = &port->rxRing[frame->offset];
+
+    if (frame->len <= first)
+    {
+        seg[0].len = frame->len;
+        return 1;
+    }
+
+    seg[0].len = first;
+    seg[1].data = port->rxRing;
+    seg[1].len = frame->len - first;
+
+    return 2;
+}
+
+/*!
+ * @brief       Time since the last byte of a frame was received
+ *
+ * @param       frame: frame descriptor
+ *
+ * @retval      Latency in UART_DMA_TIMESTAMP() units
+ */
+uint32_t UART_DMA_FrameAge(const UART_DMA_Frame_T* frame)
+{
+    return UART_DMA_TIMESTAMP() - frame->lastStamp;
+}
+
+/*!
+ * @brief       Take a consistent copy of the port counters
+ *
+ * @param       port: UART port
+ *
+ * @param       stats: filled with the counters
+ *
+ * @param       clear: 1 to restart the counters from zero
+ *
+ * @retval      None
+ */
+void UART_DMA_ReadStats(UART_DMA_Port_T* port, UART_DMA_Stats_T* stats, uint8_t clear)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    *stats = port->stats;
+    if (clear)
+    {
+        memset(&port->stats, 0, sizeof(port->stats));
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/*!
+ * @brief       Clear a latency histogram
+ *
+ * @param       hist: histogram
+ *
+ * @retval      None
+ */
+void UART_DMA_LatencyReset(UART_DMA_Latency_T* hist)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->min = 0xFFFFFFFF;
+}
+
+/*!
+ * @brief       Add a latency to a histogram
+ *
+ * @param       hist: histogram, updated from one context only
+ *
+ * @param       latency: latency in UART_DMA_TIMESTAMP() units, e.g. from
+ *                       UART_DMA_FrameAge() when a frame has been handled
+ *
+ * @retval      None
+ */
+void UART_DMA_LatencyAdd(UART_DMA_Latency_T* hist, uint32_t latency)
+{
+    uint8_t n = 32 - __CLZ(latency);
+
+    if (n >= UART_DMA_LATENCY_BUCKETS)
+    {
+        n = UART_DMA_LATENCY_BUCKETS - 1;
+    }
+
+    hist->bucket[n]++;
+    hist->count++;
+    hist->sum += latency;
+
+    if (latency < hist->min)
+    {
+        hist->min = latency;
+    }
+    if (latency > hist->max)
+    {
+        hist->max = latency;
+    }
+}
+
+/*!
+ * @brief       Start the current segment of the oldest request, completing
+ *              requests that have nothing left to send
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ *
+ * @note        Called with interrupts masked or from the port TX interrupt.
+ */
+static void UART_DMA_TxKick(UART_DMA_Port_T* port)
+{
+    UART_DMA_Request_T* req;
+    const UART_DMA_Segment_T* seg;
+
+    while ((req = port->txFirst) != NULL)
+    {
+        while (req->index < req->count)
+        {
+            seg = &req->segments[req->index];
+            if (seg->len != 0)
+            {
+                UART_DMA_TX_START(port);
+
+                if ((port->rs485 != NULL) || (port->smartCard != NULL))
+                {
+                    if (!port->deOn)
+                    {
+                        UART_DMA_DriverOn(port);
+                    }
+
+                    /* TC now means the line went idle after this segment */
+                    REG_USART_DisableInterrupt(port->usart, REG_USART_TXC);
+                    REG_USART_ClearStatusFlag(port->usart, REG_USART_TXC);
+                }
+
+                if (port->txChannel != NULL)
+                {
+                    REG_DMA_Rearm(port->txChannel, (uint32_t)seg->data, seg->len);
+                }
+                else
+                {
+                    req->offset = 0;
+                    if (!port->txHeld)
+                    {
+                        REG_USART_EnableInterrupt(port->usart, REG_USART_TXBE);
+                    }
+                }
+                return;
+            }
+            req->index++;
+        }
+
+        port->txFirst = req->next;
+        if (port->txFirst == NULL)
+        {
+            port->txLast = NULL;
+        }
+
+        if (req->callback != NULL)
+        {
+            req->callback(req);
+        }
+    }
+
+    /* Nothing left to send, the driver is released on TC */
+    if (port->deOn)
+    {
+        REG_USART_EnableInterrupt(port->usart, REG_USART_TXC);
+    }
+}
+
+/*!
+ * @brief       Queue a scatter-gather transmit request
+ *
+ * @param       port: UART port
+ *
+ * @param       req: request whose segments are sent in order straight from
+ *                   their memory. The request, its segment list and the data
+ *                   must stay untouched until req->callback is called.
+ *
+ * @retval      SUCCESS, or ERROR if the request is already queued
+ *
+ * @note        req->callback runs in the port TX interrupt.
+ */
+uint8_t UART_DMA_Send(UART_DMA_Port_T* port, UART_DMA_Request_T* req)
+{
+    UART_DMA_Request_T* node;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* A queued request keeps its link and its progress */
+    for (node = port->txFirst; node != NULL; node = node->next)
+    {
+        if (node == req)
+        {
+            __set_PRIMASK(primask);
+            return ERROR;
+        }
+    }
+
+    req->index = 0;
+    req->offset = 0;
+    req->next = NULL;
+
+    if (port->txLast != NULL)
+    {
+        port->txLast->next = req;
+        port->txLast = req;
+    }
+    else
+    {
+        port->txFirst = req;
+        port->txLast = req;
+        UART_DMA_TxKick(port);
+    }
+
+    __set_PRIMASK(primask);
+
+    return SUCCESS;
+}
+
+/*!
+ * @brief       Return the oldest UART_DMA_Write() buffer to its pool
+ *
+ * @param       req: request embedded in the buffer
+ *
+ * @retval      None
+ */
+static void UART_DMA_TxPoolRelease(UART_DMA_Request_T* req)
+{
+    UART_DMA_Port_T* port = (UART_DMA_Port_T*)req->context;
+
+    port->txPoolTail = (port->txPoolTail + 1) % port->txPoolLen;
+}
+
+/*!
+ * @brief       Copy data into the port send pool and return without waiting
+ *
+ * @param       port: UART port
+ *
+ * @param       buf: data to send
+ *
+ * @param       len: data length
+ *
+ * @retval      Number of bytes queued, less than len when the pool is full
+ *
+ * @note        Use UART_DMA_Send() to send from caller memory without a copy.
+ */
+uint16_t UART_DMA_Write(UART_DMA_Port_T* port, const uint8_t* buf, uint16_t len)
+{
+    UART_DMA_TxBuffer_T* txBuf;
+    uint16_t queued = 0;
+    uint16_t chunk;
+    uint8_t next;
+    uint32_t primask;
+
+    /* Writers may be both thread and interrupt context */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    while (queued < len)
+    {
+        next = (port->txPoolHead + 1) % port->txPoolLen;
+        if (next == port->txPoolTail)
+        {
+            break;
+        }
+
+        chunk = len - queued;
+        if (chunk > UART_DMA_TX_BUF_SIZE)
+        {
+            chunk = UART_DMA_TX_BUF_SIZE;
+        }
+
+        txBuf = &port->txPool[port->txPoolHead];
+        memcpy(txBuf->data, &buf[queued], chunk);
+        txBuf->segment.data = txBuf->data;
+        txBuf->segment.len = chunk;
+        txBuf->request.segments = &txBuf->segment;
+        txBuf->request.count = 1;
+        txBuf->request.callback = UART_DMA_TxPoolRelease;
+        txBuf->request.context = port;
+        port->txPoolHead = next;
+        queued += chunk;
+
+        UART_DMA_Send(port, &txBuf->request);
+    }
+
+    __set_PRIMASK(primask);
+
+    return queued;
+}
+
+/*!
+ * @brief       USART interrupt of a port
+ *
+ * @param       port: UART port
+ *
+ * @retval      None
+ */
+static void UART_DMA_UsartIsr(UART_DMA_Port_T* port)
+{
+    UART_DMA_Stats_T* stats = &port->stats;
+    UART_DMA_Request_T* req;
+    uint16_t head;
+    uint16_t sts = port->usart->STS;
+
+    if (sts & UART_DMA_STS_ERRORS)
+    {
+        stats->parityErrors += sts & USART_FLAG_PE;
+        stats->framingErrors += (sts & USART_FLAG_FE) >> 1;
+        stats->noiseErrors += (sts & USART_FLAG_NE) >> 2;
+        stats->overruns += (sts & USART_FLAG_OVRE) >> 3;
+
+        /* Reading DATA after STS clears them, the idle branch does it as well */
+        if ((port->rxChannel != NULL) && !(sts & USART_FLAG_IDLE))
+        {
+            REG_USART_RxData(port->usart);
+        }
+    }
+
+    if ((port->rxChannel == NULL) && (sts & USART_FLAG_RXBNE))
+    {
+        head = port->rxWrite;
+        port->rxRing[head] = (uint8_t)REG_USART_RxData(port->usart);
+        port->rxWrite = (head + 1 == port->rxRingSize) ? 0 : head + 1;
+
+        if (port->rxWrite == port->rxRingSize / 2 || port->rxWrite == 0)
+        {
+            UART_DMA_RxProcess(port, UART_DMA_RxHead(port), 0);
+        }
+    }
+
+    if ((port->breakCallback != NULL) && (sts & USART_FLAG_LBD))
+    {
+        REG_USART_ClearStatusFlag(port->usart, USART_FLAG_LBD);
+        stats->breaks++;
+        UART_DMA_RxBreak(port);
+    }
+
+    if (sts & USART_FLAG_IDLE)
+    {
+        /* Reading DATA after STS clears the idle flag */
+        REG_USART_RxData(port->usart);
+        stats->idleEvents++;
+        UART_DMA_RxProcess(port, UART_DMA_RxHead(port), 1);
+    }
+
+    if (port->deOn && (port->txFirst == NULL) && REG_USART_ReadIntFlag(port->usart, REG_USART_TXC))
+    {
+        UART_DMA_DriverOff(port);
+    }
+
+    if ((port->txChannel == NULL) && REG_USART_ReadIntFlag(port->usart, REG_USART_TXBE))
+    {
+        req = port->txFirst;
+        if (req == NULL)
+        {
+            REG_USART_DisableInterrupt(port->usart, REG_USART_TXBE);
+            return;
+        }
+
+        REG_USART_TxData(port->usart, req->segments[req->index].data[req->offset]);
+        if (++req->offset == req->segments[req->index].len)
+        {
+            REG_USART_DisableInterrupt(port->usart, REG_USART_TXBE);
+            req->index++;
+            UART_DMA_TxKick(port);
+        }
+    }
+}
+
+/*!
+ * @brief       Auto-baud timer interrupt: capture the edges of the first character
+ *
+ * @param       port: UART port with autoBaud set
+ *
+ * @retval      None
+ *
+ * @note        The last edge sets BR as PCLK cycles per bit, the same channel
+ *              then compares for the middle of the first stop bit and turns
+ *              the receiver on there. Each capture must be read before the
+ *              next edge, one bit later for a start bit, two for 0x55.
+ */
+static void UART_DMA_AutoBaudIsr(UART_DMA_Port_T* port)
+{
+    const UART_DMA_AutoBaud_T* ab = port->autoBaud;
+    TMR_T* tmr = ab->tmr;
+    TMR_OCConfig_T ocConfig;
+    uint16_t edge;
+    uint16_t gap;
+    uint16_t span;
+    uint16_t target;
+    uint32_t bits = ab->sync ? 8 : 1;
+    uint32_t halfBits;
+    uint32_t br;
+
+    if (!TMR_ReadIntFlag(tmr, (TMR_INT_T)UART_DMA_AB_INT(ab)))
+    {
+        return;
+    }
+
+    if (port->abEdges == UART_DMA_AB_LOCKED)
+    {
+        TMR_DisableInterrupt(tmr, UART_DMA_AB_INT(ab));
+        TMR_ClearIntFlag(tmr, UART_DMA_AB_INT(ab));
+        REG_USART_EnableRx(port->usart);
+        return;
+    }
+
+    /* Reading the capture clears its flag */
+    edge = (uint16_t)(&tmr->CC1)[ab->channel / 4];
+
+    if (TMR_ReadStatusFlag(tmr, (TMR_FLAG_T)UART_DMA_AB_FLAG_RC(ab)))
+    {
+        /* An edge was captured over before it was read */
+        port->stats.baudRejects++;
+        UART_DMA_AutoBaud(port);
+        return;
+    }
+
+    if (port->abEdges++ == 0)
+    {
+        port->abFirst = edge;
+        port->abLast = edge;
+        port->abMin = 0xFFFF;
+        port->abMax = 0;
+        return;
+    }
+
+    gap = edge - port->abLast;
+    port->abLast = edge;
+    if (gap < port->abMin)
+    {
+        port->abMin = gap;
+    }
+    if (gap > port->abMax)
+    {
+        port->abMax = gap;
+    }
+
+    if (port->abEdges < (ab->sync ? 5 : 2))
+    {
+        return;
+    }
+
+    span = edge - port->abFirst;
+    br = (uint32_t)(((uint64_t)port->abPclk * span + (uint64_t)port->abClock * bits / 2) /
+                    ((uint64_t)port->abClock * bits));
+
+    /* The four gaps of 0x55 are two bits each */
+    if ((port->abMax > port->abMin + port->abMin / 4) || (br < 16) || (br > 0xFFFF))
+    {
+        port->stats.baudRejects++;
+        UART_DMA_AutoBaud(port);
+        return;
+    }
+
+    port->usart->BR = br;
+    UART_DMA_LineTimes(port, (port->abPclk + br / 2) / br);
+    port->abEdges = UART_DMA_AB_LOCKED;
+    port->stats.autoBauds++;
+
+    /* Start bit and data bits, then half of the first stop bit */
+    halfBits = 2 * (port->usart->CTRL1_B.DBLCFG ? 10 : 9) + 1;
+    target = port->abFirst + (uint16_t)((uint32_t)span * halfBits / (2 * bits));
+
+    TMR_ConfigOCStructInit(&ocConfig);
+    ocConfig.mode = TMR_OC_MODE_TMRING;
+    ocConfig.pulse = target;
+
+    switch (ab->channel)
+    {
+        case TMR_CHANNEL_1:
+            TMR_ConfigOC1(tmr, &ocConfig);
+            break;
+
+        case TMR_CHANNEL_2:
+            TMR_ConfigOC2(tmr, &ocConfig);
+            break;
+
+        case TMR_CHANNEL_3:
+            TMR_ConfigOC3(tmr, &ocConfig);
+            break;
+
+        default:
+            TMR_ConfigOC4(tmr, &ocConfig);
+            break;
+    }
+
+    TMR_ClearIntFlag(tmr, UART_DMA_AB_INT(ab));
+
+    if ((int16_t)(target - TMR_ReadCounter(tmr)) <= 0)
+    {
+        /* The stop bit is already on the line */
+        TMR_DisableInterrupt(tmr, UART_DMA_AB_INT(ab));
+        TMR_ClearIntFlag(tmr, UART_DMA_AB_INT(ab));
+        REG_USART_EnableRx(port->usart);
+    }
+}
+
+/*!
+ * @brief       Transmit DMA channel events of a port
+ *
+ * @param       context: UART port
+ *
+ * @param       events: DMA_MGR_EVENT_TC or DMA_MGR_EVENT_TERR
+ *
+ * @retval      None
+ */
+static void UART_DMA_TxDmaEvent(void* context, uint8_t events)
+{
+    UART_DMA_Port_T* port = (UART_DMA_Port_T*)context;
+
+    UART_DMA_ISR_ENTER(port);
+
+    if (events & DMA_MGR_EVENT_TERR)
+    {
+        /* The channel stopped, the segment is given up */
+        port->stats.dmaErrors++;
+    }
+
+    if (port->txFirst != NULL)
+    {
+        port->txFirst->index++;
+    }
+    UART_DMA_TxKick(port);
+
+    UART_DMA_ISR_EXIT(port);
+}
+
+/*!
+ * @brief       Receive DMA channel events of a port
+ *
+ * @param       context: UART port
+ *
+ * @param       events: DMA_MGR_EVENT_HT, DMA_MGR_EVENT_TC and DMA_MGR_EVENT_TERR
+ *
+ * @retval      None
+ */
+static void UART_DMA_RxDmaEvent(void* context, uint8_t events)
+{
+    UART_DMA_Port_T* port = (UART_DMA_Port_T*)context;
+
+    UART_DMA_ISR_ENTER(port);
+
+    if (events & DMA_MGR_EVENT_TERR)
+    {
+        /* The channel stopped, restart it on an empty ring */
+        port->stats.dmaErrors++;
+        REG_DMA_ConfigDataNumber(port->rxChannel, port->rxRingSize);
+        port->rxRead = 0;
+        port->rxFrameLen = 0;
+        REG_DMA_Enable(port->rxChannel);
+    }
+
+    if (events & (DMA_MGR_EVENT_HT | DMA_MGR_EVENT_TC))
+    {
+        UART_DMA_RxProcess(port, UART_DMA_RxHead(port), 0);
+    }
+
+    UART_DMA_ISR_EXIT(port);
+}
+
+/*!
+ * @brief       Shared interrupt service of all ports
+ *
+ * @param       irq: IRQ being serviced, USART, CTS EINT line or auto-baud timer of a port
+ *
+ * @retval      None
+ *
+ * @note        Called from every USART/UART, CTS EINT and auto-baud timer IRQ
+ *              handler used by a port descriptor. The DMA channels of a port
+ *              are served through DMA_MGR_Isr().
+ */
+void UART_DMA_Isr(IRQn_Type irq)
+{
+    UART_DMA_Port_T* port = irqPort[irq];
+
+    if (port == NULL)
+    {
+        return;
+    }
+
+    UART_DMA_ISR_ENTER(port);
+
+    if (irq == port->usartIRQn)
+    {
+        UART_DMA_UsartIsr(port);
+    }
+    else if (port->ctsSoft && (irq == port->ctsIRQn))
+    {
+        REG_EINT_ClearIntFlag(port->flow->ctsPin);
+        UART_DMA_CtsUpdate(port);
+    }
+    else if ((port->autoBaud != NULL) && (irq == port->autoBaud->tmrIRQn))
+    {
+        UART_DMA_AutoBaudIsr(port);
+    }
+
+    UART_DMA_ISR_EXIT(port);
+}
+
+/**@} end of group UART_DMA_Functions */
+/**@} end of group USART_Interrupt */
+/**@} end of group Examples */